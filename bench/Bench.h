@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal self-timing benchmark harness. A case receives an iteration count
+// and must run its body exactly that many times; the harness picks the count.
+using BenchFn = void (*)(uint64_t iterations);
+
+struct BenchCase {
+    const char* name;
+    BenchFn fn;
+};
+
+std::vector<BenchCase>& BenchRegistry();
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFn fn) { BenchRegistry().push_back({name, fn}); }
+};
+
+#define RAZER_BENCH(name) \
+    static void name(uint64_t iterations); \
+    static BenchRegistrar name##_registrar(#name, name); \
+    static void name(uint64_t iterations)
+
+// Keeps the optimizer from discarding a value computed by a benchmark body.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    extern const void* volatile g_benchSink;
+    g_benchSink = &value;
+#endif
+}
@@ -0,0 +1,74 @@
+// RazerBatteryBench [--text] [--min-time-ms N] [filter]
+//
+// Emits JSON on stdout by default so runs can be diffed between commits.
+#include "Bench.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+const void* volatile g_benchSink = nullptr;
+
+std::vector<BenchCase>& BenchRegistry() {
+    static std::vector<BenchCase> cases;
+    return cases;
+}
+
+static double RunCase(const BenchCase& c, double targetNs, uint64_t& iterations) {
+    using Clock = std::chrono::steady_clock;
+
+    c.fn(1); // warm-up
+    iterations = 1;
+    for (;;) {
+        auto start = Clock::now();
+        c.fn(iterations);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (ns >= targetNs || iterations >= (1ull << 40)) {
+            return ns / static_cast<double>(iterations);
+        }
+        // Grow towards the target, at most 100x per step
+        double scale = ns > 0 ? targetNs / ns : 100.0;
+        if (scale > 100.0) scale = 100.0;
+        if (scale < 2.0) scale = 2.0;
+        iterations = static_cast<uint64_t>(iterations * scale);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    bool text = false;
+    double targetNs = 200e6; // ~200 ms per case
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            text = true;
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            targetNs = atof(argv[++i]) * 1e6;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    // Benchmarks must not measure (or litter) the text log
+    Logger::SetLevel(LogLevel::Off);
+
+    if (!text) printf("{\n  \"suite\": \"RazerBatteryBench\",\n  \"benchmarks\": [");
+    bool first = true;
+    for (const auto& c : BenchRegistry()) {
+        if (filter && !strstr(c.name, filter)) continue;
+        uint64_t iterations = 0;
+        double nsPerIter = RunCase(c, targetNs, iterations);
+        if (text) {
+            printf("%-40s %14llu iters %12.2f ns/iter\n", c.name,
+                   static_cast<unsigned long long>(iterations), nsPerIter);
+        } else {
+            printf("%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_iter\": %.3f}",
+                   first ? "" : ",", c.name, static_cast<unsigned long long>(iterations), nsPerIter);
+        }
+        fflush(stdout);
+        first = false;
+    }
+    if (!text) printf("\n  ]\n}\n");
+    return 0;
+}
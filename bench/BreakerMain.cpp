@@ -0,0 +1,114 @@
+// RazerBatteryBreaker [--text]
+//
+// Walks a CircuitBreaker through its states on a simulated clock: two
+// failures open it, one trial goes through once the backoff has passed,
+// and every other call is skipped while that trial is outstanding. A trial
+// whose outcome is never recorded re-opens the breaker with the same
+// backoff once that backoff has passed again. A trial that got no answer
+// either way is due again at once. A failed trial doubles the backoff,
+// and a successful one closes the breaker.
+//
+// The run fails if any step does not behave as described.
+// Emits JSON on stdout by default.
+#include "CircuitBreaker.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct Options {
+    bool text = false;
+};
+
+struct Check {
+    const char* name;
+    bool ok;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatteryBreaker [--text]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+// The retry time lies within the jittered backoff from `nowUs`
+bool RetryWithin(const CircuitBreaker& breaker, uint64_t nowUs, uint64_t backoffUs, double jitter) {
+    uint64_t retryAtUs = breaker.GetRetryAtUs();
+    return retryAtUs >= nowUs + static_cast<uint64_t>(static_cast<double>(backoffUs) * (1 - jitter)) &&
+           retryAtUs <= nowUs + static_cast<uint64_t>(static_cast<double>(backoffUs) * (1 + jitter));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    CircuitBreaker::Options breakerOptions;
+    const uint64_t backoffUs = breakerOptions.initialBackoffUs;
+    const double jitter = breakerOptions.jitter;
+    CircuitBreaker breaker(breakerOptions, 1);
+    std::vector<Check> checks;
+    uint64_t now = 1000000;
+
+    breaker.RecordFailure(now);
+    bool opened = breaker.RecordFailure(now);
+    checks.push_back({"two failures open it", opened && breaker.GetState() == BreakerState::Open});
+    checks.push_back({"skipped before the retry time", !breaker.Allow(now + 1)});
+
+    now = breaker.GetRetryAtUs();
+    bool trial = breaker.Allow(now);
+    checks.push_back({"one trial once due", trial && breaker.GetState() == BreakerState::HalfOpen});
+    checks.push_back({"others skipped during the trial",
+                      !breaker.Allow(now) && !breaker.Allow(now + backoffUs - 1)});
+
+    // The trial's outcome is lost
+    now += backoffUs;
+    bool allowed = breaker.Allow(now);
+    checks.push_back({"an overdue trial re-opens it", !allowed && breaker.GetState() == BreakerState::Open &&
+                                                          RetryWithin(breaker, now, backoffUs, jitter)});
+
+    now = breaker.GetRetryAtUs();
+    trial = breaker.Allow(now);
+    breaker.RecordNoOutcome();
+    checks.push_back({"a trial without an answer is due again at once",
+                      trial && breaker.GetState() == BreakerState::Open && breaker.Allow(now)});
+
+    breaker.RecordFailure(now);
+    checks.push_back({"a failed trial doubles the backoff", breaker.GetState() == BreakerState::Open &&
+                                                               RetryWithin(breaker, now, backoffUs * 2, jitter)});
+
+    now = breaker.GetRetryAtUs();
+    trial = breaker.Allow(now);
+    breaker.RecordSuccess();
+    checks.push_back({"a successful trial closes it", trial && breaker.GetState() == BreakerState::Closed &&
+                                                         breaker.Allow(now) && breaker.Allow(now)});
+
+    breaker.RecordNoOutcome();
+    checks.push_back({"no outcome leaves a closed breaker alone", breaker.GetState() == BreakerState::Closed});
+
+    bool pass = true;
+    for (const Check& check : checks) pass = pass && check.ok;
+    if (options.text) {
+        for (const Check& check : checks) printf("%-47s %s\n", check.name, check.ok ? "ok" : "failed");
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatteryBreaker\",\n  \"checks\": [\n");
+        for (size_t i = 0; i < checks.size(); i++) {
+            printf("    {\"name\": \"%s\", \"result\": \"%s\"}%s\n", checks[i].name, checks[i].ok ? "pass" : "fail",
+                   i + 1 < checks.size() ? "," : "");
+        }
+        printf("  ],\n  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
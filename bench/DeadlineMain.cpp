@@ -0,0 +1,85 @@
+// RazerBatteryDeadline [--rounds N] [--text]
+//
+// Checks that Deadline::Cap and Deadline::Expired agree at the very end of
+// a budget. Each round starts a 1 ms deadline and spins until it expires,
+// calling Cap and then Expired at every step. Cap must return 0 only when
+// the deadline has expired; a 0 before that makes a transfer report a
+// timeout it never waited for. Cap must also never exceed what is left,
+// rounded up to the next millisecond.
+//
+// The run fails on any step where Cap returns 0 but Expired is false, or
+// where Cap exceeds the rounded-up time left.
+// Emits JSON on stdout by default.
+#include "Deadline.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Options {
+    int rounds = 1000;
+    bool text = false;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            options.rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatteryDeadline [--rounds N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.rounds <= 0) options.rounds = 1000;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    uint64_t steps = 0;
+    uint64_t subMillisecondSteps = 0;   // Cap called with under 1 ms left
+    uint64_t zeroBeforeExpiry = 0;
+    uint64_t overCap = 0;
+    for (int round = 0; round < options.rounds; round++) {
+        Deadline deadline = Deadline::After(std::chrono::milliseconds(1));
+        for (;;) {
+            unsigned int capMs = deadline.Cap(1000);
+            bool expired = deadline.Expired();
+            steps++;
+            if (capMs == 0 && !expired) zeroBeforeExpiry++;
+            // A 1 ms deadline has under 1 ms left by the time it is asked
+            if (capMs == 1) subMillisecondSteps++;
+            if (capMs > 1) overCap++;
+            if (expired) break;
+        }
+    }
+
+    bool pass = zeroBeforeExpiry == 0 && overCap == 0 && subMillisecondSteps > 0;
+    if (options.text) {
+        printf("%d rounds, %llu steps, %llu with under 1 ms left: %llu zero caps before expiry, %llu over 1 ms\n",
+               options.rounds, static_cast<unsigned long long>(steps),
+               static_cast<unsigned long long>(subMillisecondSteps),
+               static_cast<unsigned long long>(zeroBeforeExpiry), static_cast<unsigned long long>(overCap));
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatteryDeadline\",\n  \"rounds\": %d,\n  \"steps\": %llu,\n"
+               "  \"sub_millisecond_steps\": %llu,\n  \"zero_before_expiry\": %llu,\n  \"over_cap\": %llu,\n"
+               "  \"result\": \"%s\"\n}\n",
+               options.rounds, static_cast<unsigned long long>(steps),
+               static_cast<unsigned long long>(subMillisecondSteps),
+               static_cast<unsigned long long>(zeroBeforeExpiry), static_cast<unsigned long long>(overCap),
+               pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
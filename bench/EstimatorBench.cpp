@@ -0,0 +1,14 @@
+#include "Bench.h"
+#include "BatteryEstimator.h"
+
+// One reading fed to a device's estimator: a 1-minute discharge losing a
+// point every 40 samples, with a sleep gap every 500 and a charge every 4000.
+RAZER_BENCH(estimator_add) {
+    BatteryEstimator estimator;
+    int64_t time = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        time += i % 500 == 0 ? 3600 : 60;
+        estimator.Add(time, 100 - static_cast<int>((i / 40) % 100), (i / 4000) % 2 == 1);
+        DoNotOptimize(estimator.SecondsToEmpty());
+    }
+}
@@ -0,0 +1,30 @@
+#include "Bench.h"
+#include "EventLog.h"
+#include <cstdio>
+#include <filesystem>
+
+// Cost of one protocol event record, including periodic rotation.
+RAZER_BENCH(event_log_append) {
+    std::string path = (std::filesystem::temp_directory_path() / "RazerBatteryBenchEvents.bin").string();
+    EventLog& log = EventLog::Instance();
+    if (!log.Open(path, 4096, 2)) return;
+
+    ProtocolEvent event = {};
+    snprintf(event.deviceKey, sizeof(event.deviceKey), "PM1234567890");
+    event.pid = 0x00B6;
+    event.strategy = static_cast<uint8_t>(EventStrategy::FeatureReport);
+    event.commandClass = 0x07;
+    event.commandId = 0x80;
+    event.status = 0x02;
+    event.result = 90;
+    for (uint64_t i = 0; i < iterations; i++) {
+        event.timestampUs = i;
+        event.transactionId = static_cast<uint8_t>(i);
+        log.Append(event);
+    }
+
+    log.Close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path + ".1", ec);
+}
@@ -0,0 +1,41 @@
+#include "Bench.h"
+#include "BatteryHistory.h"
+#include <filesystem>
+
+// One reading appended to a small history that keeps recycling blocks:
+// a slow discharge with a level change every 40 samples.
+RAZER_BENCH(history_append) {
+    std::string path = (std::filesystem::temp_directory_path() / "RazerBatteryBenchHistory.bin").string();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    BatteryHistory history;
+    if (!history.Open(path, "PM1234567890", 4)) return;
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        history.Append(static_cast<int64_t>(i) * 60, 100 - static_cast<int>((i / 40) % 100), false);
+    }
+
+    history.Close();
+    std::filesystem::remove(path, ec);
+}
+
+// Decoding a full 4-block history through the iterator.
+RAZER_BENCH(history_iterate_4_blocks) {
+    std::string path = (std::filesystem::temp_directory_path() / "RazerBatteryBenchHistoryRead.bin").string();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    BatteryHistory history;
+    if (!history.Open(path, "PM1234567890", 4)) return;
+    for (int64_t i = 0; i < 200000; i++) {
+        history.Append(i * 60, 100 - static_cast<int>((i / 40) % 100), (i / 4000) % 2 == 1);
+    }
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        int64_t sum = 0;
+        for (const HistoryRecord& r : history.All()) sum += r.level;
+        DoNotOptimize(sum);
+    }
+
+    history.Close();
+    std::filesystem::remove(path, ec);
+}
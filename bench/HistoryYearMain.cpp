@@ -0,0 +1,159 @@
+// RazerBatteryHistoryYear [--days N] [--max-kb N] [--text]
+//
+// Backs the size quoted for BatteryHistory: appends a simulated year of
+// 1-minute readings for one mouse to a fresh history file, then reads the
+// file back through a read-only handle. Each day the host sleeps from
+// 00:00 to 08:00 (no readings), the mouse discharges about one point every
+// 12 minutes while awake, and it charges back to full once it falls to 25%.
+// One reading in 50 arrives a second late, as a timer would.
+//
+// The run fails if the file holds more than --max-kb KB (default 192), if
+// the ring had to recycle a block, or if any decoded record differs from
+// what was appended.
+// Emits JSON on stdout by default.
+#include "BatteryHistory.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int days = 365;
+    int maxKb = 192;
+    bool text = false;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+            options.days = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-kb") == 0 && i + 1 < argc) {
+            options.maxKb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatteryHistoryYear [--days N] [--max-kb N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.days <= 0) options.days = 365;
+    if (options.maxKb <= 0) options.maxKb = 192;
+    return true;
+}
+
+bool SameRecord(const HistoryRecord& a, const HistoryRecord& b) {
+    return a.kind == b.kind && a.time == b.time && a.level == b.level && a.charging == b.charging;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    std::string path = (std::filesystem::temp_directory_path() / "RazerBatteryHistoryYear.bin").string();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    // What the decoder must give back, in the order Append records it
+    std::vector<HistoryRecord> expected;
+    uint64_t readings = 0;
+    uint64_t chargeCycles = 0;
+    size_t usedBytes = 0;
+    bool opened = false;
+    {
+        BatteryHistory history;
+        opened = history.Open(path, "PM2024000001");
+        std::mt19937 rng(2024);
+        const int64_t start = 1704067200; // 2024-01-01 00:00 UTC
+        int level = 100;
+        bool charging = false;
+        int minutesToStep = 12;
+        bool first = true;
+        for (int day = 0; day < options.days && opened; day++) {
+            int64_t time = start + static_cast<int64_t>(day) * 86400 + 8 * 3600;
+            const int64_t bedtime = start + static_cast<int64_t>(day + 1) * 86400;
+            for (; time < bedtime; time += 60) {
+                if (--minutesToStep == 0) {
+                    if (charging) {
+                        level++;
+                        minutesToStep = 1 + static_cast<int>(rng() % 2);
+                    } else {
+                        level--;
+                        minutesToStep = 10 + static_cast<int>(rng() % 5);
+                    }
+                }
+                bool nowCharging = charging;
+                if (!charging && level <= 25) {
+                    nowCharging = true;
+                    chargeCycles++;
+                } else if (charging && level >= 100) {
+                    nowCharging = false;
+                }
+                int64_t at = time + (rng() % 50 == 0 ? 1 : 0);
+
+                if (!first && nowCharging != charging) {
+                    HistoryRecord event;
+                    event.kind = nowCharging ? HistoryRecord::Kind::ChargeStarted : HistoryRecord::Kind::ChargeStopped;
+                    event.time = at;
+                    event.level = expected.back().level;
+                    event.charging = nowCharging;
+                    expected.push_back(event);
+                }
+                charging = nowCharging;
+                first = false;
+                HistoryRecord sample;
+                sample.time = at;
+                sample.level = level;
+                sample.charging = charging;
+                expected.push_back(sample);
+                history.Append(at, level, charging);
+                readings++;
+            }
+        }
+        usedBytes = history.GetUsedBytes();
+        history.Close();
+    }
+
+    BatteryHistory reader;
+    bool readable = opened && reader.OpenReadOnly(path);
+    uint64_t decoded = 0;
+    uint64_t mismatches = 0;
+    if (readable) {
+        for (const HistoryRecord& record : reader.All()) {
+            if (decoded >= expected.size() || !SameRecord(record, expected[decoded])) mismatches++;
+            decoded++;
+        }
+    }
+    reader.Close();
+    std::filesystem::remove(path, ec);
+
+    // A recycled block drops the oldest records, which shows up as a short decode
+    bool recycled = decoded < expected.size();
+    bool pass = readable && !recycled && mismatches == 0 && decoded == expected.size() &&
+                usedBytes <= static_cast<size_t>(options.maxKb) * 1024;
+    if (options.text) {
+        printf("%d days: %llu readings, %llu charge cycles, %zu bytes (%.1f KB, limit %d KB)\n", options.days,
+               static_cast<unsigned long long>(readings), static_cast<unsigned long long>(chargeCycles), usedBytes,
+               usedBytes / 1024.0, options.maxKb);
+        printf("decoded %llu of %zu records, %llu mismatched\n", static_cast<unsigned long long>(decoded),
+               expected.size(), static_cast<unsigned long long>(mismatches));
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatteryHistoryYear\",\n  \"days\": %d,\n  \"readings\": %llu,\n"
+               "  \"charge_cycles\": %llu,\n  \"used_bytes\": %zu,\n  \"max_bytes\": %zu,\n"
+               "  \"records\": %zu,\n  \"decoded\": %llu,\n  \"mismatches\": %llu,\n  \"result\": \"%s\"\n}\n",
+               options.days, static_cast<unsigned long long>(readings), static_cast<unsigned long long>(chargeCycles),
+               usedBytes, static_cast<size_t>(options.maxKb) * 1024, expected.size(),
+               static_cast<unsigned long long>(decoded), static_cast<unsigned long long>(mismatches),
+               pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
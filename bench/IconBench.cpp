@@ -0,0 +1,34 @@
+#include "Bench.h"
+
+// The tray's GDI renderer, which exists only on Windows
+#ifdef _WIN32
+#include "TrayIcon.h"
+
+// One iteration = one icon; level and type cycle through fixed values.
+RAZER_BENCH(icon_render) {
+    const RazerDeviceType types[] = {RazerDeviceType::Mouse, RazerDeviceType::Keyboard,
+                                     RazerDeviceType::Headset, RazerDeviceType::Accessory};
+    for (uint64_t i = 0; i < iterations; i++) {
+        int level = static_cast<int>(i % 101);
+        HICON icon = TrayIcon::CreateBatteryIcon(level, (i & 7) == 0, types[i & 3]);
+        DoNotOptimize(icon);
+        DestroyIcon(icon);
+    }
+}
+
+RAZER_BENCH(icon_render_unavailable) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        HICON icon = TrayIcon::CreateUnavailableIcon(RazerDeviceType::Mouse);
+        DoNotOptimize(icon);
+        DestroyIcon(icon);
+    }
+}
+
+RAZER_BENCH(icon_render_placeholder) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        HICON icon = TrayIcon::CreatePlaceholderIcon();
+        DoNotOptimize(icon);
+        DestroyIcon(icon);
+    }
+}
+#endif
@@ -0,0 +1,64 @@
+#include "Bench.h"
+#include "DeviceStatusStore.h"
+#include "IpcServer.h"
+#include <cstdio>
+#include <string>
+
+// Round trips through the real local endpoint (Unix socket or named pipe)
+// with a store of four devices, as a consumer such as an overlay sees it.
+
+static std::vector<DeviceStatus> MakeStatuses(int level) {
+    std::vector<DeviceStatus> statuses;
+    for (int i = 0; i < 4; i++) {
+        DeviceStatus s;
+        char serial[16];
+        snprintf(serial, sizeof(serial), "PM%02d12345678", i);
+        s.serial = serial;
+        s.pid = 0x00B6 + i;
+        s.type = RazerDeviceType::Mouse;
+        s.name = "Razer Deathadder V2 Pro";
+        s.level = (level + i) % 101;
+        statuses.push_back(s);
+    }
+    return statuses;
+}
+
+static std::string BenchEndpoint() {
+    return IpcListener::DefaultEndpoint() + "-bench";
+}
+
+// Client asks for the snapshot and waits for the answer.
+RAZER_BENCH(ipc_get_roundtrip) {
+    DeviceStatusStore store;
+    store.Publish(MakeStatuses(50));
+    IpcServer server(store);
+    if (!server.Start(BenchEndpoint())) return;
+
+    auto channel = IpcChannel::Connect(BenchEndpoint());
+    std::string line;
+    for (uint64_t i = 0; channel && i < iterations; i++) {
+        channel->WriteLine("get");
+        if (!channel->ReadLine(line)) break;
+        DoNotOptimize(line);
+    }
+    channel.reset();
+    server.Stop();
+}
+
+// Publish a change and wait until a subscriber has received it.
+RAZER_BENCH(ipc_publish_to_subscriber) {
+    DeviceStatusStore store;
+    IpcServer server(store);
+    if (!server.Start(BenchEndpoint())) return;
+
+    auto channel = IpcChannel::Connect(BenchEndpoint());
+    std::string line;
+    if (!channel || !channel->WriteLine("subscribe") || !channel->ReadLine(line)) return;
+    for (uint64_t i = 0; i < iterations; i++) {
+        store.Publish(MakeStatuses(static_cast<int>(i)));
+        if (!channel->ReadLine(line)) break;
+        DoNotOptimize(line);
+    }
+    channel.reset();
+    server.Stop();
+}
@@ -0,0 +1,47 @@
+// Keep Debug compiled in so only the runtime level check is measured.
+#undef RAZER_LOG_MIN_LEVEL
+#define RAZER_LOG_MIN_LEVEL 0
+#include "Bench.h"
+#include "Logger.h"
+#include "RazerProtocol.h"
+
+// Mirrors the per-transfer work in RazerDevice::SendRequest (transaction id
+// fixup, CRC over the report, interface scan) so the cost of the LOG_DEBUG
+// statement can be compared against a loop that does not have one.
+static unsigned char PrepareReport(razer_report& report, uint64_t i) {
+    report.transaction_id.id = static_cast<uint8_t>(i) | 0x1F;
+    report.arguments[0] = static_cast<uint8_t>(i >> 8);
+    report.crc = razer_calculate_crc(&report);
+    return report.crc;
+}
+
+RAZER_BENCH(send_request_loop_baseline) {
+    razer_report report = {0};
+    for (uint64_t i = 0; i < iterations; i++) {
+        int interfaceCount = static_cast<int>(i & 3) + 1;
+        DoNotOptimize(PrepareReport(report, i));
+        DoNotOptimize(interfaceCount);
+    }
+}
+
+RAZER_BENCH(send_request_loop_runtime_disabled_debug) {
+    Logger::SetLevel(LogLevel::Info);
+    razer_report report = {0};
+    for (uint64_t i = 0; i < iterations; i++) {
+        int interfaceCount = static_cast<int>(i & 3) + 1;
+        DoNotOptimize(PrepareReport(report, i));
+        LOG_DEBUG("Интерфейсов в активной конфигурации: " << interfaceCount);
+        DoNotOptimize(interfaceCount);
+    }
+    Logger::SetLevel(LogLevel::Off);
+}
+
+// Cost that the runtime check avoids: formatting the same message.
+RAZER_BENCH(log_line_format_only) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        LogLine line;
+        line << "Интерфейсов в активной конфигурации: " << static_cast<int>(i & 3) + 1;
+        DoNotOptimize(line.View().size());
+        DoNotOptimize(line);
+    }
+}
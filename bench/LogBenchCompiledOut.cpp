@@ -0,0 +1,21 @@
+// Same loop as LogBench.cpp, but with Debug removed at compile time.
+#undef RAZER_LOG_MIN_LEVEL
+#define RAZER_LOG_MIN_LEVEL 1
+#include "Bench.h"
+#include "Logger.h"
+#include "RazerProtocol.h"
+
+RAZER_BENCH(send_request_loop_compiled_out_debug) {
+    Logger::SetLevel(LogLevel::Debug);
+    razer_report report = {0};
+    for (uint64_t i = 0; i < iterations; i++) {
+        int interfaceCount = static_cast<int>(i & 3) + 1;
+        report.transaction_id.id = static_cast<uint8_t>(i) | 0x1F;
+        report.arguments[0] = static_cast<uint8_t>(i >> 8);
+        report.crc = razer_calculate_crc(&report);
+        DoNotOptimize(report.crc);
+        LOG_DEBUG("Интерфейсов в активной конфигурации: " << interfaceCount);
+        DoNotOptimize(interfaceCount);
+    }
+    Logger::SetLevel(LogLevel::Off);
+}
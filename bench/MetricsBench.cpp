@@ -0,0 +1,54 @@
+#include "Bench.h"
+#include "Metrics.h"
+#include "MetricsHttpServer.h"
+#include <string>
+#include <vector>
+
+// Hot-path cost of one latency sample (a single relaxed fetch_add).
+RAZER_BENCH(metrics_histogram_record) {
+    DeviceMetrics& metrics = MetricsRegistry::Instance().ForDevice("BENCH_DEVICE");
+    for (uint64_t i = 0; i < iterations; i++) {
+        metrics.batteryLatency.Record((i * 7919) & 0xFFFFF);
+    }
+}
+
+// Per-attempt lookup + sample as done in RazerDevice::RecordEvent.
+RAZER_BENCH(metrics_protocol_lookup_and_record) {
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint8_t tid = (i & 1) ? 0xFF : 0x1F;
+        ProtocolMetrics& metrics = registry.ForProtocol(static_cast<int>(i & 3), 1, tid, 0x07, 0x80);
+        metrics.latency.Record(50000 + (i & 0x3FF));
+    }
+}
+
+RAZER_BENCH(metrics_snapshot) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        MetricsSnapshot snapshot = MetricsRegistry::Instance().Snapshot();
+        DoNotOptimize(snapshot);
+    }
+}
+
+// Body of one /metrics scrape for four devices with some history: store
+// copy aside, this is the whole cost of a scrape besides the socket.
+RAZER_BENCH(metrics_prometheus_render) {
+    std::vector<DeviceStatus> devices;
+    for (int i = 0; i < 4; i++) {
+        DeviceStatus d;
+        d.serial = "PM2143H1234567" + std::to_string(i);
+        d.pid = 0x0555;
+        d.type = RazerDeviceType::Headset;
+        d.name = "Razer Blackshark V2 Pro 2023";
+        d.level = 87;
+        DeviceMetrics& m = MetricsRegistry::Instance().ForDevice(d.serial);
+        for (int j = 0; j < 100; j++) m.batteryLatency.Record(50000 + j * 1000);
+        m.lastBatterySuccessUs.store(1, std::memory_order_relaxed);
+        devices.push_back(d);
+    }
+    std::string out;
+    for (uint64_t i = 0; i < iterations; i++) {
+        out.clear();
+        FormatPrometheusMetrics(out, devices, 7, MetricsRegistry::Instance().Snapshot(), 1000000);
+        DoNotOptimize(out);
+    }
+}
@@ -0,0 +1,328 @@
+// RazerBatteryNotifications [--events N] [--seed N] [--text]
+//
+// Drives a Poller, with listening turned on, through a simulated stream of
+// unsolicited device reports. Three devices send notifications in the
+// placeholder format of DeviceEvents.h on their interrupt endpoint; a fourth
+// has none and is only polled, every half second. The stream changes a
+// random notifying device's battery level or charging state, drops or
+// restores its link, or sends a report that is not a notification (a
+// mouse input report, half of them starting with the notification report
+// ID). The simulated device's state is changed first, as
+// real hardware would, then the report is delivered. After each one the
+// harness waits for the published snapshot to show the new state and
+// records how long that took.
+//
+// The run fails if a notification is not published within a second, if a
+// report that is not a notification changes anything or is not counted as
+// ignored, if a notifying device is queried other than after reconnecting
+// (its scheduled polls are a 60 s fallback), or if the polled device stops
+// being polled. It also feeds a time-left estimator, set up as the poller
+// sets it up, with a notifying device that drains a point every 40 minutes
+// and is polled only by the 30-minute fallback; the run fails unless that
+// estimator finds the drain rate. Emits JSON on stdout by default.
+#include "SimUsbBackend.h"
+#include "Poller.h"
+#include "BatteryEstimator.h"
+#include "DeviceEvents.h"
+#include "DeviceIds.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "RazerProtocol.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int events = 400;
+    unsigned int seed = 1;
+    bool text = false;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--events") == 0 && i + 1 < argc) {
+            options.events = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatteryNotifications [--events N] [--seed N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.events < 1) options.events = 400;
+    return true;
+}
+
+// What the snapshot should show for one simulated device
+struct SimState {
+    int id = 0;
+    std::string serial;
+    uint8_t raw = 200;
+    bool charging = false;
+    bool linked = true;
+};
+
+bool Shows(const DeviceSnapshot& snapshot, const SimState& state) {
+    for (const auto& device : snapshot.devices) {
+        if (device.serial != state.serial) continue;
+        return device.asleep == !state.linked && device.level == razer_scale_battery(state.raw) &&
+               device.charging == state.charging;
+    }
+    return false;
+}
+
+// Waits until the published snapshot shows `state`; false after a second
+bool WaitFor(Poller& poller, const SimState& state) {
+    const auto end = Clock::now() + std::chrono::seconds(1);
+    while (!Shows(*poller.GetStore().GetSnapshot(), state)) {
+        if (Clock::now() >= end) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return true;
+}
+
+bool Send(SimUsbBackend& backend, int id, NotificationCode code, uint8_t value) {
+    const unsigned char report[16] = {NotificationReportId, static_cast<unsigned char>(code), value};
+    return backend.Notify(id, report, sizeof(report));
+}
+
+struct DeviceCounts {
+    uint64_t controlTransfers = 0;
+    uint64_t queries = 0;           // status queries that went to the device
+    uint64_t notifications = 0;
+    uint64_t ignoredReports = 0;
+};
+
+DeviceCounts CountsOf(const std::vector<std::string>& serials) {
+    DeviceCounts counts;
+    for (const auto& m : MetricsRegistry::Instance().Snapshot().devices) {
+        for (const auto& serial : serials) {
+            if (m.key != serial) continue;
+            counts.controlTransfers += m.controlTransfers;
+            counts.queries += m.cacheMisses;
+            counts.notifications += m.notifications;
+            counts.ignoredReports += m.ignoredReports;
+        }
+    }
+    return counts;
+}
+
+// A notifying device draining a point every 40 minutes, over ten hours
+// of simulated time: each drop arrives as a notification, and the poller's
+// fallback query comes every listeningRefreshInterval. Returns the rate the
+// estimator fitted, in points per hour (0 without an estimate).
+double SlowDrainRate(const PollerOptions& options) {
+    BatteryEstimator estimator(Poller::EstimatorOptions(options));
+    const int64_t dropEvery = 40 * 60;
+    const int64_t pollEvery = std::chrono::duration_cast<std::chrono::seconds>(options.listeningRefreshInterval).count();
+    int64_t nextDrop = dropEvery;
+    int64_t nextPoll = pollEvery;
+    int level = 90;
+    estimator.Add(0, level, false);
+    while (nextDrop <= 10 * 3600 || nextPoll <= 10 * 3600) {
+        int64_t time = std::min(nextDrop, nextPoll);
+        if (time == nextDrop) {
+            level--;
+            nextDrop += dropEvery;
+        }
+        if (time == nextPoll) nextPoll += pollEvery;
+        estimator.Add(time, level, false);
+    }
+    return estimator.SecondsToEmpty() > 0 ? estimator.RatePerHour() : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    auto backend = std::make_shared<SimUsbBackend>();
+    std::vector<SimState> notifying;
+    std::vector<std::string> notifyingSerials;
+    for (int i = 0; i < 3; i++) {
+        SimDeviceSpec spec;
+        spec.pid = static_cast<uint16_t>(RazerDeviceIds[i]);
+        spec.serial = "NOTIFY0000" + std::to_string(i);
+        SimState state;
+        state.id = backend->Plug(spec);
+        state.serial = spec.serial;
+        state.raw = spec.batteryRaw;
+        notifying.push_back(state);
+        notifyingSerials.push_back(spec.serial);
+    }
+    SimDeviceSpec polledSpec;
+    polledSpec.pid = static_cast<uint16_t>(RazerDeviceIds[3]);
+    polledSpec.serial = "POLLED00000";
+    polledSpec.interruptEndpoint = false;
+    backend->Plug(polledSpec);
+
+    PollerOptions pollerOptions;
+    pollerOptions.endpoint = IpcListener::DefaultEndpoint() + "-notifications";
+#ifdef _WIN32
+    pollerOptions.sharedStatusName = RAZER_SHARED_STATUS_LOCAL_NAME "-notifications";
+#else
+    pollerOptions.sharedStatusName = DefaultSharedStatusName() + "-notifications";
+#endif
+    pollerOptions.access = LocalAccess::CurrentUser;
+    pollerOptions.refreshInterval = std::chrono::milliseconds(500);
+    pollerOptions.listenForEvents = true;
+    pollerOptions.listeningRefreshInterval = std::chrono::seconds(60);
+    pollerOptions.enumerateDelay = std::chrono::milliseconds(10);
+
+    Poller poller(backend, pollerOptions);
+    if (!poller.Start()) {
+        fprintf(stderr, "cannot serve %s\n", pollerOptions.endpoint.c_str());
+        return 1;
+    }
+
+    // Each notifying device is listened to once its first query found its
+    // interface; the first notification it sends marks it as notifying
+    bool ready = true;
+    for (auto& state : notifying) {
+        const auto end = Clock::now() + std::chrono::seconds(5);
+        while (!Send(*backend, state.id, NotificationCode::Battery, state.raw) && Clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (!WaitFor(poller, state)) ready = false;
+    }
+
+    const DeviceCounts notifyingBefore = CountsOf(notifyingSerials);
+    const DeviceCounts polledBefore = CountsOf({polledSpec.serial});
+    const uint64_t notificationsBefore = poller.GetNotificationCount();
+
+    std::minstd_rand random(options.seed);
+    std::uniform_int_distribution<int> pause(2, 20);
+    std::uniform_int_distribution<size_t> pick(0, notifying.size() - 1);
+    std::uniform_int_distribution<int> kind(0, 19);
+    LatencyHistogram latency;
+    uint64_t sent = 0;
+    uint64_t missed = 0;
+    uint64_t junk = 0;
+    uint64_t junkChanged = 0;
+    uint64_t reconnects = 0;
+    const auto start = Clock::now();
+    for (int i = 0; i < options.events && ready; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(pause(random)));
+        SimState& state = notifying[pick(random)];
+        int k = kind(random);
+
+        if (k >= 17) {
+            // Mouse input report, every other one with report ID 0x05 and a
+            // battery code in byte 1: must change nothing
+            DeviceSnapshotPtr before = poller.GetStore().GetSnapshot();
+            const unsigned char id = junk % 2 ? NotificationReportId : 0x01;
+            const unsigned char report[8] = {id, 0x80, static_cast<unsigned char>(i), 0xFE, 0x01};
+            backend->Notify(state.id, report, sizeof(report));
+            junk++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if (poller.GetStore().GetSnapshot()->version != before->version) junkChanged++;
+            continue;
+        }
+
+        auto sentAt = Clock::now();
+        if (!state.linked || k >= 15) {
+            // Link lost, or back: a device out of range only comes back
+            state.linked = !state.linked;
+            backend->SetAsleep(state.id, !state.linked);
+            if (state.linked) reconnects++;
+            sentAt = Clock::now();
+            Send(*backend, state.id, NotificationCode::Link, state.linked ? 1 : 0);
+        } else if (k >= 11) {
+            state.charging = !state.charging;
+            backend->SetBattery(state.id, state.raw, state.charging);
+            sentAt = Clock::now();
+            Send(*backend, state.id, NotificationCode::Charging, state.charging ? 1 : 0);
+        } else {
+            int step = 1 + static_cast<int>(random() % 6);
+            state.raw = static_cast<uint8_t>(state.raw > 20 + step ? state.raw - step : 255);
+            backend->SetBattery(state.id, state.raw, state.charging);
+            sentAt = Clock::now();
+            Send(*backend, state.id, NotificationCode::Battery, state.raw);
+        }
+        sent++;
+        if (!WaitFor(poller, state)) {
+            missed++;
+            continue;
+        }
+        latency.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sentAt).count()));
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    // Let a reconnect's query finish before counting, and give the polled
+    // device time for a poll past its status cache on a short run
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto pollEnd = Clock::now() + std::chrono::seconds(5);
+    while (CountsOf({polledSpec.serial}).queries == polledBefore.queries && Clock::now() < pollEnd) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    const DeviceCounts notifyingAfter = CountsOf(notifyingSerials);
+    const DeviceCounts polledAfter = CountsOf({polledSpec.serial});
+    const uint64_t published = poller.GetNotificationCount() - notificationsBefore;
+    poller.Stop();
+
+    const uint64_t notifyingQueries = notifyingAfter.queries - notifyingBefore.queries;
+    const uint64_t notifyingTransfers = notifyingAfter.controlTransfers - notifyingBefore.controlTransfers;
+    const uint64_t polledQueries = polledAfter.queries - polledBefore.queries;
+    const uint64_t polledTransfers = polledAfter.controlTransfers - polledBefore.controlTransfers;
+    const uint64_t ignored = notifyingAfter.ignoredReports - notifyingBefore.ignoredReports;
+    LatencyHistogram::Snapshot latencies = latency.Read();
+    // Default schedule: a point every 40 minutes is 1.5 points an hour
+    PollerOptions listening;
+    listening.listenForEvents = true;
+    const double slowRate = SlowDrainRate(listening);
+    const bool slowEstimated = std::fabs(slowRate + 1.5) < 0.3;
+
+    const bool pass = ready && sent > 0 && missed == 0 && junkChanged == 0 && ignored == junk &&
+                      published >= sent && notifyingQueries <= reconnects && polledQueries > 0 && slowEstimated;
+    if (options.text) {
+        printf("%llu notifications in %.1f s (%llu reconnects), %llu other reports\n",
+               static_cast<unsigned long long>(sent), seconds, static_cast<unsigned long long>(reconnects),
+               static_cast<unsigned long long>(junk));
+        printf("published p50 <= %.2f ms, p99 <= %.2f ms; missed %llu\n", latencies.Percentile(0.5) / 1000.0,
+               latencies.Percentile(0.99) / 1000.0, static_cast<unsigned long long>(missed));
+        printf("ignored reports: %llu, changed the snapshot: %llu\n", static_cast<unsigned long long>(ignored),
+               static_cast<unsigned long long>(junkChanged));
+        printf("notifying devices: %llu queries, %llu transfers; polled device: %llu queries, %llu transfers\n",
+               static_cast<unsigned long long>(notifyingQueries), static_cast<unsigned long long>(notifyingTransfers),
+               static_cast<unsigned long long>(polledQueries), static_cast<unsigned long long>(polledTransfers));
+        printf("slow drain (1.5 points/h, polled every %lld min): fitted %.2f points/h\n",
+               static_cast<long long>(std::chrono::duration_cast<std::chrono::minutes>(
+                   PollerOptions().listeningRefreshInterval).count()), slowRate);
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatteryNotifications\",\n");
+        printf("  \"notifications\": %llu,\n  \"duration_s\": %.1f,\n  \"reconnects\": %llu,\n",
+               static_cast<unsigned long long>(sent), seconds, static_cast<unsigned long long>(reconnects));
+        printf("  \"published_ms\": {\"p50\": %.2f, \"p99\": %.2f},\n  \"missed\": %llu,\n",
+               latencies.Percentile(0.5) / 1000.0, latencies.Percentile(0.99) / 1000.0,
+               static_cast<unsigned long long>(missed));
+        printf("  \"other_reports\": %llu,\n  \"ignored\": %llu,\n  \"changed_by_other_reports\": %llu,\n",
+               static_cast<unsigned long long>(junk), static_cast<unsigned long long>(ignored),
+               static_cast<unsigned long long>(junkChanged));
+        printf("  \"notifying\": {\"queries\": %llu, \"control_transfers\": %llu},\n",
+               static_cast<unsigned long long>(notifyingQueries), static_cast<unsigned long long>(notifyingTransfers));
+        printf("  \"polled\": {\"queries\": %llu, \"control_transfers\": %llu},\n",
+               static_cast<unsigned long long>(polledQueries), static_cast<unsigned long long>(polledTransfers));
+        printf("  \"slow_drain_points_per_hour\": %.2f,\n", slowRate);
+        printf("  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
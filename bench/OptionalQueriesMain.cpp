@@ -0,0 +1,146 @@
+// RazerBatteryOptionalQueries [--text]
+//
+// Checks that a device refusing the optional queries keeps the path its
+// battery answered on. Each case plugs one simulated device that answers
+// on its second interface. Some cases have it answer "not supported" to
+// the low-battery threshold (0x07/0x81), some to the idle time (0x07/0x83),
+// some to both. The harness queries it once, starts listening for its
+// notifications, waits out the status cache and queries it again.
+//
+// The run fails if the battery is not read, if the first query claims an
+// interface beyond the scan that found the battery, if listening cannot
+// start or stops, or if the second query claims any interface or sends
+// more than the battery and charging exchanges.
+// Emits JSON on stdout by default.
+#include "SimUsbBackend.h"
+#include "RazerDevice.h"
+#include "DeviceIds.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    bool text = false;
+};
+
+struct Case {
+    const char* name;
+    int lowThresholdRaw;
+    int idleSeconds;
+    int expectedThreshold;      // as reported in the status
+    // Filled in by the run
+    int level = -1;
+    int threshold = -1;
+    uint64_t firstClaims = 0;
+    bool listening = false;
+    uint64_t secondClaims = 0;
+    uint64_t secondTransfers = 0;
+    bool stillListening = false;
+};
+
+// One exchange is a SET_REPORT and a GET_REPORT; a refresh of a known
+// device asks for the battery and the charging state
+constexpr uint64_t RefreshTransfers = 4;
+constexpr int RespondingInterface = 1;
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatteryOptionalQueries [--text]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+void Run(Case& c) {
+    auto backend = std::make_shared<SimUsbBackend>();
+    SimDeviceSpec spec;
+    spec.pid = static_cast<uint16_t>(RazerDeviceIds[0]);
+    spec.serial = "OPTIONAL000001";
+    spec.respondingInterface = RespondingInterface;
+    spec.lowThresholdRaw = c.lowThresholdRaw;
+    spec.idleSeconds = c.idleSeconds;
+    backend->Plug(spec);
+    std::vector<std::shared_ptr<UsbDevice>> devices = backend->ListDevices();
+    if (devices.empty()) return;
+
+    const SimUsbBackend::Counters& counters = backend->GetCounters();
+    RazerDevice device(devices[0], spec.pid, 0);
+    DeviceStatus first = device.QueryStatus();
+    c.level = first.level;
+    c.threshold = first.lowBatteryThreshold;
+    c.firstClaims = counters.claims.load();
+    c.listening = device.StartListening([](DeviceEventKind, const DeviceStatus&) {});
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(RazerDevice::StatusTtlMs + 100));
+    uint64_t transfersBefore = counters.controlTransfers.load();
+    DeviceStatus second = device.QueryStatus();
+    c.secondClaims = counters.claims.load() - c.firstClaims;
+    c.secondTransfers = counters.controlTransfers.load() - transfersBefore;
+    c.stillListening = device.IsListening() && second.level != -1;
+    device.StopListening();
+}
+
+bool Passed(const Case& c) {
+    // The scan claims interfaces 0 .. RespondingInterface once each
+    return c.level != -1 && c.threshold == c.expectedThreshold &&
+           c.firstClaims == static_cast<uint64_t>(RespondingInterface + 1) && c.listening &&
+           c.secondClaims == 0 && c.secondTransfers == RefreshTransfers && c.stillListening;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    std::vector<Case> cases = {
+        {"both answered", 0x26, 300, 15},
+        {"threshold not supported", -1, 300, -1},
+        {"idle time not supported", 0x26, -1, 15},
+        {"neither supported", -1, -1, -1},
+    };
+    bool pass = true;
+    for (Case& c : cases) {
+        Run(c);
+        pass = pass && Passed(c);
+    }
+
+    if (options.text) {
+        for (const Case& c : cases) {
+            printf("%-24s level %d, threshold %d; first query %llu claims, listening %s; "
+                   "second query %llu claims, %llu transfers, listening %s: %s\n",
+                   c.name, c.level, c.threshold, static_cast<unsigned long long>(c.firstClaims),
+                   c.listening ? "yes" : "no", static_cast<unsigned long long>(c.secondClaims),
+                   static_cast<unsigned long long>(c.secondTransfers), c.stillListening ? "yes" : "no",
+                   Passed(c) ? "ok" : "failed");
+        }
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatteryOptionalQueries\",\n  \"cases\": [\n");
+        for (size_t i = 0; i < cases.size(); i++) {
+            const Case& c = cases[i];
+            printf("    {\"name\": \"%s\", \"level\": %d, \"threshold\": %d, "
+                   "\"first\": {\"claims\": %llu, \"listening\": %s}, "
+                   "\"second\": {\"claims\": %llu, \"control_transfers\": %llu, \"listening\": %s}, "
+                   "\"result\": \"%s\"}%s\n",
+                   c.name, c.level, c.threshold, static_cast<unsigned long long>(c.firstClaims),
+                   c.listening ? "true" : "false", static_cast<unsigned long long>(c.secondClaims),
+                   static_cast<unsigned long long>(c.secondTransfers), c.stillListening ? "true" : "false",
+                   Passed(c) ? "pass" : "fail", i + 1 < cases.size() ? "," : "");
+        }
+        printf("  ],\n  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+// RazerBatteryPowerState [--pause-ms N] [--text]
+//
+// Drives a Poller's pause and resume through a ManualPowerSource, standing
+// in for the OS. Scheduled polls run every half second against simulated
+// devices. Each cycle pauses with one kind of event (suspend, display off,
+// lid closed, battery saver) and holds the pause for --pause-ms (2.5 s, past
+// the 2 s status cache, so the refresh after it goes to the devices). During
+// the pause a device is plugged or unplugged, and a client refresh and a
+// re-enumeration are requested. Then the cycle resumes.
+//
+// The run fails if any control transfer or enumeration happens while
+// paused, or if the resume is followed by anything other than exactly one
+// enumerate and one refresh. That refresh must serve the request made
+// during the pause and show the device change. Emits JSON on stdout by
+// default.
+#include "SimUsbBackend.h"
+#include "Poller.h"
+#include "DeviceIds.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int pauseMs = 2500;
+    bool text = false;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pause-ms") == 0 && i + 1 < argc) {
+            options.pauseMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatteryPowerState [--pause-ms N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.pauseMs < 1) options.pauseMs = 2500;
+    return true;
+}
+
+struct Cycle {
+    PowerEvent pause;
+    PowerEvent resume;
+    uint64_t pausedTransfers = 0;
+    uint64_t pausedListings = 0;
+    uint64_t pausedRefreshes = 0;
+    uint64_t resumeTransfers = 0;
+    uint64_t resumeListings = 0;
+    uint64_t resumeRefreshes = 0;
+    bool requestServed = false;
+    bool changeShown = false;
+};
+
+struct Counts {
+    uint64_t transfers;
+    uint64_t listings;
+    uint64_t refreshes;
+};
+
+Counts CountsOf(const SimUsbBackend& backend, const Poller& poller) {
+    return {backend.GetCounters().controlTransfers.load(), backend.GetCounters().listings.load(),
+            poller.GetRefreshCount()};
+}
+
+bool WaitUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    const auto end = Clock::now() + timeout;
+    while (!done()) {
+        if (Clock::now() >= end) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+size_t DeviceCount(Poller& poller) {
+    return poller.GetStore().GetSnapshot()->devices.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    auto backend = std::make_shared<SimUsbBackend>();
+    for (int i = 0; i < 3; i++) {
+        SimDeviceSpec spec;
+        spec.pid = static_cast<uint16_t>(RazerDeviceIds[i]);
+        spec.serial = "POWER00000" + std::to_string(i);
+        backend->Plug(spec);
+    }
+    auto power = std::make_shared<ManualPowerSource>();
+
+    PollerOptions pollerOptions;
+    pollerOptions.endpoint = IpcListener::DefaultEndpoint() + "-power";
+#ifdef _WIN32
+    pollerOptions.sharedStatusName = RAZER_SHARED_STATUS_LOCAL_NAME "-power";
+#else
+    pollerOptions.sharedStatusName = DefaultSharedStatusName() + "-power";
+#endif
+    pollerOptions.access = LocalAccess::CurrentUser;
+    pollerOptions.refreshInterval = std::chrono::milliseconds(500);
+    pollerOptions.enumerateDelay = std::chrono::milliseconds(20);
+    pollerOptions.minRequestInterval = std::chrono::milliseconds(50);
+    pollerOptions.powerSource = power;
+
+    Poller poller(backend, pollerOptions);
+    if (!poller.Start()) {
+        fprintf(stderr, "cannot serve %s\n", pollerOptions.endpoint.c_str());
+        return 1;
+    }
+    bool ready = WaitUntil([&] { return DeviceCount(poller) == 3; }, std::chrono::seconds(5));
+
+    std::vector<Cycle> cycles = {
+        {PowerEvent::Suspend, PowerEvent::Resume},
+        {PowerEvent::DisplayOff, PowerEvent::DisplayOn},
+        {PowerEvent::LidClosed, PowerEvent::LidOpened},
+        {PowerEvent::SaverOn, PowerEvent::SaverOff},
+    };
+    int extra = 0; // id of the device plugged during a pause, 0 if none
+    for (size_t c = 0; c < cycles.size() && ready; c++) {
+        Cycle& cycle = cycles[c];
+        power->Emit(cycle.pause);
+        if (!poller.IsPaused()) break;
+        // A batch already under way runs to its end
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        Counts before = CountsOf(*backend, poller);
+        const uint64_t requestsBefore = poller.GetInteractiveLatency().Count();
+
+        // Half the pause, a device change and a client request, the rest
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.pauseMs / 2));
+        size_t expected = 3;
+        if (extra) {
+            backend->Unplug(extra);
+            extra = 0;
+        } else {
+            SimDeviceSpec spec;
+            spec.pid = static_cast<uint16_t>(RazerDeviceIds[3]);
+            spec.serial = "POWER0000" + std::to_string(10 + c);
+            extra = backend->Plug(spec);
+            expected = 4;
+        }
+        poller.RequestEnumerate();
+        poller.RequestRefresh();
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.pauseMs - options.pauseMs / 2));
+
+        Counts paused = CountsOf(*backend, poller);
+        cycle.pausedTransfers = paused.transfers - before.transfers;
+        cycle.pausedListings = paused.listings - before.listings;
+        cycle.pausedRefreshes = paused.refreshes - before.refreshes;
+
+        power->Emit(cycle.resume);
+        WaitUntil([&] { return poller.GetRefreshCount() > paused.refreshes; }, std::chrono::seconds(2));
+        // Short of the next scheduled poll, half a second after the resume
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        Counts resumed = CountsOf(*backend, poller);
+        cycle.resumeTransfers = resumed.transfers - paused.transfers;
+        cycle.resumeListings = resumed.listings - paused.listings;
+        cycle.resumeRefreshes = resumed.refreshes - paused.refreshes;
+        cycle.requestServed = poller.GetInteractiveLatency().Count() == requestsBefore + 1;
+        cycle.changeShown = DeviceCount(poller) == expected;
+    }
+    poller.Stop();
+
+    bool pass = ready;
+    for (const auto& cycle : cycles) {
+        pass = pass && cycle.pausedTransfers == 0 && cycle.pausedListings == 0 && cycle.pausedRefreshes == 0 &&
+               cycle.resumeListings == 1 && cycle.resumeRefreshes == 1 && cycle.resumeTransfers > 0 &&
+               cycle.requestServed && cycle.changeShown;
+    }
+    if (options.text) {
+        for (const auto& cycle : cycles) {
+            printf("%-11s %5d ms paused: %llu transfers, %llu enumerations; after %-10s %llu enumeration(s), "
+                   "%llu refresh(es), %llu transfers; request %s, device change %s\n",
+                   PowerEventName(cycle.pause), options.pauseMs,
+                   static_cast<unsigned long long>(cycle.pausedTransfers),
+                   static_cast<unsigned long long>(cycle.pausedListings), PowerEventName(cycle.resume),
+                   static_cast<unsigned long long>(cycle.resumeListings),
+                   static_cast<unsigned long long>(cycle.resumeRefreshes),
+                   static_cast<unsigned long long>(cycle.resumeTransfers), cycle.requestServed ? "served" : "missed",
+                   cycle.changeShown ? "shown" : "missed");
+        }
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatteryPowerState\",\n  \"pause_ms\": %d,\n  \"cycles\": [\n", options.pauseMs);
+        for (size_t c = 0; c < cycles.size(); c++) {
+            const Cycle& cycle = cycles[c];
+            printf("    {\"pause\": \"%s\", \"resume\": \"%s\", "
+                   "\"paused\": {\"control_transfers\": %llu, \"enumerations\": %llu, \"refreshes\": %llu}, "
+                   "\"after_resume\": {\"control_transfers\": %llu, \"enumerations\": %llu, \"refreshes\": %llu}, "
+                   "\"request_served\": %s, \"device_change_shown\": %s}%s\n",
+                   PowerEventName(cycle.pause), PowerEventName(cycle.resume),
+                   static_cast<unsigned long long>(cycle.pausedTransfers),
+                   static_cast<unsigned long long>(cycle.pausedListings),
+                   static_cast<unsigned long long>(cycle.pausedRefreshes),
+                   static_cast<unsigned long long>(cycle.resumeTransfers),
+                   static_cast<unsigned long long>(cycle.resumeListings),
+                   static_cast<unsigned long long>(cycle.resumeRefreshes), cycle.requestServed ? "true" : "false",
+                   cycle.changeShown ? "true" : "false", c + 1 < cycles.size() ? "," : "");
+        }
+        printf("  ],\n  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include "Bench.h"
+#include "DeviceIds.h"
+#include "DeviceKey.h"
+#include "RazerProtocol.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Fixed inputs: every PID from DeviceIds.h, so results only change when
+// the code (or the ID table) does.
+static constexpr size_t kPidCount = sizeof(RazerDeviceIds) / sizeof(RazerDeviceIds[0]);
+
+RAZER_BENCH(protocol_crc) {
+    razer_report report = get_razer_report(0x07, 0x80, 0x02);
+    for (size_t i = 0; i < sizeof(report.arguments); i++) report.arguments[i] = static_cast<uint8_t>(i * 31);
+    for (uint64_t i = 0; i < iterations; i++) {
+        report.transaction_id.id = static_cast<uint8_t>(i);
+        DoNotOptimize(razer_calculate_crc(&report));
+    }
+}
+
+// Request construction as done per query in RazerDevice (build, tid, CRC).
+RAZER_BENCH(protocol_build_request) {
+    const uint8_t ids[] = {0xFF, 0x1F, 0x3F};
+    for (uint64_t i = 0; i < iterations; i++) {
+        razer_report request = get_razer_report(0x07, 0x80, 0x02);
+        request.transaction_id.id = ids[i % 3];
+        request.crc = razer_calculate_crc(&request);
+        DoNotOptimize(request);
+    }
+}
+
+// One iteration = every known PID plus one unknown.
+RAZER_BENCH(device_type_lookup_all_pids) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        int counts[5] = {0};
+        for (size_t p = 0; p < kPidCount; p++) {
+            counts[static_cast<int>(GetRazerDeviceType(RazerDeviceIds[p]))]++;
+        }
+        counts[static_cast<int>(GetRazerDeviceType(0xFFFF))]++;
+        DoNotOptimize(counts);
+    }
+}
+
+// One iteration = all 256 raw readings.
+RAZER_BENCH(battery_scale_all_raw_values) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        int sum = 0;
+        for (int raw = 0; raw < 256; raw++) {
+            sum += razer_scale_battery(static_cast<uint8_t>(raw));
+        }
+        DoNotOptimize(sum);
+    }
+}
+
+namespace {
+
+struct FakeDevice {
+    int pid;
+    std::wstring serial;
+};
+
+std::vector<std::shared_ptr<FakeDevice>> MakeDevices(size_t count) {
+    std::vector<std::shared_ptr<FakeDevice>> devices;
+    for (size_t i = 0; i < count; i++) {
+        int pid = RazerDeviceIds[(i * 37) % kPidCount];
+        // Every third device has no readable serial and falls back to the PID key
+        std::wstring serial = (i % 3 == 2) ? L"" : L"PM" + std::to_wstring(1000000 + i * 7919);
+        devices.push_back(std::make_shared<FakeDevice>(FakeDevice{pid, serial}));
+    }
+    return devices;
+}
+
+// existingMap + newMap passes of RazerManager::EnumerateDevices.
+void BuildMaps(const std::vector<std::shared_ptr<FakeDevice>>& devices, uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        std::map<std::wstring, std::shared_ptr<FakeDevice>> existingMap;
+        for (auto& d : devices) {
+            existingMap[MakeDeviceKey(d->serial, d->pid)] = d;
+        }
+        std::map<std::wstring, std::shared_ptr<FakeDevice>> newMap;
+        for (auto& d : devices) {
+            std::wstring key = MakeDeviceKey(d->serial, d->pid);
+            auto it = existingMap.find(key);
+            if (!newMap.count(key)) newMap[key] = it != existingMap.end() ? it->second : d;
+        }
+        DoNotOptimize(newMap);
+    }
+}
+
+} // namespace
+
+RAZER_BENCH(enumerate_map_build_8_devices) {
+    static const auto devices = MakeDevices(8);
+    BuildMaps(devices, iterations);
+}
+
+RAZER_BENCH(enumerate_map_build_64_devices) {
+    static const auto devices = MakeDevices(64);
+    BuildMaps(devices, iterations);
+}
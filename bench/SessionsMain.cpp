@@ -0,0 +1,336 @@
+// RazerBatterySessions [--duration-s N] [--latency-s N] [--max-sessions N] [--text]
+//
+// Checks that the poller/tray split keeps USB traffic independent of the
+// number of logged-in sessions. For each session count (1, 2, 4, ... up to
+// --max-sessions) a Poller runs against the simulated backend on a private
+// endpoint, that many TrayClients subscribe, and every client asks for a
+// refresh as often as it can for the measured phase. The run fails if the
+// control-transfer rate with the most sessions exceeds the single-session
+// rate by more than two refreshes' worth, or if any client missed updates.
+//
+// A second phase measures how long a client refresh takes while scheduled
+// polls run every half second against slow receivers. A client asks for a
+// refresh, waits until it has been published, pauses and asks again, for
+// --latency-s seconds: once with PollerOptions::interactiveFirst and once
+// with requests queued behind background work. The run also fails if the
+// interactive p99 is not lower with interactiveFirst.
+// Emits JSON on stdout by default.
+#include "SimUsbBackend.h"
+#include "Poller.h"
+#include "TrayClient.h"
+#include "DeviceIds.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    double durationS = 2;
+    double latencyS = 8;
+    int maxSessions = 16;
+    bool text = false;
+};
+
+struct Result {
+    int sessions = 0;
+    uint64_t controlTransfers = 0;
+    uint64_t startupTransfers = 0;  // the first enumeration and query
+    uint64_t refreshes = 0;
+    uint64_t refreshRequests = 0;
+    uint64_t minUpdatesPerClient = 0;
+    double seconds = 0;
+};
+
+struct LatencyResult {
+    bool interactiveFirst = false;
+    uint64_t refreshes = 0;         // interactive ones
+    uint64_t backgroundBatches = 0;
+    uint64_t preemptions = 0;
+    uint64_t p50Us = 0;
+    uint64_t p99Us = 0;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) {
+            options.durationS = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--latency-s") == 0 && i + 1 < argc) {
+            options.latencyS = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-sessions") == 0 && i + 1 < argc) {
+            options.maxSessions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatterySessions [--duration-s N] [--latency-s N] [--max-sessions N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.durationS <= 0) options.durationS = 2;
+    if (options.latencyS <= 0) options.latencyS = 8;
+    if (options.maxSessions < 1 || options.maxSessions > 64) options.maxSessions = 16;
+    return true;
+}
+
+// Per-session view of what the tray would render.
+struct Session {
+    std::atomic<uint64_t> updates{0};
+    std::atomic<bool> connected{false};
+    std::unique_ptr<TrayClient> client;
+};
+
+Result Run(int sessionCount, const Options& options) {
+    auto backend = std::make_shared<SimUsbBackend>();
+    std::vector<int> ids;
+    for (int i = 0; i < 2; i++) {
+        SimDeviceSpec spec;
+        spec.pid = static_cast<uint16_t>(RazerDeviceIds[i]);
+        spec.serial = "SESSION0000" + std::to_string(i);
+        ids.push_back(backend->Plug(spec));
+    }
+
+    PollerOptions pollerOptions;
+    pollerOptions.endpoint = IpcListener::DefaultEndpoint() + "-sessions";
+#ifdef _WIN32
+    pollerOptions.sharedStatusName = RAZER_SHARED_STATUS_LOCAL_NAME "-sessions";
+#else
+    pollerOptions.sharedStatusName = DefaultSharedStatusName() + "-sessions";
+#endif
+    pollerOptions.access = LocalAccess::CurrentUser;
+    pollerOptions.refreshInterval = std::chrono::hours(1); // only requests drive I/O
+    pollerOptions.minRequestInterval = std::chrono::milliseconds(100);
+    pollerOptions.enumerateDelay = std::chrono::milliseconds(10);
+
+    Result result;
+    result.sessions = sessionCount;
+    Poller poller(backend, pollerOptions);
+    if (!poller.Start()) {
+        fprintf(stderr, "cannot serve %s\n", pollerOptions.endpoint.c_str());
+        return result;
+    }
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (int i = 0; i < sessionCount; i++) {
+        auto session = std::make_unique<Session>();
+        Session* s = session.get();
+        s->client = std::make_unique<TrayClient>([s](const std::vector<DeviceStatus>&, bool connected) {
+            s->connected.store(connected);
+            if (connected) s->updates.fetch_add(1);
+        }, pollerOptions.endpoint);
+        s->client->Start();
+        sessions.push_back(std::move(session));
+    }
+
+    // Settle: every client has the initial snapshot and the startup
+    // enumeration is done.
+    for (auto& s : sessions) {
+        while (!s->connected.load()) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    while (poller.GetRefreshCount() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (auto& s : sessions) s->updates.store(0);
+
+    const uint64_t transfersBefore = backend->GetCounters().controlTransfers.load();
+    result.startupTransfers = transfersBefore;
+    const uint64_t refreshesBefore = poller.GetRefreshCount();
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration<double>(options.durationS);
+
+    // Battery drifts so every refresh publishes a new version
+    std::atomic<bool> done{false};
+    std::thread drift([&] {
+        uint8_t raw = 0;
+        while (!done.load()) {
+            for (int id : ids) backend->SetBattery(id, raw, false);
+            raw++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    });
+
+    std::atomic<uint64_t> requests{0};
+    std::vector<std::thread> spammers;
+    for (auto& s : sessions) {
+        TrayClient* client = s->client.get();
+        spammers.emplace_back([client, end, &requests] {
+            while (Clock::now() < end) {
+                client->RequestRefresh();
+                requests.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+    }
+    for (auto& t : spammers) t.join();
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.controlTransfers = backend->GetCounters().controlTransfers.load() - transfersBefore;
+    result.refreshes = poller.GetRefreshCount() - refreshesBefore;
+    result.refreshRequests = requests.load();
+
+    // The last refresh requested may still be in flight
+    std::this_thread::sleep_for(pollerOptions.minRequestInterval * 2);
+    done.store(true);
+    drift.join();
+
+    result.minUpdatesPerClient = UINT64_MAX;
+    for (auto& s : sessions) {
+        result.minUpdatesPerClient = std::min(result.minUpdatesPerClient, s->updates.load());
+        s->client->Stop();
+    }
+    poller.Stop();
+    return result;
+}
+
+LatencyResult RunInteractive(bool interactiveFirst, const Options& options) {
+    auto backend = std::make_shared<SimUsbBackend>();
+    for (int i = 0; i < 3; i++) {
+        SimDeviceSpec spec;
+        spec.pid = static_cast<uint16_t>(RazerDeviceIds[i]);
+        spec.serial = "LATENCY0000" + std::to_string(i);
+        spec.transferDelayMs = 20;
+        backend->Plug(spec);
+    }
+
+    PollerOptions pollerOptions;
+    pollerOptions.endpoint = IpcListener::DefaultEndpoint() + "-latency";
+#ifdef _WIN32
+    pollerOptions.sharedStatusName = RAZER_SHARED_STATUS_LOCAL_NAME "-latency";
+#else
+    pollerOptions.sharedStatusName = DefaultSharedStatusName() + "-latency";
+#endif
+    pollerOptions.access = LocalAccess::CurrentUser;
+    pollerOptions.refreshInterval = std::chrono::milliseconds(500);
+    pollerOptions.minRequestInterval = std::chrono::milliseconds(300);
+    pollerOptions.enumerateDelay = std::chrono::milliseconds(10);
+    pollerOptions.interactiveFirst = interactiveFirst;
+
+    LatencyResult result;
+    result.interactiveFirst = interactiveFirst;
+    Poller poller(backend, pollerOptions);
+    if (!poller.Start()) {
+        fprintf(stderr, "cannot serve %s\n", pollerOptions.endpoint.c_str());
+        return result;
+    }
+    TrayClient client([](const std::vector<DeviceStatus>&, bool) {}, pollerOptions.endpoint);
+    client.Start();
+    while (poller.GetRefreshCount() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // Requests land at random points of the polling schedule, always more
+    // than minRequestInterval apart
+    std::minstd_rand random(interactiveFirst ? 1 : 2);
+    std::uniform_int_distribution<int> pause(350, 600);
+    const uint64_t batchesBefore = poller.GetRefreshCount();
+    const auto end = Clock::now() + std::chrono::duration<double>(options.latencyS);
+    while (Clock::now() < end) {
+        uint64_t served = poller.GetInteractiveLatency().Count();
+        if (!client.RequestRefresh()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        while (poller.GetInteractiveLatency().Count() == served) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(pause(random)));
+    }
+
+    LatencyHistogram::Snapshot latency = poller.GetInteractiveLatency();
+    result.refreshes = latency.Count();
+    result.backgroundBatches = poller.GetRefreshCount() - batchesBefore - result.refreshes;
+    result.preemptions = poller.GetPreemptionCount();
+    result.p50Us = latency.Percentile(0.5);
+    result.p99Us = latency.Percentile(0.99);
+    client.Stop();
+    poller.Stop();
+    return result;
+}
+
+double Rate(const Result& r) {
+    return r.seconds > 0 ? r.controlTransfers / r.seconds : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    Logger::SetLevel(LogLevel::Off);
+
+    std::vector<Result> results;
+    for (int n = 1; n <= options.maxSessions; n *= 2) {
+        results.push_back(Run(n, options));
+    }
+
+    std::vector<LatencyResult> latencies;
+    latencies.push_back(RunInteractive(true, options));
+    latencies.push_back(RunInteractive(false, options));
+
+    const Result& first = results.front();
+    const Result& last = results.back();
+    // A refresh at either edge of the phase may or may not be counted. Most
+    // refreshes in the phase are served by the status cache, so a refresh's
+    // worth is what the uncached startup one cost.
+    const double perRefresh = static_cast<double>(first.startupTransfers);
+    const double allowed = Rate(first) + 2 * perRefresh / first.seconds;
+    bool pass = first.refreshes > 0 && Rate(last) <= allowed;
+    for (const Result& r : results) {
+        if (r.refreshes == 0 || r.minUpdatesPerClient == 0) pass = false;
+    }
+    const LatencyResult& prioritized = latencies[0];
+    const LatencyResult& queued = latencies[1];
+    if (prioritized.refreshes == 0 || queued.refreshes == 0 || prioritized.p99Us >= queued.p99Us) pass = false;
+
+    if (options.text) {
+        for (const Result& r : results) {
+            printf("%2d sessions: %6llu requests, %3llu refreshes, %5llu transfers (%.0f/s), min updates per client %llu\n",
+                   r.sessions, static_cast<unsigned long long>(r.refreshRequests),
+                   static_cast<unsigned long long>(r.refreshes),
+                   static_cast<unsigned long long>(r.controlTransfers), Rate(r),
+                   static_cast<unsigned long long>(r.minUpdatesPerClient));
+        }
+        printf("allowed transfer rate: %.0f/s\n", allowed);
+        for (const LatencyResult& l : latencies) {
+            printf("interactive refresh, %-17s: %3llu refreshes, %3llu background batches, %3llu preempted, "
+                   "p50 %.0f ms, p99 %.0f ms\n",
+                   l.interactiveFirst ? "interactive first" : "queued", static_cast<unsigned long long>(l.refreshes),
+                   static_cast<unsigned long long>(l.backgroundBatches),
+                   static_cast<unsigned long long>(l.preemptions), l.p50Us / 1000.0, l.p99Us / 1000.0);
+        }
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatterySessions\",\n");
+        printf("  \"duration_s\": %.1f,\n  \"runs\": [\n", options.durationS);
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            printf("    {\"sessions\": %d, \"refresh_requests\": %llu, \"refreshes\": %llu, "
+                   "\"control_transfers\": %llu, \"transfers_per_s\": %.1f, \"min_updates_per_client\": %llu}%s\n",
+                   r.sessions, static_cast<unsigned long long>(r.refreshRequests),
+                   static_cast<unsigned long long>(r.refreshes),
+                   static_cast<unsigned long long>(r.controlTransfers), Rate(r),
+                   static_cast<unsigned long long>(r.minUpdatesPerClient),
+                   i + 1 < results.size() ? "," : "");
+        }
+        printf("  ],\n  \"allowed_transfers_per_s\": %.1f,\n", allowed);
+        printf("  \"interactive\": [\n");
+        for (size_t i = 0; i < latencies.size(); i++) {
+            const LatencyResult& l = latencies[i];
+            printf("    {\"interactive_first\": %s, \"refreshes\": %llu, \"background_batches\": %llu, "
+                   "\"preemptions\": %llu, \"p50_ms\": %.1f, \"p99_ms\": %.1f}%s\n",
+                   l.interactiveFirst ? "true" : "false", static_cast<unsigned long long>(l.refreshes),
+                   static_cast<unsigned long long>(l.backgroundBatches),
+                   static_cast<unsigned long long>(l.preemptions), l.p50Us / 1000.0, l.p99Us / 1000.0,
+                   i + 1 < latencies.size() ? "," : "");
+        }
+        printf("  ],\n");
+        printf("  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include "Bench.h"
+#include "SharedStatus.h"
+#include "SharedStatusWriter.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+// Shared-memory table with four devices, read the way an overlay would
+// every frame.
+
+static std::string BenchSegmentName() {
+#ifdef _WIN32
+    return RAZER_SHARED_STATUS_LOCAL_NAME "-bench"; // Global\ needs a privilege
+#else
+    return DefaultSharedStatusName() + "-bench";
+#endif
+}
+
+static std::vector<DeviceStatus> MakeStatuses(int level) {
+    std::vector<DeviceStatus> statuses;
+    for (int i = 0; i < 4; i++) {
+        DeviceStatus s;
+        char serial[16];
+        snprintf(serial, sizeof(serial), "PM%02d12345678", i);
+        s.serial = serial;
+        s.pid = 0x00B6 + i;
+        s.type = RazerDeviceType::Mouse;
+        s.name = "Razer Deathadder V2 Pro";
+        s.level = (level + i) % 101;
+        statuses.push_back(s);
+    }
+    return statuses;
+}
+
+RAZER_BENCH(shm_publish) {
+    SharedStatusWriter writer;
+    if (!writer.Create(BenchSegmentName())) return;
+    std::vector<DeviceStatus> statuses = MakeStatuses(50);
+    for (uint64_t i = 0; i < iterations; i++) {
+        writer.Publish(statuses, i);
+    }
+}
+
+RAZER_BENCH(shm_read_idle_writer) {
+    SharedStatusWriter writer;
+    if (!writer.Create(BenchSegmentName())) return;
+    writer.Publish(MakeStatuses(50), 1);
+
+    SharedStatusReader reader;
+    if (!reader.Open(BenchSegmentName())) return;
+    SharedStatusSnapshot snapshot;
+    for (uint64_t i = 0; i < iterations; i++) {
+        reader.Read(snapshot);
+        DoNotOptimize(snapshot);
+    }
+}
+
+// Writer republishing in a tight loop on another thread: the worst case
+// for retries. Reads that gave up are counted as iterations too.
+RAZER_BENCH(shm_read_busy_writer) {
+    SharedStatusWriter writer;
+    if (!writer.Create(BenchSegmentName())) return;
+    writer.Publish(MakeStatuses(50), 1);
+
+    std::atomic<bool> stop{false};
+    std::thread busy([&] {
+        std::vector<DeviceStatus> a = MakeStatuses(10), b = MakeStatuses(90);
+        for (uint64_t v = 2; !stop.load(std::memory_order_relaxed); v++) {
+            writer.Publish(v & 1 ? a : b, v);
+        }
+    });
+
+    SharedStatusReader reader;
+    if (reader.Open(BenchSegmentName())) {
+        SharedStatusSnapshot snapshot;
+        for (uint64_t i = 0; i < iterations; i++) {
+            reader.Read(snapshot);
+            DoNotOptimize(snapshot);
+        }
+    }
+    stop.store(true);
+    busy.join();
+}
+
+RAZER_BENCH(shm_sequence_check) {
+    SharedStatusWriter writer;
+    if (!writer.Create(BenchSegmentName())) return;
+    writer.Publish(MakeStatuses(50), 1);
+
+    SharedStatusReader reader;
+    if (!reader.Open(BenchSegmentName())) return;
+    for (uint64_t i = 0; i < iterations; i++) {
+        DoNotOptimize(reader.GetSequence());
+    }
+}
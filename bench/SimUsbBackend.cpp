@@ -0,0 +1,335 @@
+#include "SimUsbBackend.h"
+#include "DeviceKey.h"
+#include "RazerProtocol.h"
+#include <libusb.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+struct SimUsbBackend::Node {
+    std::mutex mutex;
+    SimDeviceSpec spec;
+    uint8_t bus = 1;
+    uint8_t address = 0;
+    bool connected = true;
+    uint32_t claimedMask = 0; // across all handles, like the kernel would
+    // Interrupt listeners by handle: (interface, callback). listenMutex is
+    // held while a report is delivered, so a listener that has stopped is
+    // never called again.
+    std::mutex listenMutex;
+    std::map<const void*, std::pair<int, UsbReportCallback>> listeners;
+};
+
+namespace {
+
+using Node = SimUsbBackend::Node;
+using Counters = SimUsbBackend::Counters;
+
+class SimDeviceHandle : public UsbDeviceHandle {
+public:
+    SimDeviceHandle(std::shared_ptr<Node> node, std::shared_ptr<Counters> counters)
+        : node(std::move(node)), counters(std::move(counters)) {
+        this->counters->openHandles.fetch_add(1);
+    }
+
+    ~SimDeviceHandle() override {
+        // Closing a handle implicitly releases whatever it still holds
+        StopListening();
+        for (int iface = 0; iface < 32; iface++) {
+            if (claimed & (1u << iface)) ReleaseInterface(iface);
+        }
+        counters->openHandles.fetch_sub(1);
+    }
+
+    int ClaimInterface(int iface) override {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        if (!node->connected) return LIBUSB_ERROR_NO_DEVICE;
+        if (iface < 0 || iface >= node->spec.interfaceCount) return LIBUSB_ERROR_NOT_FOUND;
+        uint32_t bit = 1u << iface;
+        if (claimed & bit) return 0;
+        if (node->claimedMask & bit) return LIBUSB_ERROR_BUSY;
+        node->claimedMask |= bit;
+        claimed |= bit;
+        counters->claimedInterfaces.fetch_add(1);
+        counters->claims.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    int ReleaseInterface(int iface) override {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        uint32_t bit = (iface >= 0 && iface < 32) ? (1u << iface) : 0;
+        if (!(claimed & bit)) return LIBUSB_ERROR_NOT_FOUND;
+        node->claimedMask &= ~bit;
+        claimed &= ~bit;
+        counters->claimedInterfaces.fetch_sub(1);
+        return 0;
+    }
+
+    int ControlTransfer(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+                        unsigned char* data, uint16_t length, unsigned int timeoutMs) override {
+        counters->controlTransfers.fetch_add(1, std::memory_order_relaxed);
+
+        SimDeviceSpec spec;
+        bool connected;
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            spec = node->spec;
+            connected = node->connected;
+        }
+        if (!connected) return LIBUSB_ERROR_NO_DEVICE;
+        if (spec.transferDelayMs) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::min(spec.transferDelayMs, timeoutMs)));
+        }
+        if (!spec.responsive || spec.transferDelayMs >= timeoutMs) return LIBUSB_ERROR_TIMEOUT;
+        if (index != spec.respondingInterface || length != RAZER_USB_REPORT_LEN) return LIBUSB_ERROR_PIPE;
+
+        bool feature = (value == 0x0300);
+        if (feature != spec.featureReports) return LIBUSB_ERROR_PIPE;
+
+        if (requestType == 0x21 && request == 0x09) {
+            memcpy(&pending, data, sizeof(pending));
+            hasPending = true;
+            return length;
+        }
+        if (requestType == 0xA1 && request == 0x01) {
+            if (!hasPending) return LIBUSB_ERROR_PIPE;
+            hasPending = false;
+            razer_report response = pending;
+            Answer(spec, response);
+            memcpy(data, &response, sizeof(response));
+            return length;
+        }
+        return LIBUSB_ERROR_PIPE;
+    }
+
+    int StartListening(int iface, UsbReportCallback onReport) override {
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            if (!node->connected) return LIBUSB_ERROR_NO_DEVICE;
+            if (iface < 0 || iface >= 32 || !(claimed & (1u << iface))) return LIBUSB_ERROR_NOT_FOUND;
+            if (!node->spec.interruptEndpoint) return LIBUSB_ERROR_NOT_FOUND;
+        }
+        std::lock_guard<std::mutex> lock(node->listenMutex);
+        if (node->listeners.count(this)) return LIBUSB_ERROR_BUSY;
+        node->listeners[this] = {iface, std::move(onReport)};
+        return 0;
+    }
+
+    void StopListening() override {
+        std::lock_guard<std::mutex> lock(node->listenMutex);
+        node->listeners.erase(this);
+    }
+
+    int GetStringDescriptorAscii(uint8_t index, unsigned char* data, int length, unsigned int) override {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        if (!node->connected) return LIBUSB_ERROR_NO_DEVICE;
+        const SimDeviceSpec& spec = node->spec;
+        if (index != 1 || spec.serial.empty() || !spec.serialInDescriptor) return LIBUSB_ERROR_PIPE;
+        int n = static_cast<int>(spec.serial.size()) < length ? static_cast<int>(spec.serial.size()) : length;
+        memcpy(data, spec.serial.data(), n);
+        return n;
+    }
+
+private:
+    std::shared_ptr<Node> node;
+    std::shared_ptr<Counters> counters;
+    uint32_t claimed = 0;
+    razer_report pending = {0};
+    bool hasPending = false;
+
+    static void Answer(const SimDeviceSpec& spec, razer_report& r) {
+        const uint8_t success = 0x02, notSupported = 0x05;
+        if (spec.acceptedTid && r.transaction_id.id != spec.acceptedTid) {
+            r.status = notSupported;
+            return;
+        }
+
+        // The receiver still answers for the serial; everything else would
+        // have to go over the air
+        if (spec.asleep && r.command_class != 0x00) {
+            r.status = 0x04;
+            return;
+        }
+
+        r.status = success;
+        switch ((r.command_class << 8) | r.command_id.id) {
+        case 0x0780: // battery, 0-255
+            if (spec.percentQuery) r.status = notSupported;
+            else r.arguments[1] = spec.batteryRaw;
+            break;
+        case 0x0F02: // battery, percent
+            if (!spec.percentQuery) r.status = notSupported;
+            else r.arguments[1] = static_cast<uint8_t>(razer_scale_battery(spec.batteryRaw));
+            break;
+        case 0x0784: // charging
+            r.arguments[1] = spec.charging ? 1 : 0;
+            break;
+        case 0x0781: // low battery threshold, 0-255
+            if (spec.lowThresholdRaw < 0) r.status = notSupported;
+            else r.arguments[0] = static_cast<uint8_t>(spec.lowThresholdRaw);
+            break;
+        case 0x0783: // idle time, seconds, big-endian
+            if (spec.idleSeconds < 0) {
+                r.status = notSupported;
+            } else {
+                r.arguments[0] = static_cast<uint8_t>(spec.idleSeconds >> 8);
+                r.arguments[1] = static_cast<uint8_t>(spec.idleSeconds);
+            }
+            break;
+        case 0x0082: // serial
+            if (spec.serial.empty()) {
+                r.status = notSupported;
+            } else {
+                memset(r.arguments, 0, 22);
+                memcpy(r.arguments, spec.serial.data(), spec.serial.size() < 22 ? spec.serial.size() : 22);
+            }
+            break;
+        default:
+            r.status = notSupported;
+            break;
+        }
+    }
+};
+
+class SimDevice : public UsbDevice {
+public:
+    SimDevice(std::shared_ptr<Node> node, std::shared_ptr<Counters> counters)
+        : node(std::move(node)), counters(std::move(counters)) {}
+
+    uint16_t GetVendorId() const override { return 0x1532; }
+    uint16_t GetProductId() const override { return node->spec.pid; }
+    uint8_t GetSerialNumberIndex() const override {
+        return (!node->spec.serial.empty() && node->spec.serialInDescriptor) ? 1 : 0;
+    }
+    uint8_t GetBusNumber() const override { return node->bus; }
+    uint8_t GetAddress() const override { return node->address; }
+    int GetInterfaceCount() override { return node->spec.interfaceCount; }
+
+    std::unique_ptr<UsbDeviceHandle> Open(int& error) override {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        if (!node->connected) {
+            error = LIBUSB_ERROR_NO_DEVICE;
+            return nullptr;
+        }
+        error = 0;
+        return std::make_unique<SimDeviceHandle>(node, counters);
+    }
+
+private:
+    std::shared_ptr<Node> node;
+    std::shared_ptr<Counters> counters;
+};
+
+} // namespace
+
+SimUsbBackend::SimUsbBackend(unsigned int responseDelayMs)
+    : responseDelayMs(responseDelayMs), counters(std::make_shared<Counters>()) {
+}
+
+SimUsbBackend::~SimUsbBackend() = default;
+
+int SimUsbBackend::Plug(const SimDeviceSpec& spec) {
+    auto node = std::make_shared<Node>();
+    node->spec = spec;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    node->address = nextAddress;
+    nextAddress = static_cast<uint8_t>(nextAddress == 127 ? 1 : nextAddress + 1);
+    int id = nextId++;
+    nodes[id] = node;
+    return id;
+}
+
+void SimUsbBackend::Unplug(int id) {
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = nodes.find(id);
+        if (it == nodes.end()) return;
+        node = it->second;
+        nodes.erase(it);
+    }
+    {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        node->connected = false;
+    }
+    std::lock_guard<std::mutex> lock(node->listenMutex);
+    for (auto& listener : node->listeners) listener.second.second(nullptr, LIBUSB_ERROR_NO_DEVICE);
+    node->listeners.clear();
+}
+
+void SimUsbBackend::SetBattery(int id, uint8_t raw, bool charging) {
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = nodes.find(id);
+        if (it == nodes.end()) return;
+        node = it->second;
+    }
+    std::lock_guard<std::mutex> lock(node->mutex);
+    node->spec.batteryRaw = raw;
+    node->spec.charging = charging;
+}
+
+void SimUsbBackend::SetAsleep(int id, bool asleep) {
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = nodes.find(id);
+        if (it == nodes.end()) return;
+        node = it->second;
+    }
+    std::lock_guard<std::mutex> lock(node->mutex);
+    node->spec.asleep = asleep;
+}
+
+bool SimUsbBackend::Notify(int id, const unsigned char* data, int length) {
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = nodes.find(id);
+        if (it == nodes.end()) return false;
+        node = it->second;
+    }
+    int iface;
+    {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        iface = node->spec.respondingInterface;
+    }
+    std::lock_guard<std::mutex> lock(node->listenMutex);
+    bool delivered = false;
+    for (auto& listener : node->listeners) {
+        if (listener.second.first != iface) continue;
+        listener.second.second(data, length);
+        delivered = true;
+    }
+    return delivered;
+}
+
+std::vector<int> SimUsbBackend::PluggedIds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<int> ids;
+    for (const auto& pair : nodes) ids.push_back(pair.first);
+    return ids;
+}
+
+std::map<std::wstring, std::shared_ptr<UsbDevice>> SimUsbBackend::ExpectedDevices() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::wstring, std::shared_ptr<UsbDevice>> expected;
+    for (const auto& pair : nodes) {
+        const SimDeviceSpec& spec = pair.second->spec;
+        std::wstring key = MakeDeviceKey(std::wstring(spec.serial.begin(), spec.serial.end()), spec.pid);
+        expected[key] = std::make_shared<SimDevice>(pair.second, counters);
+    }
+    return expected;
+}
+
+std::vector<std::shared_ptr<UsbDevice>> SimUsbBackend::ListDevices() {
+    counters->listings.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::shared_ptr<UsbDevice>> list;
+    for (const auto& pair : nodes) {
+        list.push_back(std::make_shared<SimDevice>(pair.second, counters));
+    }
+    return list;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "UsbBackend.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// In-process stand-in for a USB bus full of Razer devices. It answers the
+// same feature/output report exchanges RazerDevice issues, and counts open
+// handles and claimed interfaces so harnesses can check for leaks.
+struct SimDeviceSpec {
+    uint16_t pid = 0;
+    std::string serial;              // empty: the device has no serial at all
+    bool serialInDescriptor = true;  // otherwise only via the 0x00/0x82 report
+    int interfaceCount = 3;
+    int respondingInterface = 0;
+    bool featureReports = true;      // answers strategy 1; otherwise only output/input reports
+    bool percentQuery = false;       // answers 0x0F/0x02 (percent) instead of 0x07/0x80 (0-255)
+    uint8_t acceptedTid = 0;         // 0: any transaction ID, else only this one
+    uint8_t batteryRaw = 200;
+    bool charging = false;
+    int lowThresholdRaw = 0x26;      // 0x07/0x81 answer (15%); -1: not supported
+    int idleSeconds = 300;           // 0x07/0x83 answer; -1: not supported
+    bool asleep = false;             // receiver answers 0x04 (no response) for the device
+    bool responsive = true;          // false: every transfer times out
+    unsigned int transferDelayMs = 0;
+    bool interruptEndpoint = true;   // has an interrupt IN endpoint to listen on
+};
+
+class SimUsbBackend : public UsbBackend {
+public:
+    explicit SimUsbBackend(unsigned int responseDelayMs = 0);
+    ~SimUsbBackend() override;
+
+    // Returns an id for Unplug/SetBattery. Each plug gets a fresh bus address.
+    int Plug(const SimDeviceSpec& spec);
+    void Unplug(int id);
+    void SetBattery(int id, uint8_t raw, bool charging);
+    void SetAsleep(int id, bool asleep);
+    // Delivers one report from the device's interrupt endpoint (on its
+    // respondingInterface) to whoever listens there, on the calling thread.
+    // Returns false if nobody does.
+    bool Notify(int id, const unsigned char* data, int length);
+    std::vector<int> PluggedIds() const;
+
+    // Key (as MakeDeviceKey would produce) -> device object, for plugged devices.
+    std::map<std::wstring, std::shared_ptr<UsbDevice>> ExpectedDevices() const;
+
+    bool IsAvailable() const override { return true; }
+    std::vector<std::shared_ptr<UsbDevice>> ListDevices() override;
+    unsigned int GetResponseDelayMs() const override { return responseDelayMs; }
+
+    struct Counters {
+        std::atomic<int64_t> openHandles{0};
+        std::atomic<int64_t> claimedInterfaces{0};
+        std::atomic<uint64_t> controlTransfers{0};
+        std::atomic<uint64_t> listings{0};      // ListDevices calls (enumerations)
+        std::atomic<uint64_t> claims{0};        // interfaces claimed, counting re-claims
+    };
+    const Counters& GetCounters() const { return *counters; }
+
+    struct Node;
+
+private:
+    unsigned int responseDelayMs;
+    std::shared_ptr<Counters> counters;
+    mutable std::mutex mutex;
+    std::map<int, std::shared_ptr<Node>> nodes;
+    int nextId = 1;
+    uint8_t nextAddress = 1;
+};
@@ -0,0 +1,167 @@
+// RazerBatterySnapshotStress [--duration-s N] [--readers N] [--text]
+//
+// Hammers DeviceStatusStore's snapshot publication: one thread publishes a
+// new table as fast as it can while --readers threads load the current
+// snapshot in a loop, and a listener loads it on every change. Every table
+// the writer builds is derived from its version, so a reader can tell a
+// torn or reused snapshot from a good one: the device count and every level
+// must match the version, versions must never go backwards, and a snapshot
+// re-checked after the writer has moved on must be unchanged. The run fails
+// on any mismatch. Meant to be run from a -DRAZER_SANITIZE_THREAD=ON build
+// as well, where ThreadSanitizer reports any race on the way. Emits JSON on
+// stdout by default.
+#include "DeviceStatusStore.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    double durationS = 2;
+    int readers = 4;
+    bool text = false;
+};
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) {
+            options.durationS = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--readers") == 0 && i + 1 < argc) {
+            options.readers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatterySnapshotStress [--duration-s N] [--readers N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.durationS <= 0) options.durationS = 2;
+    if (options.readers < 1 || options.readers > 64) options.readers = 4;
+    return true;
+}
+
+// Table number n, published as version n (every table differs from the
+// one before it, so each one bumps the version)
+std::vector<DeviceStatus> Table(uint64_t n) {
+    std::vector<DeviceStatus> devices(1 + n % 4);
+    for (size_t i = 0; i < devices.size(); i++) {
+        devices[i].serial = "STRESS" + std::to_string(i);
+        devices[i].level = static_cast<int>(n % 101);
+        devices[i].latencyMs = static_cast<uint32_t>(n);
+    }
+    return devices;
+}
+
+bool Consistent(const DeviceSnapshot& snapshot) {
+    if (snapshot.version == 0) return snapshot.devices.empty();
+    if (snapshot.devices.size() != 1 + snapshot.version % 4) return false;
+    for (const auto& device : snapshot.devices) {
+        if (device.level != static_cast<int>(snapshot.version % 101)) return false;
+        if (device.latencyMs != static_cast<uint32_t>(snapshot.version)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    DeviceStatusStore store;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> loads{0};
+    std::atomic<uint64_t> notified{0};
+
+    // Runs on the writer's thread, after the snapshot it announces is out
+    int listener = store.Subscribe([&](uint64_t version) {
+        DeviceSnapshotPtr snapshot = store.GetSnapshot();
+        if (snapshot->version < version || !Consistent(*snapshot)) failures.fetch_add(1);
+        notified.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    LatencyHistogram loadLatency;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < options.readers; r++) {
+        readers.emplace_back([&, r] {
+            uint64_t lastVersion = 0;
+            uint64_t count = 0;
+            DeviceSnapshotPtr held;
+            while (!done.load(std::memory_order_relaxed)) {
+                auto start = Clock::now();
+                DeviceSnapshotPtr snapshot = store.GetSnapshot();
+                if ((count & 1023) == 0) {
+                    loadLatency.Record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()));
+                }
+                if (snapshot->version < lastVersion || !Consistent(*snapshot)) failures.fetch_add(1);
+                lastVersion = snapshot->version;
+                // Keep one snapshot across many publications: it must not change
+                if (held && !Consistent(*held)) failures.fetch_add(1);
+                if ((count + static_cast<uint64_t>(r)) % 4096 == 0) held = snapshot;
+                count++;
+            }
+            loads.fetch_add(count);
+        });
+    }
+
+    LatencyHistogram publishLatency;
+    uint64_t published = 0;
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration<double>(options.durationS);
+    while (Clock::now() < end) {
+        std::vector<DeviceStatus> table = Table(published + 1);
+        auto before = Clock::now();
+        if (!store.Publish(std::move(table))) failures.fetch_add(1);
+        publishLatency.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - before).count()));
+        published++;
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    done.store(true);
+    for (auto& t : readers) t.join();
+    store.Unsubscribe(listener);
+
+    if (store.GetVersion() != published || notified.load() != published) failures.fetch_add(1);
+
+    LatencyHistogram::Snapshot publishes = publishLatency.Read();
+    LatencyHistogram::Snapshot reads = loadLatency.Read();
+    const bool pass = failures.load() == 0 && published > 0 && loads.load() > 0;
+    if (options.text) {
+        printf("%d readers, %.1f s: %llu publications (%.0f/s), %llu loads (%.0f/s)\n", options.readers, seconds,
+               static_cast<unsigned long long>(published), published / seconds,
+               static_cast<unsigned long long>(loads.load()), loads.load() / seconds);
+        printf("publish p50 <= %llu us, p99 <= %llu us; load p50 <= %llu us, p99 <= %llu us\n",
+               static_cast<unsigned long long>(publishes.Percentile(0.5)),
+               static_cast<unsigned long long>(publishes.Percentile(0.99)),
+               static_cast<unsigned long long>(reads.Percentile(0.5)),
+               static_cast<unsigned long long>(reads.Percentile(0.99)));
+        printf("inconsistent snapshots: %llu\n", static_cast<unsigned long long>(failures.load()));
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatterySnapshotStress\",\n");
+        printf("  \"readers\": %d,\n  \"duration_s\": %.1f,\n", options.readers, seconds);
+        printf("  \"publications\": %llu,\n  \"loads\": %llu,\n", static_cast<unsigned long long>(published),
+               static_cast<unsigned long long>(loads.load()));
+        printf("  \"publish_us\": {\"p50\": %llu, \"p99\": %llu},\n",
+               static_cast<unsigned long long>(publishes.Percentile(0.5)),
+               static_cast<unsigned long long>(publishes.Percentile(0.99)));
+        printf("  \"load_us\": {\"p50\": %llu, \"p99\": %llu},\n",
+               static_cast<unsigned long long>(reads.Percentile(0.5)),
+               static_cast<unsigned long long>(reads.Percentile(0.99)));
+        printf("  \"inconsistent\": %llu,\n", static_cast<unsigned long long>(failures.load()));
+        printf("  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,308 @@
+// RazerBatterySoak [--duration-s N] [--seed N] [--max-devices N] [--text]
+//
+// Plug-storm soak: drives RazerManager against the simulated USB backend,
+// flipping several devices at once the way a KVM switch does, and checks
+// after every storm that re-enumeration converges on exactly the plugged
+// set. Open handles, claimed interfaces and live heap bytes are sampled
+// throughout; the run fails if any of them keeps growing window after
+// window. Emits JSON on stdout by default.
+#include "SimUsbBackend.h"
+#include "RazerManager.h"
+#include "DeviceIds.h"
+#include "DeviceKey.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// --- Live heap accounting -------------------------------------------------
+// Every allocation carries a small header with its size so frees can be
+// subtracted. Aligned overloads keep their library defaults and are not
+// counted; nothing in the core uses over-aligned types.
+
+static std::atomic<int64_t> g_liveHeapBytes{0};
+
+namespace {
+constexpr size_t HeapHeader = alignof(std::max_align_t);
+
+void* CountedAlloc(size_t size) {
+    void* raw = malloc(size + HeapHeader);
+    if (!raw) throw std::bad_alloc();
+    *static_cast<size_t*>(raw) = size;
+    g_liveHeapBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    return static_cast<char*>(raw) + HeapHeader;
+}
+
+void CountedFree(void* p) {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - HeapHeader;
+    g_liveHeapBytes.fetch_sub(static_cast<int64_t>(*static_cast<size_t*>(raw)), std::memory_order_relaxed);
+    free(raw);
+}
+} // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* p) noexcept { CountedFree(p); }
+void operator delete[](void* p) noexcept { CountedFree(p); }
+void operator delete(void* p, size_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, size_t) noexcept { CountedFree(p); }
+
+// --- Soak -----------------------------------------------------------------
+
+namespace {
+
+struct Options {
+    double durationS = 60;
+    uint32_t seed = 1;
+    int maxDevices = 8;
+    bool text = false;
+};
+
+// A physical device that the KVM can connect or disconnect.
+struct Slot {
+    SimDeviceSpec spec;
+    int id = 0; // 0 while unplugged
+};
+
+// Device mix covering the RazerDevice fallbacks: serial from descriptor or
+// report, non-default transaction IDs, percent-only firmware and a dongle
+// whose battery interface is not the first one.
+std::vector<Slot> MakeSlots(int count, std::mt19937& rng) {
+    const size_t idCount = sizeof(RazerDeviceIds) / sizeof(RazerDeviceIds[0]);
+    std::vector<Slot> slots(count);
+    for (int i = 0; i < count; i++) {
+        SimDeviceSpec& s = slots[i].spec;
+        s.pid = static_cast<uint16_t>(RazerDeviceIds[rng() % idCount]);
+        char serial[24];
+        snprintf(serial, sizeof(serial), "PM%02d%06u", i, static_cast<unsigned>(rng() % 1000000));
+        s.serial = serial;
+        s.serialInDescriptor = (i % 3) != 1;
+        s.respondingInterface = (i % 4 == 2) ? 2 : 0;
+        s.featureReports = (i % 5) != 3;
+        s.percentQuery = (i % 6) == 5;
+        s.acceptedTid = (i % 4 == 1) ? 0x1F : 0;
+        s.batteryRaw = static_cast<uint8_t>(rng() % 256);
+    }
+    return slots;
+}
+
+struct ResourceSample {
+    int64_t openHandles;
+    int64_t claimedInterfaces;
+    int64_t heapBytes;
+};
+
+// Per-window minimum of each resource. Minima filter out the transient
+// peaks of a storm in progress; a leak lifts the floor itself.
+struct Window {
+    ResourceSample min{INT64_MAX, INT64_MAX, INT64_MAX};
+
+    void Add(const ResourceSample& s) {
+        min.openHandles = std::min(min.openHandles, s.openHandles);
+        min.claimedInterfaces = std::min(min.claimedInterfaces, s.claimedInterfaces);
+        min.heapBytes = std::min(min.heapBytes, s.heapBytes);
+    }
+};
+
+constexpr size_t MinWindowsForVerdict = 5;
+
+// True when every window after the first (warm-up) raised the floor.
+template <typename Get>
+bool GrowsMonotonically(const std::vector<Window>& windows, Get get) {
+    if (windows.size() < MinWindowsForVerdict + 1) return false;
+    for (size_t i = 2; i < windows.size(); i++) {
+        if (get(windows[i].min) <= get(windows[i - 1].min)) return false;
+    }
+    return true;
+}
+
+bool IsConsistent(const RazerManager& manager, const SimUsbBackend& backend) {
+    std::map<std::wstring, std::shared_ptr<UsbDevice>> expected = backend.ExpectedDevices();
+    const auto& devices = manager.GetDevices();
+    if (devices.size() != expected.size()) return false;
+    for (const auto& d : devices) {
+        auto it = expected.find(MakeDeviceKey(d->GetSerial(), d->GetPID()));
+        // A stale instance from before a replug has the old bus address
+        if (it == expected.end() || !d->IsSameDevice(*it->second)) return false;
+    }
+    return true;
+}
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) {
+            options.durationS = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--max-devices") == 0 && i + 1 < argc) {
+            options.maxDevices = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--text") == 0) {
+            options.text = true;
+        } else {
+            fprintf(stderr, "usage: RazerBatterySoak [--duration-s N] [--seed N] [--max-devices N] [--text]\n");
+            return false;
+        }
+    }
+    if (options.maxDevices < 1 || options.maxDevices > 32) options.maxDevices = 8;
+    return true;
+}
+
+template <typename Get>
+void PrintSeries(const char* name, const std::vector<Window>& windows, Get get, bool last) {
+    printf("    \"%s\": [", name);
+    for (size_t i = 0; i < windows.size(); i++) {
+        printf("%s%lld", i ? ", " : "", static_cast<long long>(get(windows[i].min)));
+    }
+    printf("]%s\n", last ? "" : ",");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+
+    Options options;
+    if (!ParseArgs(argc, argv, options)) return 2;
+
+    // The soak must not measure (or litter) the text log
+    Logger::SetLevel(LogLevel::Off);
+
+    std::mt19937 rng(options.seed);
+    auto backend = std::make_shared<SimUsbBackend>();
+    std::vector<Slot> slots = MakeSlots(options.maxDevices, rng);
+
+    const auto windowLength = std::chrono::duration<double>(std::max(1.0, options.durationS / 10));
+    const int MaxPassesPerStorm = 5;
+
+    LatencyHistogram timeToConsistent;
+    std::vector<Window> windows(1);
+    uint64_t storms = 0, enumerations = 0, flips = 0, unconverged = 0;
+    int64_t maxHandles = 0, maxClaimed = 0, maxHeap = 0;
+
+    auto sample = [&](Window& window) {
+        const SimUsbBackend::Counters& c = backend->GetCounters();
+        ResourceSample s{c.openHandles.load(), c.claimedInterfaces.load(), g_liveHeapBytes.load()};
+        window.Add(s);
+        maxHandles = std::max(maxHandles, s.openHandles);
+        maxClaimed = std::max(maxClaimed, s.claimedInterfaces);
+        maxHeap = std::max(maxHeap, s.heapBytes);
+    };
+
+    {
+        // Probed in parallel, as the poller does
+        WorkPool pool;
+        RazerManager manager(backend, &pool);
+
+        const auto start = Clock::now();
+        auto windowStart = start;
+        while (Clock::now() - start < std::chrono::duration<double>(options.durationS)) {
+            // Storm: a KVM switch drops and re-adds a burst of devices. Usually
+            // several at once; sometimes the same device bounces twice.
+            int burst = 1 + static_cast<int>(rng() % slots.size());
+            for (int i = 0; i < burst; i++) {
+                Slot& slot = slots[rng() % slots.size()];
+                if (slot.id) {
+                    backend->Unplug(slot.id);
+                    slot.id = 0;
+                } else {
+                    slot.spec.batteryRaw = static_cast<uint8_t>(rng() % 256);
+                    slot.spec.charging = (rng() % 2) != 0;
+                    slot.id = backend->Plug(slot.spec);
+                }
+                flips++;
+            }
+            storms++;
+
+            auto stormStart = Clock::now();
+            bool converged = false;
+            for (int pass = 0; pass < MaxPassesPerStorm && !converged; pass++) {
+                manager.EnumerateDevices();
+                enumerations++;
+                sample(windows.back());
+                converged = IsConsistent(manager, *backend);
+            }
+            if (converged) {
+                timeToConsistent.Record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - stormStart).count()));
+            } else {
+                unconverged++;
+            }
+
+            // Steady-state polling between storms, as the tray timer would
+            for (const auto& d : manager.GetDevices()) {
+                d->GetBatteryLevel();
+                d->IsCharging();
+            }
+            sample(windows.back());
+
+            if (Clock::now() - windowStart >= windowLength) {
+                windowStart = Clock::now();
+                windows.emplace_back();
+            }
+        }
+        if (windows.size() > 1 && windows.back().min.openHandles == INT64_MAX) windows.pop_back();
+    }
+
+    // Everything must be released once the manager is gone
+    const SimUsbBackend::Counters& c = backend->GetCounters();
+    int64_t handlesAfter = c.openHandles.load();
+    int64_t claimedAfter = c.claimedInterfaces.load();
+
+    bool handleGrowth = GrowsMonotonically(windows, [](const ResourceSample& s) { return s.openHandles; });
+    bool claimGrowth = GrowsMonotonically(windows, [](const ResourceSample& s) { return s.claimedInterfaces; });
+    bool heapGrowth = GrowsMonotonically(windows, [](const ResourceSample& s) { return s.heapBytes; });
+    bool pass = !handleGrowth && !claimGrowth && !heapGrowth && unconverged == 0 &&
+                handlesAfter == 0 && claimedAfter == 0;
+
+    LatencyHistogram::Snapshot ttc = timeToConsistent.Read();
+    if (options.text) {
+        printf("storms %llu, flips %llu, enumerations %llu, unconverged %llu\n",
+               static_cast<unsigned long long>(storms), static_cast<unsigned long long>(flips),
+               static_cast<unsigned long long>(enumerations), static_cast<unsigned long long>(unconverged));
+        printf("time to consistent: p50 <= %llu us, p99 <= %llu us\n",
+               static_cast<unsigned long long>(ttc.Percentile(0.5)),
+               static_cast<unsigned long long>(ttc.Percentile(0.99)));
+        printf("peak: %lld handles, %lld claimed interfaces, %lld heap bytes\n",
+               static_cast<long long>(maxHandles), static_cast<long long>(maxClaimed), static_cast<long long>(maxHeap));
+        printf("after shutdown: %lld handles, %lld claimed interfaces\n",
+               static_cast<long long>(handlesAfter), static_cast<long long>(claimedAfter));
+        printf("growth: handles %s, claimed %s, heap %s\n", handleGrowth ? "YES" : "no",
+               claimGrowth ? "YES" : "no", heapGrowth ? "YES" : "no");
+        printf("%s\n", pass ? "PASS" : "FAIL");
+    } else {
+        printf("{\n  \"suite\": \"RazerBatterySoak\",\n");
+        printf("  \"seed\": %u,\n  \"duration_s\": %.1f,\n  \"max_devices\": %d,\n",
+               options.seed, options.durationS, options.maxDevices);
+        printf("  \"storms\": %llu,\n  \"flips\": %llu,\n  \"enumerations\": %llu,\n  \"unconverged_storms\": %llu,\n",
+               static_cast<unsigned long long>(storms), static_cast<unsigned long long>(flips),
+               static_cast<unsigned long long>(enumerations), static_cast<unsigned long long>(unconverged));
+        printf("  \"time_to_consistent_us\": {\"p50\": %llu, \"p99\": %llu},\n",
+               static_cast<unsigned long long>(ttc.Percentile(0.5)),
+               static_cast<unsigned long long>(ttc.Percentile(0.99)));
+        printf("  \"peak\": {\"open_handles\": %lld, \"claimed_interfaces\": %lld, \"heap_bytes\": %lld},\n",
+               static_cast<long long>(maxHandles), static_cast<long long>(maxClaimed), static_cast<long long>(maxHeap));
+        printf("  \"after_shutdown\": {\"open_handles\": %lld, \"claimed_interfaces\": %lld},\n",
+               static_cast<long long>(handlesAfter), static_cast<long long>(claimedAfter));
+        printf("  \"window_minima\": {\n");
+        PrintSeries("open_handles", windows, [](const ResourceSample& s) { return s.openHandles; }, false);
+        PrintSeries("claimed_interfaces", windows, [](const ResourceSample& s) { return s.claimedInterfaces; }, false);
+        PrintSeries("heap_bytes", windows, [](const ResourceSample& s) { return s.heapBytes; }, true);
+        printf("  },\n");
+        printf("  \"monotonic_growth\": {\"open_handles\": %s, \"claimed_interfaces\": %s, \"heap_bytes\": %s},\n",
+               handleGrowth ? "true" : "false", claimGrowth ? "true" : "false", heapGrowth ? "true" : "false");
+        printf("  \"result\": \"%s\"\n}\n", pass ? "pass" : "fail");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#include "Bench.h"
+#include "Trace.h"
+
+RAZER_BENCH(trace_scope_disabled) {
+    Trace::SetEnabled(false);
+    for (uint64_t i = 0; i < iterations; i++) {
+        TraceScope span("SendRequest attempt");
+        span.Arg("interface", static_cast<int64_t>(i & 3));
+        DoNotOptimize(span);
+    }
+}
+
+RAZER_BENCH(trace_scope_enabled) {
+    Trace::SetEnabled(true);
+    for (uint64_t i = 0; i < iterations; i++) {
+        TraceScope span("SendRequest attempt");
+        span.Arg("interface", static_cast<int64_t>(i & 3));
+        DoNotOptimize(span);
+    }
+    Trace::SetEnabled(false);
+    Trace::Clear();
+}
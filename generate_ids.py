@@ -22,10 +22,23 @@ files = {
 
 all_defs = []
 
+def display_name(define):
+    words = define[len('USB_DEVICE_ID_'):].split('_')
+    # Plain words are title-cased; model codes like V2, TE or 5G stay as they are
+    return ' '.join(w.capitalize() if w.isalpha() and len(w) > 2 else w for w in words)
+
+# IDs that are not (yet) in the OpenRazer headers, added by sniffing
+extra_defs = {
+    'Headset': [
+        ('USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023', '0x0555', 'Headset'),
+    ],
+}
+
 for fpath, dtype in files.items():
     if os.path.exists(fpath):
         defs = parse_header(fpath, dtype)
         all_defs.extend(defs)
+    all_defs.extend(extra_defs.get(dtype, []))
 
 with open('include/DeviceIds.h', 'w') as f:
     f.write('#pragma once\n\n')
@@ -48,4 +61,19 @@ with open('include/DeviceIds.h', 'w') as f:
     f.write('    }\n')
     f.write('}\n')
 
+    f.write('\n// Marketing-ish name derived from the OpenRazer define, e.g. "Razer Blackshark V2 Pro 2023"\n')
+    f.write('inline const char* GetRazerDeviceName(int pid) {\n')
+    f.write('    switch(pid) {\n')
+    for name, pid, dtype in all_defs:
+        f.write(f'    case {name}: return "{display_name(name)}";\n')
+    f.write('    default: return nullptr;\n')
+    f.write('    }\n')
+    f.write('}\n')
+
+    f.write('\n// Every known PID, in header order\n')
+    f.write('inline constexpr int RazerDeviceIds[] = {\n')
+    for name, pid, dtype in all_defs:
+        f.write(f'    {name},\n')
+    f.write('};\n')
+
 print(f"Generated {len(all_defs)} device IDs.")
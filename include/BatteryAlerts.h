@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "DeviceStatus.h"
+
+struct BatteryAlert {
+    DeviceStatus device;        // the reading that crossed
+    int threshold = 0;          // effective threshold, percent
+};
+
+// Decides when a device has gone low. Each device is armed until its level
+// falls to its threshold while discharging, which raises one alert; it is
+// re-armed only once it charges or climbs hysteresisPoints above the
+// threshold, so a level wobbling across the line does not repeat the
+// alert. Alerts for one device are additionally at least minIntervalSeconds
+// apart. The threshold is the device's own (DeviceStatus::lowBatteryThreshold)
+// when it reports one, else defaultThreshold.
+//
+// Polling thread only.
+class BatteryAlertEngine {
+public:
+    struct Options {
+        int defaultThreshold = 20;          // the icon turns red below this too
+        int hysteresisPoints = 5;
+        int64_t minIntervalSeconds = 30 * 60;
+        int watchMarginPoints = 5;          // IsNearThreshold range above the threshold
+    };
+
+    BatteryAlertEngine() = default;
+    explicit BatteryAlertEngine(const Options& options) : options(options) {}
+
+    // Feeds one refresh (all devices or a subset); `time` is wall-clock
+    // seconds. Returns the alerts to raise now.
+    std::vector<BatteryAlert> Update(const std::vector<DeviceStatus>& statuses, int64_t time);
+
+    // True while the device discharges within watchMarginPoints above its
+    // threshold: worth polling more often so the crossing is seen promptly.
+    bool IsNearThreshold(const DeviceStatus& status) const;
+
+    int ThresholdFor(const DeviceStatus& status) const;
+
+private:
+    struct State {
+        bool armed = true;
+        int64_t lastAlert = INT64_MIN;
+    };
+
+    Options options;
+    std::map<std::string, State> states;
+};
+
+// {"type":"alert","kind":"low_battery","threshold":N,"device":{...}}
+std::string AlertMessage(const BatteryAlert& alert);
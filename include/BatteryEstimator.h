@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "DeviceStatus.h"
+
+// Time-to-empty / time-to-full for one device from its recent readings.
+//
+// Keeps an exponentially weighted least-squares fit of level against time
+// over the current discharge (or charge) run: five running sums, decayed
+// and re-centred on every sample, so each Add is O(1) and nothing is
+// stored per sample. A change of charging state starts a new run.
+//
+// Readings are not evenly spaced and not all of them describe the same
+// process, so two kinds of input are kept out of the fit:
+//   - gaps longer than maxGap (host asleep, device asleep or out of range,
+//     poller stopped, wall clock stepped back). The run is spliced: the
+//     gap contributes no time and the level change across it is dropped,
+//     so the slope reflects the device while it was being watched.
+//   - single readings more than outlierPoints off the fitted line. One is
+//     discarded; a second in a row that agrees with the first is taken as
+//     a real step (firmware recalibration) and spliced like a gap.
+class BatteryEstimator {
+public:
+    struct Options {
+        int64_t halfLifeSeconds = 3 * 3600;  // weight of a reading halves this long after it
+        int64_t maxGapSeconds = 20 * 60;     // longer gaps are spliced out
+        int64_t minSpanSeconds = 30 * 60;    // watched time before estimating
+        int minSamples = 3;
+        int outlierPoints = 8;
+        int64_t maxEstimateSeconds = 14 * 24 * 3600; // flatter slopes report unknown
+    };
+
+    BatteryEstimator() = default;
+    explicit BatteryEstimator(const Options& options) : options(options) {}
+
+    // `time` is wall-clock seconds; unknown levels (-1) are ignored.
+    void Add(int64_t time, int level, bool charging);
+    void Reset();
+
+    // -1 when there is not enough data, the level is not moving in the
+    // expected direction, or the estimate exceeds maxEstimateSeconds.
+    int64_t SecondsToEmpty() const;
+    int64_t SecondsToFull() const;
+    // Fitted slope in percent per hour (negative while discharging); 0
+    // until there is enough data.
+    double RatePerHour() const;
+
+private:
+    bool Ready() const;
+    double Slope() const;       // percent per second
+    void Accept(int level);
+    void Splice(int level);
+
+    Options options;
+    // Weighted sums over x = seconds before the last reading (x <= 0) and
+    // y = level + offset, where offset absorbs spliced steps
+    double sw = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    double offset = 0;
+    int64_t lastTime = 0;
+    int lastLevel = -1;
+    bool charging = false;
+    int samples = 0;
+    int64_t span = 0;           // watched seconds in this run
+    int suspectLevel = -1;      // rejected reading awaiting confirmation
+};
+
+// One BatteryEstimator per device key. Fills DeviceStatus::secondsToEmpty
+// and secondsToFull (rounded to whole minutes) for every status with a
+// known level; polling thread only.
+class BatteryEstimatorSet {
+public:
+    BatteryEstimatorSet() = default;
+    explicit BatteryEstimatorSet(const BatteryEstimator::Options& options) : options(options) {}
+
+    void Apply(std::vector<DeviceStatus>& statuses, int64_t time);
+    const BatteryEstimator* Get(const std::string& deviceKey) const;
+
+private:
+    BatteryEstimator::Options options;
+    std::map<std::string, BatteryEstimator> estimators;
+};
+
+// "~3 h 10 min left", "~45 min to full", "full", or "" when there is no
+// estimate. Used by the tray tooltip and the command-line tools.
+std::string FormatEstimate(const DeviceStatus& status);
@@ -0,0 +1,177 @@
+#pragma once
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DeviceStatus.h"
+#include "MappedFile.h"
+
+// Per-device battery history: an append-only, memory-mapped file of
+// fixed-size blocks. Each block starts from a base (time, level, charging
+// state) stored in its header and holds a varint stream of records:
+//
+//   tag = payload << 2 | kind
+//   kind 0 sample   payload zigzag(dt - previous dt), then zigzag(level delta)
+//   kind 1 repeat   payload n: n more samples, each dt after the last, same level
+//   kind 2 charge   payload zigzag(dt) << 1 | charging
+//
+// Times are wall-clock seconds. A steady 1-minute series therefore costs
+// one byte per 31 unchanged samples plus two bytes per level change; a
+// year of 1-minute readings with daily charge cycles and sleep gaps takes
+// about 185 KB (RazerBatteryHistoryYear). When every block is in use the oldest one is recycled, so
+// the file never grows. Appends touch only the tail of the current block.
+//
+// Not thread-safe: append and query from the same thread, or open the file
+// a second time with OpenReadOnly.
+
+#define RAZER_HISTORY_MAGIC "RZBHIST1"
+#define RAZER_HISTORY_VERSION 1
+
+#pragma pack(push, 1)
+
+struct HistoryFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t blockCount;        // capacity
+    uint32_t firstBlock;        // physical index of the oldest block
+    uint32_t usedBlocks;
+    char deviceKey[24];         // serial or PID_xxxx, NUL-padded
+    uint8_t reserved[12];
+};
+
+struct HistoryBlockHeader {
+    int64_t baseTime;           // seconds since epoch
+    uint16_t usedBytes;         // payload bytes after this header
+    int8_t baseLevel;
+    uint8_t baseCharging;
+    uint8_t reserved[4];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(HistoryFileHeader) == 64, "HistoryFileHeader layout changed");
+static_assert(sizeof(HistoryBlockHeader) == 16, "HistoryBlockHeader layout changed");
+
+struct HistoryRecord {
+    enum class Kind : uint8_t { Sample, ChargeStarted, ChargeStopped };
+
+    Kind kind = Kind::Sample;
+    int64_t time = 0;           // seconds since epoch
+    int level = -1;             // the sample's level; for events, the last level seen
+    bool charging = false;      // state after this record
+};
+
+class BatteryHistory {
+public:
+    static constexpr size_t BlockSize = 4096;
+    static constexpr uint32_t DefaultBlocks = 64; // 256 KB, over a year
+
+    BatteryHistory() = default;
+    BatteryHistory(const BatteryHistory&) = delete;
+    BatteryHistory& operator=(const BatteryHistory&) = delete;
+
+    // Opens `path` for appending, creating it with `blocks` blocks if it
+    // does not exist or is not a history file.
+    bool Open(const std::string& path, const std::string& deviceKey, uint32_t blocks = DefaultBlocks);
+    bool OpenReadOnly(const std::string& path);
+    void Close();
+    bool IsOpen() const { return file.IsOpen(); }
+
+    // Records a reading. Unknown levels (-1) are skipped; a change of
+    // charging state is recorded as an event before the sample.
+    void Append(int64_t time, int level, bool charging);
+
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = HistoryRecord;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const HistoryRecord*;
+        using reference = const HistoryRecord&;
+
+        Iterator() = default;
+        reference operator*() const { return record; }
+        pointer operator->() const { return &record; }
+        Iterator& operator++();
+        // Only comparison with end() is meaningful
+        bool operator==(const Iterator& other) const { return history == other.history; }
+        bool operator!=(const Iterator& other) const { return history != other.history; }
+
+    private:
+        friend class BatteryHistory;
+        bool Step();
+
+        const BatteryHistory* history = nullptr; // nullptr at end
+        uint32_t block = 0;     // logical index
+        size_t offset = 0;
+        uint64_t pendingRepeats = 0;
+        int64_t dt = 0;
+        int64_t to = 0;
+        HistoryRecord record;
+    };
+
+    struct Range {
+        Iterator first;
+        Iterator begin() const { return first; }
+        Iterator end() const { return Iterator(); }
+    };
+
+    // Records with from <= time < to, oldest first.
+    Range Query(int64_t from, int64_t to) const;
+    Range All() const { return Query(INT64_MIN, INT64_MAX); }
+
+    size_t GetUsedBytes() const;
+
+private:
+    // Decoder/encoder position after the last record
+    struct State {
+        int64_t time = 0;
+        int64_t dt = 0;
+        int level = -1;
+        bool charging = false;
+    };
+
+    static constexpr size_t PayloadBytes = BlockSize - sizeof(HistoryBlockHeader);
+    static constexpr uint64_t MaxInPlaceRepeats = 31; // largest n with a one-byte tag
+
+    HistoryFileHeader* Header() const { return reinterpret_cast<HistoryFileHeader*>(file.Data()); }
+    HistoryBlockHeader* Block(uint32_t logical) const;
+    bool Validate() const;
+    void Recover();
+    void StartBlock();
+    void Emit(const uint8_t* bytes, size_t length, const State& after);
+    void AppendSample(int64_t time, int level);
+    void AppendCharge(int64_t time, bool charging);
+
+    // Decodes the record at `offset`; false at the end of the block's data.
+    static bool Decode(const uint8_t* payload, size_t used, size_t& offset, State& state,
+                       HistoryRecord::Kind& kind, uint64_t& repeats);
+
+    MappedFile file;
+    bool writable = false;
+    State state;                  // after the last appended record
+    bool haveBlock = false;
+    size_t repeatOffset = SIZE_MAX; // tag byte of a trailing repeat record
+    uint64_t repeatCount = 0;
+};
+
+// One BatteryHistory per device key, kept in `directory` as
+// RazerBatteryHistory-<key>.bin.
+class BatteryHistoryStore {
+public:
+    bool Open(const std::string& directory, uint32_t blocksPerDevice = BatteryHistory::DefaultBlocks);
+    // Appends every awake device with a known level at `time` (seconds since epoch).
+    void Record(const std::vector<DeviceStatus>& statuses, int64_t time);
+    // nullptr if the device has no history yet.
+    BatteryHistory* Get(const std::string& deviceKey);
+
+    static std::string PathFor(const std::string& directory, const std::string& deviceKey);
+
+private:
+    std::string directory;
+    uint32_t blocks = BatteryHistory::DefaultBlocks;
+    std::map<std::string, std::unique_ptr<BatteryHistory>> histories;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <random>
+
+enum class BreakerState : uint8_t {
+    Closed,     // calls go through
+    Open,       // calls are skipped until the retry time
+    HalfOpen,   // one trial call is going through; others are skipped
+};
+
+// Stops re-running a query that keeps failing. After failureThreshold
+// failures in a row the breaker opens and the query is skipped; once the
+// backoff has passed, one trial is let through (half-open). Success closes
+// the breaker, failure re-opens it with the backoff doubled up to
+// maxBackoff. Each backoff is spread by ±jitter so that devices which
+// failed together do not retry together. A trial whose outcome is never
+// recorded re-opens the breaker, with the same backoff, once that backoff
+// has passed again.
+//
+// Times are EventLog::NowUs() microseconds. Not thread-safe: one per
+// device and command, used by that device's polling task.
+class CircuitBreaker {
+public:
+    struct Options {
+        int failureThreshold = 2;
+        uint64_t initialBackoffUs = 10ull * 60 * 1000000;   // 2 polls at the default interval
+        uint64_t maxBackoffUs = 4ull * 3600 * 1000000;
+        double jitter = 0.2;
+    };
+
+    explicit CircuitBreaker(uint32_t seed = 0) : random(seed) {}
+    CircuitBreaker(const Options& options, uint32_t seed) : options(options), random(seed) {}
+
+    // Whether the call may go ahead. Moves Open to HalfOpen once due, and
+    // HalfOpen back to Open once its trial is overdue.
+    bool Allow(uint64_t nowUs);
+    void RecordSuccess();
+    // Returns true when this failure opened the breaker.
+    bool RecordFailure(uint64_t nowUs);
+    // The call got no answer either way (cut short, device asleep). A
+    // trial becomes due again at once; a closed breaker is unchanged.
+    void RecordNoOutcome();
+
+    BreakerState GetState() const { return state; }
+    uint64_t GetRetryAtUs() const { return retryAtUs; }
+
+private:
+    Options options;
+    std::minstd_rand random;
+    BreakerState state = BreakerState::Closed;
+    int failures = 0;           // consecutive, while closed
+    uint64_t backoffUs = 0;     // un-jittered; doubles per failed trial
+    uint64_t retryAtUs = 0;     // half-open: when the trial is overdue
+
+    void Reopen(uint64_t nowUs);
+};
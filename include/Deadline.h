@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+// Time left for one refresh. It is handed down to every USB transfer, and
+// each transfer waits at most min(remaining, its own timeout). Once the
+// time is up, no new transfer starts, and callers report what they have
+// collected so far.
+//
+// A limited deadline can also be cancelled early from another thread (the
+// poller yields a background refresh to an interactive one this way).
+// Copies share the cancellation, so every transfer handed a copy stops
+// with the rest; a transfer already on the wire still runs to its timeout.
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // No limit: every call gets its own timeout.
+    Deadline() = default;
+    static Deadline After(std::chrono::milliseconds budget) {
+        Deadline deadline;
+        deadline.at = Clock::now() + budget;
+        deadline.limited = true;
+        deadline.cancelled = std::make_shared<std::atomic<bool>>(false);
+        return deadline;
+    }
+
+    void Cancel() const {
+        if (cancelled) cancelled->store(true);
+    }
+    bool Cancelled() const { return cancelled && cancelled->load(); }
+
+    bool Expired() const { return limited && (Cancelled() || Clock::now() >= at); }
+
+    // Timeout for a call whose own limit is capMs. 0 only once expired;
+    // callers must then skip the call (libusb reads a 0 timeout as "wait
+    // forever"). What is left is rounded up, so the last fraction of a
+    // millisecond still gets a 1 ms call rather than looking like a
+    // failure that is not one.
+    unsigned int Cap(unsigned int capMs) const {
+        if (!limited) return capMs;
+        if (Cancelled()) return 0;
+        auto left = at - Clock::now();
+        if (left <= Clock::duration::zero()) return 0;
+        auto leftMs = std::chrono::ceil<std::chrono::milliseconds>(left).count();
+        return static_cast<unsigned int>(std::min<long long>(leftMs, capMs));
+    }
+
+private:
+    Clock::time_point at;
+    bool limited = false;
+    std::shared_ptr<std::atomic<bool>> cancelled; // null when unlimited
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// Unsolicited state-change reports read from a device's interrupt IN
+// endpoint.
+//
+// PLACEHOLDER FORMAT. No documented or captured Razer battery, charging or
+// link notification exists: the kernel drivers' razer_raw_event handlers
+// only translate key and button reports (report 0x04), and nothing in
+// driver/ sends or decodes a battery notification. The layout below is
+// this project's own, used by the simulated backend. It is kept in this
+// one table so that a captured format can replace it. Until then, listening
+// is opt-in (PollerOptions::listenForEvents):
+//
+//   byte 0  NotificationReportId
+//   byte 1  what changed (NotificationCode)
+//   byte 2  the new value
+//   rest    zero
+//
+// Anything else on the endpoint (input reports, key events, replies) is
+// not a notification and is ignored. Requiring the padding to be zero keeps
+// ordinary input reports that happen to start with 0x05 from being read as
+// one.
+constexpr uint8_t NotificationReportId = 0x05;
+
+enum class NotificationCode : uint8_t {
+    Link = 0x01,        // value 1: the receiver reached the device, 0: lost it
+    Battery = 0x80,     // value 0-255, scaled like the 0x07/0x80 answer
+    Charging = 0x84,    // value 1 while charging, as the 0x07/0x84 answer
+};
+
+enum class DeviceEventKind : uint8_t { Battery, Charging, Connected, Disconnected };
+
+struct DeviceEvent {
+    DeviceEventKind kind = DeviceEventKind::Battery;
+    int level = -1;         // Battery: 0-100
+    bool charging = false;  // Charging
+};
+
+const char* DeviceEventKindName(DeviceEventKind kind);
+
+// Decodes one report read from the interrupt endpoint. False for anything
+// that is not a notification in the layout above.
+bool DecodeDeviceEvent(const unsigned char* data, int length, DeviceEvent& event);
@@ -692,12 +692,12 @@
 #ifndef USB_DEVICE_ID_RAZER_KRAKEN_ULTIMATE
 #define USB_DEVICE_ID_RAZER_KRAKEN_ULTIMATE 0x0527
 #endif
-#ifndef USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023
-#define USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023 0x0555
-#endif
 #ifndef USB_DEVICE_ID_RAZER_KRAKEN_KITTY_V2
 #define USB_DEVICE_ID_RAZER_KRAKEN_KITTY_V2 0x0560
 #endif
+#ifndef USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023
+#define USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023 0x0555
+#endif
 #ifndef USB_DEVICE_ID_RAZER_FIREFLY_HYPERFLUX
 #define USB_DEVICE_ID_RAZER_FIREFLY_HYPERFLUX 0x0068
 #endif
@@ -1013,8 +1013,8 @@ inline RazerDeviceType GetRazerDeviceType(int pid) {
     case USB_DEVICE_ID_RAZER_KRAKEN_CLASSIC_ALT: return RazerDeviceType::Headset;
     case USB_DEVICE_ID_RAZER_KRAKEN_V2: return RazerDeviceType::Headset;
     case USB_DEVICE_ID_RAZER_KRAKEN_ULTIMATE: return RazerDeviceType::Headset;
-    case USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023: return RazerDeviceType::Headset;
     case USB_DEVICE_ID_RAZER_KRAKEN_KITTY_V2: return RazerDeviceType::Headset;
+    case USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023: return RazerDeviceType::Headset;
     case USB_DEVICE_ID_RAZER_FIREFLY_HYPERFLUX: return RazerDeviceType::Accessory;
     case USB_DEVICE_ID_RAZER_MOUSE_DOCK: return RazerDeviceType::Accessory;
     case USB_DEVICE_ID_RAZER_CORE: return RazerDeviceType::Accessory;
@@ -1044,3 +1044,530 @@ inline RazerDeviceType GetRazerDeviceType(int pid) {
     default: return RazerDeviceType::Unknown;
     }
 }
+
+// Marketing-ish name derived from the OpenRazer define, e.g. "Razer Blackshark V2 Pro 2023"
+inline const char* GetRazerDeviceName(int pid) {
+    switch(pid) {
+    case USB_DEVICE_ID_RAZER_OROCHI_2011: return "Razer Orochi 2011";
+    case USB_DEVICE_ID_RAZER_NAGA: return "Razer Naga";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_3_5G: return "Razer Deathadder 3 5G";
+    case USB_DEVICE_ID_RAZER_NAGA_EPIC: return "Razer Naga Epic";
+    case USB_DEVICE_ID_RAZER_ABYSSUS_1800: return "Razer Abyssus 1800";
+    case USB_DEVICE_ID_RAZER_MAMBA_2012_WIRED: return "Razer Mamba 2012 Wired";
+    case USB_DEVICE_ID_RAZER_MAMBA_2012_WIRELESS: return "Razer Mamba 2012 Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_3_5G_BLACK: return "Razer Deathadder 3 5G Black";
+    case USB_DEVICE_ID_RAZER_NAGA_2012: return "Razer Naga 2012";
+    case USB_DEVICE_ID_RAZER_IMPERATOR: return "Razer Imperator";
+    case USB_DEVICE_ID_RAZER_OUROBOROS: return "Razer Ouroboros";
+    case USB_DEVICE_ID_RAZER_TAIPAN: return "Razer Taipan";
+    case USB_DEVICE_ID_RAZER_NAGA_HEX_RED: return "Razer Naga Hex Red";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_2013: return "Razer Deathadder 2013";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_1800: return "Razer Deathadder 1800";
+    case USB_DEVICE_ID_RAZER_OROCHI_2013: return "Razer Orochi 2013";
+    case USB_DEVICE_ID_RAZER_NAGA_EPIC_CHROMA: return "Razer Naga Epic Chroma";
+    case USB_DEVICE_ID_RAZER_NAGA_EPIC_CHROMA_DOCK: return "Razer Naga Epic Chroma Dock";
+    case USB_DEVICE_ID_RAZER_NAGA_2014: return "Razer Naga 2014";
+    case USB_DEVICE_ID_RAZER_NAGA_HEX: return "Razer Naga Hex";
+    case USB_DEVICE_ID_RAZER_ABYSSUS: return "Razer Abyssus";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_CHROMA: return "Razer Deathadder Chroma";
+    case USB_DEVICE_ID_RAZER_MAMBA_WIRED: return "Razer Mamba Wired";
+    case USB_DEVICE_ID_RAZER_MAMBA_WIRELESS: return "Razer Mamba Wireless";
+    case USB_DEVICE_ID_RAZER_MAMBA_TE_WIRED: return "Razer Mamba TE Wired";
+    case USB_DEVICE_ID_RAZER_OROCHI_CHROMA: return "Razer Orochi Chroma";
+    case USB_DEVICE_ID_RAZER_DIAMONDBACK_CHROMA: return "Razer Diamondback Chroma";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_2000: return "Razer Deathadder 2000";
+    case USB_DEVICE_ID_RAZER_NAGA_HEX_V2: return "Razer Naga Hex V2";
+    case USB_DEVICE_ID_RAZER_NAGA_CHROMA: return "Razer Naga Chroma";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_3500: return "Razer Deathadder 3500";
+    case USB_DEVICE_ID_RAZER_LANCEHEAD_WIRED: return "Razer Lancehead Wired";
+    case USB_DEVICE_ID_RAZER_LANCEHEAD_WIRELESS: return "Razer Lancehead Wireless";
+    case USB_DEVICE_ID_RAZER_ABYSSUS_V2: return "Razer Abyssus V2";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_ELITE: return "Razer Deathadder Elite";
+    case USB_DEVICE_ID_RAZER_ABYSSUS_2000: return "Razer Abyssus 2000";
+    case USB_DEVICE_ID_RAZER_LANCEHEAD_TE_WIRED: return "Razer Lancehead TE Wired";
+    case USB_DEVICE_ID_RAZER_ATHERIS_RECEIVER: return "Razer Atheris Receiver";
+    case USB_DEVICE_ID_RAZER_BASILISK: return "Razer Basilisk";
+    case USB_DEVICE_ID_RAZER_BASILISK_ESSENTIAL: return "Razer Basilisk Essential";
+    case USB_DEVICE_ID_RAZER_NAGA_TRINITY: return "Razer Naga Trinity";
+    case USB_DEVICE_ID_RAZER_ABYSSUS_ELITE_DVA_EDITION: return "Razer Abyssus Elite Dva Edition";
+    case USB_DEVICE_ID_RAZER_ABYSSUS_ESSENTIAL: return "Razer Abyssus Essential";
+    case USB_DEVICE_ID_RAZER_MAMBA_ELITE: return "Razer Mamba Elite";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_ESSENTIAL: return "Razer Deathadder Essential";
+    case USB_DEVICE_ID_RAZER_LANCEHEAD_WIRELESS_RECEIVER: return "Razer Lancehead Wireless Receiver";
+    case USB_DEVICE_ID_RAZER_LANCEHEAD_WIRELESS_WIRED: return "Razer Lancehead Wireless Wired";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_ESSENTIAL_WHITE_EDITION: return "Razer Deathadder Essential White Edition";
+    case USB_DEVICE_ID_RAZER_MAMBA_WIRELESS_RECEIVER: return "Razer Mamba Wireless Receiver";
+    case USB_DEVICE_ID_RAZER_MAMBA_WIRELESS_WIRED: return "Razer Mamba Wireless Wired";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_RECEIVER: return "Razer Pro Click Receiver";
+    case USB_DEVICE_ID_RAZER_VIPER: return "Razer Viper";
+    case USB_DEVICE_ID_RAZER_VIPER_ULTIMATE_WIRED: return "Razer Viper Ultimate Wired";
+    case USB_DEVICE_ID_RAZER_VIPER_ULTIMATE_WIRELESS: return "Razer Viper Ultimate Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V2_PRO_WIRED: return "Razer Deathadder V2 Pro Wired";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V2_PRO_WIRELESS: return "Razer Deathadder V2 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_WIRED: return "Razer Pro Click Wired";
+    case USB_DEVICE_ID_RAZER_BASILISK_X_HYPERSPEED: return "Razer Basilisk X Hyperspeed";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V2: return "Razer Deathadder V2";
+    case USB_DEVICE_ID_RAZER_BASILISK_V2: return "Razer Basilisk V2";
+    case USB_DEVICE_ID_RAZER_BASILISK_ULTIMATE_WIRED: return "Razer Basilisk Ultimate Wired";
+    case USB_DEVICE_ID_RAZER_BASILISK_ULTIMATE_RECEIVER: return "Razer Basilisk Ultimate Receiver";
+    case USB_DEVICE_ID_RAZER_VIPER_MINI: return "Razer Viper Mini";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V2_MINI: return "Razer Deathadder V2 Mini";
+    case USB_DEVICE_ID_RAZER_NAGA_LEFT_HANDED_2020: return "Razer Naga Left Handed 2020";
+    case USB_DEVICE_ID_RAZER_NAGA_PRO_WIRED: return "Razer Naga Pro Wired";
+    case USB_DEVICE_ID_RAZER_NAGA_PRO_WIRELESS: return "Razer Naga Pro Wireless";
+    case USB_DEVICE_ID_RAZER_VIPER_8K: return "Razer Viper 8K";
+    case USB_DEVICE_ID_RAZER_OROCHI_V2_RECEIVER: return "Razer Orochi V2 Receiver";
+    case USB_DEVICE_ID_RAZER_OROCHI_V2_BLUETOOTH: return "Razer Orochi V2 Bluetooth";
+    case USB_DEVICE_ID_RAZER_NAGA_X: return "Razer Naga X";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_ESSENTIAL_2021: return "Razer Deathadder Essential 2021";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3: return "Razer Basilisk V3";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_MINI_RECEIVER: return "Razer Pro Click Mini Receiver";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V2_X_HYPERSPEED: return "Razer Deathadder V2 X Hyperspeed";
+    case USB_DEVICE_ID_RAZER_VIPER_MINI_SE_WIRED: return "Razer Viper Mini SE Wired";
+    case USB_DEVICE_ID_RAZER_VIPER_MINI_SE_WIRELESS: return "Razer Viper Mini SE Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V2_LITE: return "Razer Deathadder V2 Lite";
+    case USB_DEVICE_ID_RAZER_COBRA: return "Razer Cobra";
+    case USB_DEVICE_ID_RAZER_VIPER_V2_PRO_WIRED: return "Razer Viper V2 Pro Wired";
+    case USB_DEVICE_ID_RAZER_VIPER_V2_PRO_WIRELESS: return "Razer Viper V2 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_NAGA_V2_PRO_WIRED: return "Razer Naga V2 Pro Wired";
+    case USB_DEVICE_ID_RAZER_NAGA_V2_PRO_WIRELESS: return "Razer Naga V2 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_WIRED: return "Razer Basilisk V3 Pro Wired";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_WIRELESS: return "Razer Basilisk V3 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_COBRA_PRO_WIRED: return "Razer Cobra Pro Wired";
+    case USB_DEVICE_ID_RAZER_COBRA_PRO_WIRELESS: return "Razer Cobra Pro Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3: return "Razer Deathadder V3";
+    case USB_DEVICE_ID_RAZER_HYPERPOLLING_WIRELESS_DONGLE: return "Razer Hyperpolling Wireless Dongle";
+    case USB_DEVICE_ID_RAZER_NAGA_V2_HYPERSPEED_RECEIVER: return "Razer Naga V2 Hyperspeed Receiver";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRED: return "Razer Deathadder V3 Pro Wired";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRELESS: return "Razer Deathadder V3 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_VIPER_V3_HYPERSPEED: return "Razer Viper V3 Hyperspeed";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_X_HYPERSPEED: return "Razer Basilisk V3 X Hyperspeed";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V4_PRO_WIRED: return "Razer Deathadder V4 Pro Wired";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V4_PRO_WIRELESS: return "Razer Deathadder V4 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_VIPER_V3_PRO_WIRED: return "Razer Viper V3 Pro Wired";
+    case USB_DEVICE_ID_RAZER_VIPER_V3_PRO_WIRELESS: return "Razer Viper V3 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRED_ALT: return "Razer Deathadder V3 Pro Wired Alt";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRELESS_ALT: return "Razer Deathadder V3 Pro Wireless Alt";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3_HYPERSPEED_WIRED: return "Razer Deathadder V3 Hyperspeed Wired";
+    case USB_DEVICE_ID_RAZER_DEATHADDER_V3_HYPERSPEED_WIRELESS: return "Razer Deathadder V3 Hyperspeed Wireless";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_V2_VERTICAL_EDITION_WIRED: return "Razer Pro Click V2 Vertical Edition Wired";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_V2_VERTICAL_EDITION_WIRELESS: return "Razer Pro Click V2 Vertical Edition Wireless";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_35K: return "Razer Basilisk V3 35K";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_WIRED: return "Razer Basilisk V3 Pro 35K Wired";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_WIRELESS: return "Razer Basilisk V3 Pro 35K Wireless";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_V2_WIRED: return "Razer Pro Click V2 Wired";
+    case USB_DEVICE_ID_RAZER_PRO_CLICK_V2_WIRELESS: return "Razer Pro Click V2 Wireless";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_PHANTOM_GREEN_EDITION_WIRED: return "Razer Basilisk V3 Pro 35K Phantom Green Edition Wired";
+    case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_PHANTOM_GREEN_EDITION_WIRELESS: return "Razer Basilisk V3 Pro 35K Phantom Green Edition Wireless";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2012: return "Razer Blackwidow Ultimate 2012";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_STEALTH_EDITION: return "Razer Blackwidow Stealth Edition";
+    case USB_DEVICE_ID_RAZER_ANANSI: return "Razer Anansi";
+    case USB_DEVICE_ID_RAZER_NOSTROMO: return "Razer Nostromo";
+    case USB_DEVICE_ID_RAZER_ORBWEAVER: return "Razer Orbweaver";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_ESSENTIAL: return "Razer Deathstalker Essential";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2013: return "Razer Blackwidow Ultimate 2013";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_STEALTH: return "Razer Blackwidow Stealth";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_TE_2014: return "Razer Blackwidow TE 2014";
+    case USB_DEVICE_ID_RAZER_TARTARUS: return "Razer Tartarus";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_EXPERT: return "Razer Deathstalker Expert";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA: return "Razer Blackwidow Chroma";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_CHROMA: return "Razer Deathstalker Chroma";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH: return "Razer Blade Stealth";
+    case USB_DEVICE_ID_RAZER_ORBWEAVER_CHROMA: return "Razer Orbweaver Chroma";
+    case USB_DEVICE_ID_RAZER_TARTARUS_CHROMA: return "Razer Tartarus Chroma";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA_TE: return "Razer Blackwidow Chroma TE";
+    case USB_DEVICE_ID_RAZER_BLADE_QHD: return "Razer Blade Qhd";
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2016: return "Razer Blade Pro Late 2016";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_OVERWATCH: return "Razer Blackwidow Overwatch";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2016: return "Razer Blackwidow Ultimate 2016";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_X_CHROMA: return "Razer Blackwidow X Chroma";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_X_ULTIMATE: return "Razer Blackwidow X Ultimate";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_X_CHROMA_TE: return "Razer Blackwidow X Chroma TE";
+    case USB_DEVICE_ID_RAZER_ORNATA_CHROMA: return "Razer Ornata Chroma";
+    case USB_DEVICE_ID_RAZER_ORNATA: return "Razer Ornata";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2016: return "Razer Blade Stealth Late 2016";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA_V2: return "Razer Blackwidow Chroma V2";
+    case USB_DEVICE_ID_RAZER_BLADE_LATE_2016: return "Razer Blade Late 2016";
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_2017: return "Razer Blade Pro 2017";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_ELITE: return "Razer Huntsman Elite";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN: return "Razer Huntsman";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ELITE: return "Razer Blackwidow Elite";
+    case USB_DEVICE_ID_RAZER_CYNOSA_CHROMA: return "Razer Cynosa Chroma";
+    case USB_DEVICE_ID_RAZER_TARTARUS_V2: return "Razer Tartarus V2";
+    case USB_DEVICE_ID_RAZER_CYNOSA_CHROMA_PRO: return "Razer Cynosa Chroma Pro";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_MID_2017: return "Razer Blade Stealth Mid 2017";
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_2017_FULLHD: return "Razer Blade Pro 2017 Fullhd";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2017: return "Razer Blade Stealth Late 2017";
+    case USB_DEVICE_ID_RAZER_BLADE_2018: return "Razer Blade 2018";
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_2019: return "Razer Blade Pro 2019";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_LITE: return "Razer Blackwidow Lite";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ESSENTIAL: return "Razer Blackwidow Essential";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_2019: return "Razer Blade Stealth 2019";
+    case USB_DEVICE_ID_RAZER_BLADE_2019_ADV: return "Razer Blade 2019 Adv";
+    case USB_DEVICE_ID_RAZER_BLADE_2018_BASE: return "Razer Blade 2018 Base";
+    case USB_DEVICE_ID_RAZER_CYNOSA_LITE: return "Razer Cynosa Lite";
+    case USB_DEVICE_ID_RAZER_BLADE_2018_MERCURY: return "Razer Blade 2018 Mercury";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_2019: return "Razer Blackwidow 2019";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_TE: return "Razer Huntsman TE";
+    case USB_DEVICE_ID_RAZER_BLADE_MID_2019_MERCURY: return "Razer Blade Mid 2019 Mercury";
+    case USB_DEVICE_ID_RAZER_BLADE_2019_BASE: return "Razer Blade 2019 Base";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2019: return "Razer Blade Stealth Late 2019";
+    case USB_DEVICE_ID_RAZER_BLADE_ADV_LATE_2019: return "Razer Blade Adv Late 2019";
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2019: return "Razer Blade Pro Late 2019";
+    case USB_DEVICE_ID_RAZER_BLADE_STUDIO_EDITION_2019: return "Razer Blade Studio Edition 2019";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3: return "Razer Blackwidow V3";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_EARLY_2020: return "Razer Blade Stealth Early 2020";
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_2020: return "Razer Blade 15 Adv 2020";
+    case USB_DEVICE_ID_RAZER_BLADE_EARLY_2020_BASE: return "Razer Blade Early 2020 Base";
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_EARLY_2020: return "Razer Blade Pro Early 2020";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI: return "Razer Huntsman Mini";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI_HYPERSPEED_WIRED: return "Razer Blackwidow V3 Mini Hyperspeed Wired";
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2020: return "Razer Blade Stealth Late 2020";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRED: return "Razer Blackwidow V3 Pro Wired";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRELESS: return "Razer Blackwidow V3 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_ORNATA_V2: return "Razer Ornata V2";
+    case USB_DEVICE_ID_RAZER_CYNOSA_V2: return "Razer Cynosa V2";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V2_ANALOG: return "Razer Huntsman V2 Analog";
+    case USB_DEVICE_ID_RAZER_BLADE_LATE_2020_BASE: return "Razer Blade Late 2020 Base";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_JP: return "Razer Huntsman Mini JP";
+    case USB_DEVICE_ID_RAZER_BOOK_2020: return "Razer Book 2020";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V2_TENKEYLESS: return "Razer Huntsman V2 Tenkeyless";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V2: return "Razer Huntsman V2";
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2021: return "Razer Blade 15 Adv Early 2021";
+    case USB_DEVICE_ID_RAZER_BLADE_17_PRO_EARLY_2021: return "Razer Blade 17 Pro Early 2021";
+    case USB_DEVICE_ID_RAZER_BLADE_15_BASE_EARLY_2021: return "Razer Blade 15 Base Early 2021";
+    case USB_DEVICE_ID_RAZER_BLADE_14_2021: return "Razer Blade 14 2021";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI_HYPERSPEED_WIRELESS: return "Razer Blackwidow V3 Mini Hyperspeed Wireless";
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_MID_2021: return "Razer Blade 15 Adv Mid 2021";
+    case USB_DEVICE_ID_RAZER_BLADE_17_PRO_MID_2021: return "Razer Blade 17 Pro Mid 2021";
+    case USB_DEVICE_ID_RAZER_BLADE_15_BASE_2022: return "Razer Blade 15 Base 2022";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_ANALOG: return "Razer Huntsman Mini Analog";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4: return "Razer Blackwidow V4";
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2022: return "Razer Blade 15 Adv Early 2022";
+    case USB_DEVICE_ID_RAZER_BLADE_17_2022: return "Razer Blade 17 2022";
+    case USB_DEVICE_ID_RAZER_BLADE_14_2022: return "Razer Blade 14 2022";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_PRO: return "Razer Blackwidow V4 Pro";
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_ALT: return "Razer Ornata V3 Alt";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRELESS: return "Razer Deathstalker V2 Pro Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRED: return "Razer Deathstalker V2 Pro Wired";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_X: return "Razer Blackwidow V4 X";
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_X: return "Razer Ornata V3 X";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2: return "Razer Deathstalker V2";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRELESS: return "Razer Deathstalker V2 Pro Tkl Wireless";
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRED: return "Razer Deathstalker V2 Pro Tkl Wired";
+    case USB_DEVICE_ID_RAZER_BLADE_14_2023: return "Razer Blade 14 2023";
+    case USB_DEVICE_ID_RAZER_BLADE_15_2023: return "Razer Blade 15 2023";
+    case USB_DEVICE_ID_RAZER_BLADE_16_2023: return "Razer Blade 16 2023";
+    case USB_DEVICE_ID_RAZER_BLADE_18_2023: return "Razer Blade 18 2023";
+    case USB_DEVICE_ID_RAZER_ORNATA_V3: return "Razer Ornata V3";
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_X_ALT: return "Razer Ornata V3 X Alt";
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_TENKEYLESS: return "Razer Ornata V3 Tenkeyless";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_75PCT: return "Razer Blackwidow V4 75PCT";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V3_PRO: return "Razer Huntsman V3 Pro";
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V3_PRO_TKL: return "Razer Huntsman V3 Pro Tkl";
+    case USB_DEVICE_ID_RAZER_BLADE_14_2024: return "Razer Blade 14 2024";
+    case USB_DEVICE_ID_RAZER_BLADE_18_2024: return "Razer Blade 18 2024";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_MINI_HYPERSPEED_WIRED: return "Razer Blackwidow V4 Mini Hyperspeed Wired";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_MINI_HYPERSPEED_WIRELESS: return "Razer Blackwidow V4 Mini Hyperspeed Wireless";
+    case USB_DEVICE_ID_RAZER_BLADE_14_2025: return "Razer Blade 14 2025";
+    case USB_DEVICE_ID_RAZER_BLADE_16_2025: return "Razer Blade 16 2025";
+    case USB_DEVICE_ID_RAZER_BLADE_18_2025: return "Razer Blade 18 2025";
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_TK: return "Razer Blackwidow V3 TK";
+    case USB_DEVICE_ID_RAZER_KRAKEN_CLASSIC: return "Razer Kraken Classic";
+    case USB_DEVICE_ID_RAZER_KRAKEN: return "Razer Kraken";
+    case USB_DEVICE_ID_RAZER_KRAKEN_CLASSIC_ALT: return "Razer Kraken Classic Alt";
+    case USB_DEVICE_ID_RAZER_KRAKEN_V2: return "Razer Kraken V2";
+    case USB_DEVICE_ID_RAZER_KRAKEN_ULTIMATE: return "Razer Kraken Ultimate";
+    case USB_DEVICE_ID_RAZER_KRAKEN_KITTY_V2: return "Razer Kraken Kitty V2";
+    case USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023: return "Razer Blackshark V2 Pro 2023";
+    case USB_DEVICE_ID_RAZER_FIREFLY_HYPERFLUX: return "Razer Firefly Hyperflux";
+    case USB_DEVICE_ID_RAZER_MOUSE_DOCK: return "Razer Mouse Dock";
+    case USB_DEVICE_ID_RAZER_CORE: return "Razer Core";
+    case USB_DEVICE_ID_RAZER_NOMMO_CHROMA: return "Razer Nommo Chroma";
+    case USB_DEVICE_ID_RAZER_NOMMO_PRO: return "Razer Nommo Pro";
+    case USB_DEVICE_ID_RAZER_FIREFLY: return "Razer Firefly";
+    case USB_DEVICE_ID_RAZER_GOLIATHUS_CHROMA: return "Razer Goliathus Chroma";
+    case USB_DEVICE_ID_RAZER_GOLIATHUS_CHROMA_EXTENDED: return "Razer Goliathus Chroma Extended";
+    case USB_DEVICE_ID_RAZER_FIREFLY_V2: return "Razer Firefly V2";
+    case USB_DEVICE_ID_RAZER_STRIDER_CHROMA: return "Razer Strider Chroma";
+    case USB_DEVICE_ID_RAZER_GOLIATHUS_CHROMA_3XL: return "Razer Goliathus Chroma 3XL";
+    case USB_DEVICE_ID_RAZER_FIREFLY_V2_PRO: return "Razer Firefly V2 Pro";
+    case USB_DEVICE_ID_RAZER_CHROMA_MUG: return "Razer Chroma Mug";
+    case USB_DEVICE_ID_RAZER_CHROMA_BASE: return "Razer Chroma Base";
+    case USB_DEVICE_ID_RAZER_CHROMA_HDK: return "Razer Chroma Hdk";
+    case USB_DEVICE_ID_RAZER_LAPTOP_STAND_CHROMA: return "Razer Laptop Stand Chroma";
+    case USB_DEVICE_ID_RAZER_RAPTOR_27: return "Razer Raptor 27";
+    case USB_DEVICE_ID_RAZER_TOMAHAWK_ATX: return "Razer Tomahawk Atx";
+    case USB_DEVICE_ID_RAZER_KRAKEN_KITTY_EDITION: return "Razer Kraken Kitty Edition";
+    case USB_DEVICE_ID_RAZER_CORE_X_CHROMA: return "Razer Core X Chroma";
+    case USB_DEVICE_ID_RAZER_MOUSE_BUNGEE_V3_CHROMA: return "Razer Mouse Bungee V3 Chroma";
+    case USB_DEVICE_ID_RAZER_CHROMA_ADDRESSABLE_RGB_CONTROLLER: return "Razer Chroma Addressable Rgb Controller";
+    case USB_DEVICE_ID_RAZER_BASE_STATION_V2_CHROMA: return "Razer Base Station V2 Chroma";
+    case USB_DEVICE_ID_RAZER_THUNDERBOLT_4_DOCK_CHROMA: return "Razer Thunderbolt 4 Dock Chroma";
+    case USB_DEVICE_ID_RAZER_CHARGING_PAD_CHROMA: return "Razer Charging Pad Chroma";
+    case USB_DEVICE_ID_RAZER_LAPTOP_STAND_CHROMA_V2: return "Razer Laptop Stand Chroma V2";
+    default: return nullptr;
+    }
+}
+
+// Every known PID, in header order
+inline constexpr int RazerDeviceIds[] = {
+    USB_DEVICE_ID_RAZER_OROCHI_2011,
+    USB_DEVICE_ID_RAZER_NAGA,
+    USB_DEVICE_ID_RAZER_DEATHADDER_3_5G,
+    USB_DEVICE_ID_RAZER_NAGA_EPIC,
+    USB_DEVICE_ID_RAZER_ABYSSUS_1800,
+    USB_DEVICE_ID_RAZER_MAMBA_2012_WIRED,
+    USB_DEVICE_ID_RAZER_MAMBA_2012_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHADDER_3_5G_BLACK,
+    USB_DEVICE_ID_RAZER_NAGA_2012,
+    USB_DEVICE_ID_RAZER_IMPERATOR,
+    USB_DEVICE_ID_RAZER_OUROBOROS,
+    USB_DEVICE_ID_RAZER_TAIPAN,
+    USB_DEVICE_ID_RAZER_NAGA_HEX_RED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_2013,
+    USB_DEVICE_ID_RAZER_DEATHADDER_1800,
+    USB_DEVICE_ID_RAZER_OROCHI_2013,
+    USB_DEVICE_ID_RAZER_NAGA_EPIC_CHROMA,
+    USB_DEVICE_ID_RAZER_NAGA_EPIC_CHROMA_DOCK,
+    USB_DEVICE_ID_RAZER_NAGA_2014,
+    USB_DEVICE_ID_RAZER_NAGA_HEX,
+    USB_DEVICE_ID_RAZER_ABYSSUS,
+    USB_DEVICE_ID_RAZER_DEATHADDER_CHROMA,
+    USB_DEVICE_ID_RAZER_MAMBA_WIRED,
+    USB_DEVICE_ID_RAZER_MAMBA_WIRELESS,
+    USB_DEVICE_ID_RAZER_MAMBA_TE_WIRED,
+    USB_DEVICE_ID_RAZER_OROCHI_CHROMA,
+    USB_DEVICE_ID_RAZER_DIAMONDBACK_CHROMA,
+    USB_DEVICE_ID_RAZER_DEATHADDER_2000,
+    USB_DEVICE_ID_RAZER_NAGA_HEX_V2,
+    USB_DEVICE_ID_RAZER_NAGA_CHROMA,
+    USB_DEVICE_ID_RAZER_DEATHADDER_3500,
+    USB_DEVICE_ID_RAZER_LANCEHEAD_WIRED,
+    USB_DEVICE_ID_RAZER_LANCEHEAD_WIRELESS,
+    USB_DEVICE_ID_RAZER_ABYSSUS_V2,
+    USB_DEVICE_ID_RAZER_DEATHADDER_ELITE,
+    USB_DEVICE_ID_RAZER_ABYSSUS_2000,
+    USB_DEVICE_ID_RAZER_LANCEHEAD_TE_WIRED,
+    USB_DEVICE_ID_RAZER_ATHERIS_RECEIVER,
+    USB_DEVICE_ID_RAZER_BASILISK,
+    USB_DEVICE_ID_RAZER_BASILISK_ESSENTIAL,
+    USB_DEVICE_ID_RAZER_NAGA_TRINITY,
+    USB_DEVICE_ID_RAZER_ABYSSUS_ELITE_DVA_EDITION,
+    USB_DEVICE_ID_RAZER_ABYSSUS_ESSENTIAL,
+    USB_DEVICE_ID_RAZER_MAMBA_ELITE,
+    USB_DEVICE_ID_RAZER_DEATHADDER_ESSENTIAL,
+    USB_DEVICE_ID_RAZER_LANCEHEAD_WIRELESS_RECEIVER,
+    USB_DEVICE_ID_RAZER_LANCEHEAD_WIRELESS_WIRED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_ESSENTIAL_WHITE_EDITION,
+    USB_DEVICE_ID_RAZER_MAMBA_WIRELESS_RECEIVER,
+    USB_DEVICE_ID_RAZER_MAMBA_WIRELESS_WIRED,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_RECEIVER,
+    USB_DEVICE_ID_RAZER_VIPER,
+    USB_DEVICE_ID_RAZER_VIPER_ULTIMATE_WIRED,
+    USB_DEVICE_ID_RAZER_VIPER_ULTIMATE_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V2_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V2_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_WIRED,
+    USB_DEVICE_ID_RAZER_BASILISK_X_HYPERSPEED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V2,
+    USB_DEVICE_ID_RAZER_BASILISK_V2,
+    USB_DEVICE_ID_RAZER_BASILISK_ULTIMATE_WIRED,
+    USB_DEVICE_ID_RAZER_BASILISK_ULTIMATE_RECEIVER,
+    USB_DEVICE_ID_RAZER_VIPER_MINI,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V2_MINI,
+    USB_DEVICE_ID_RAZER_NAGA_LEFT_HANDED_2020,
+    USB_DEVICE_ID_RAZER_NAGA_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_NAGA_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_VIPER_8K,
+    USB_DEVICE_ID_RAZER_OROCHI_V2_RECEIVER,
+    USB_DEVICE_ID_RAZER_OROCHI_V2_BLUETOOTH,
+    USB_DEVICE_ID_RAZER_NAGA_X,
+    USB_DEVICE_ID_RAZER_DEATHADDER_ESSENTIAL_2021,
+    USB_DEVICE_ID_RAZER_BASILISK_V3,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_MINI_RECEIVER,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V2_X_HYPERSPEED,
+    USB_DEVICE_ID_RAZER_VIPER_MINI_SE_WIRED,
+    USB_DEVICE_ID_RAZER_VIPER_MINI_SE_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V2_LITE,
+    USB_DEVICE_ID_RAZER_COBRA,
+    USB_DEVICE_ID_RAZER_VIPER_V2_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_VIPER_V2_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_NAGA_V2_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_NAGA_V2_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_COBRA_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_COBRA_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3,
+    USB_DEVICE_ID_RAZER_HYPERPOLLING_WIRELESS_DONGLE,
+    USB_DEVICE_ID_RAZER_NAGA_V2_HYPERSPEED_RECEIVER,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_VIPER_V3_HYPERSPEED,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_X_HYPERSPEED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V4_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V4_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_VIPER_V3_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_VIPER_V3_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRED_ALT,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3_PRO_WIRELESS_ALT,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3_HYPERSPEED_WIRED,
+    USB_DEVICE_ID_RAZER_DEATHADDER_V3_HYPERSPEED_WIRELESS,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_V2_VERTICAL_EDITION_WIRED,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_V2_VERTICAL_EDITION_WIRELESS,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_35K,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_WIRED,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_WIRELESS,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_V2_WIRED,
+    USB_DEVICE_ID_RAZER_PRO_CLICK_V2_WIRELESS,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_PHANTOM_GREEN_EDITION_WIRED,
+    USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_35K_PHANTOM_GREEN_EDITION_WIRELESS,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2012,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_STEALTH_EDITION,
+    USB_DEVICE_ID_RAZER_ANANSI,
+    USB_DEVICE_ID_RAZER_NOSTROMO,
+    USB_DEVICE_ID_RAZER_ORBWEAVER,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_ESSENTIAL,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2013,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_STEALTH,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_TE_2014,
+    USB_DEVICE_ID_RAZER_TARTARUS,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_EXPERT,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_CHROMA,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH,
+    USB_DEVICE_ID_RAZER_ORBWEAVER_CHROMA,
+    USB_DEVICE_ID_RAZER_TARTARUS_CHROMA,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA_TE,
+    USB_DEVICE_ID_RAZER_BLADE_QHD,
+    USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2016,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_OVERWATCH,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2016,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_X_CHROMA,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_X_ULTIMATE,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_X_CHROMA_TE,
+    USB_DEVICE_ID_RAZER_ORNATA_CHROMA,
+    USB_DEVICE_ID_RAZER_ORNATA,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2016,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA_V2,
+    USB_DEVICE_ID_RAZER_BLADE_LATE_2016,
+    USB_DEVICE_ID_RAZER_BLADE_PRO_2017,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_ELITE,
+    USB_DEVICE_ID_RAZER_HUNTSMAN,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_ELITE,
+    USB_DEVICE_ID_RAZER_CYNOSA_CHROMA,
+    USB_DEVICE_ID_RAZER_TARTARUS_V2,
+    USB_DEVICE_ID_RAZER_CYNOSA_CHROMA_PRO,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_MID_2017,
+    USB_DEVICE_ID_RAZER_BLADE_PRO_2017_FULLHD,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2017,
+    USB_DEVICE_ID_RAZER_BLADE_2018,
+    USB_DEVICE_ID_RAZER_BLADE_PRO_2019,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_LITE,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_ESSENTIAL,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_2019,
+    USB_DEVICE_ID_RAZER_BLADE_2019_ADV,
+    USB_DEVICE_ID_RAZER_BLADE_2018_BASE,
+    USB_DEVICE_ID_RAZER_CYNOSA_LITE,
+    USB_DEVICE_ID_RAZER_BLADE_2018_MERCURY,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_2019,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_TE,
+    USB_DEVICE_ID_RAZER_BLADE_MID_2019_MERCURY,
+    USB_DEVICE_ID_RAZER_BLADE_2019_BASE,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2019,
+    USB_DEVICE_ID_RAZER_BLADE_ADV_LATE_2019,
+    USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2019,
+    USB_DEVICE_ID_RAZER_BLADE_STUDIO_EDITION_2019,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V3,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_EARLY_2020,
+    USB_DEVICE_ID_RAZER_BLADE_15_ADV_2020,
+    USB_DEVICE_ID_RAZER_BLADE_EARLY_2020_BASE,
+    USB_DEVICE_ID_RAZER_BLADE_PRO_EARLY_2020,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_MINI,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI_HYPERSPEED_WIRED,
+    USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2020,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_ORNATA_V2,
+    USB_DEVICE_ID_RAZER_CYNOSA_V2,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_V2_ANALOG,
+    USB_DEVICE_ID_RAZER_BLADE_LATE_2020_BASE,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_JP,
+    USB_DEVICE_ID_RAZER_BOOK_2020,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_V2_TENKEYLESS,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_V2,
+    USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2021,
+    USB_DEVICE_ID_RAZER_BLADE_17_PRO_EARLY_2021,
+    USB_DEVICE_ID_RAZER_BLADE_15_BASE_EARLY_2021,
+    USB_DEVICE_ID_RAZER_BLADE_14_2021,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI_HYPERSPEED_WIRELESS,
+    USB_DEVICE_ID_RAZER_BLADE_15_ADV_MID_2021,
+    USB_DEVICE_ID_RAZER_BLADE_17_PRO_MID_2021,
+    USB_DEVICE_ID_RAZER_BLADE_15_BASE_2022,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_ANALOG,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V4,
+    USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2022,
+    USB_DEVICE_ID_RAZER_BLADE_17_2022,
+    USB_DEVICE_ID_RAZER_BLADE_14_2022,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_PRO,
+    USB_DEVICE_ID_RAZER_ORNATA_V3_ALT,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRED,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_X,
+    USB_DEVICE_ID_RAZER_ORNATA_V3_X,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_V2,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRELESS,
+    USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRED,
+    USB_DEVICE_ID_RAZER_BLADE_14_2023,
+    USB_DEVICE_ID_RAZER_BLADE_15_2023,
+    USB_DEVICE_ID_RAZER_BLADE_16_2023,
+    USB_DEVICE_ID_RAZER_BLADE_18_2023,
+    USB_DEVICE_ID_RAZER_ORNATA_V3,
+    USB_DEVICE_ID_RAZER_ORNATA_V3_X_ALT,
+    USB_DEVICE_ID_RAZER_ORNATA_V3_TENKEYLESS,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_75PCT,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_V3_PRO,
+    USB_DEVICE_ID_RAZER_HUNTSMAN_V3_PRO_TKL,
+    USB_DEVICE_ID_RAZER_BLADE_14_2024,
+    USB_DEVICE_ID_RAZER_BLADE_18_2024,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_MINI_HYPERSPEED_WIRED,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_MINI_HYPERSPEED_WIRELESS,
+    USB_DEVICE_ID_RAZER_BLADE_14_2025,
+    USB_DEVICE_ID_RAZER_BLADE_16_2025,
+    USB_DEVICE_ID_RAZER_BLADE_18_2025,
+    USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_TK,
+    USB_DEVICE_ID_RAZER_KRAKEN_CLASSIC,
+    USB_DEVICE_ID_RAZER_KRAKEN,
+    USB_DEVICE_ID_RAZER_KRAKEN_CLASSIC_ALT,
+    USB_DEVICE_ID_RAZER_KRAKEN_V2,
+    USB_DEVICE_ID_RAZER_KRAKEN_ULTIMATE,
+    USB_DEVICE_ID_RAZER_KRAKEN_KITTY_V2,
+    USB_DEVICE_ID_RAZER_BLACKSHARK_V2_PRO_2023,
+    USB_DEVICE_ID_RAZER_FIREFLY_HYPERFLUX,
+    USB_DEVICE_ID_RAZER_MOUSE_DOCK,
+    USB_DEVICE_ID_RAZER_CORE,
+    USB_DEVICE_ID_RAZER_NOMMO_CHROMA,
+    USB_DEVICE_ID_RAZER_NOMMO_PRO,
+    USB_DEVICE_ID_RAZER_FIREFLY,
+    USB_DEVICE_ID_RAZER_GOLIATHUS_CHROMA,
+    USB_DEVICE_ID_RAZER_GOLIATHUS_CHROMA_EXTENDED,
+    USB_DEVICE_ID_RAZER_FIREFLY_V2,
+    USB_DEVICE_ID_RAZER_STRIDER_CHROMA,
+    USB_DEVICE_ID_RAZER_GOLIATHUS_CHROMA_3XL,
+    USB_DEVICE_ID_RAZER_FIREFLY_V2_PRO,
+    USB_DEVICE_ID_RAZER_CHROMA_MUG,
+    USB_DEVICE_ID_RAZER_CHROMA_BASE,
+    USB_DEVICE_ID_RAZER_CHROMA_HDK,
+    USB_DEVICE_ID_RAZER_LAPTOP_STAND_CHROMA,
+    USB_DEVICE_ID_RAZER_RAPTOR_27,
+    USB_DEVICE_ID_RAZER_TOMAHAWK_ATX,
+    USB_DEVICE_ID_RAZER_KRAKEN_KITTY_EDITION,
+    USB_DEVICE_ID_RAZER_CORE_X_CHROMA,
+    USB_DEVICE_ID_RAZER_MOUSE_BUNGEE_V3_CHROMA,
+    USB_DEVICE_ID_RAZER_CHROMA_ADDRESSABLE_RGB_CONTROLLER,
+    USB_DEVICE_ID_RAZER_BASE_STATION_V2_CHROMA,
+    USB_DEVICE_ID_RAZER_THUNDERBOLT_4_DOCK_CHROMA,
+    USB_DEVICE_ID_RAZER_CHARGING_PAD_CHROMA,
+    USB_DEVICE_ID_RAZER_LAPTOP_STAND_CHROMA_V2,
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <cwchar>
+#include <string>
+
+// Key used to match a device across enumerations: its serial, or
+// "PID_<hex pid>" when no serial could be read.
+inline std::wstring MakeDeviceKey(const std::wstring& serial, int pid) {
+    if (!serial.empty()) return serial;
+    wchar_t buf[16];
+    swprintf(buf, 16, L"PID_%x", pid);
+    return buf;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "DeviceStatus.h"
+
+// One published device table. Never modified once published: a reader
+// holding it sees the same devices and version however long it keeps it.
+struct DeviceSnapshot {
+    uint64_t version = 0;
+    std::vector<DeviceStatus> devices;
+};
+
+using DeviceSnapshotPtr = std::shared_ptr<const DeviceSnapshot>;
+
+// The current snapshot, replaced RCU-style: Store swaps in a new one with
+// std::atomic_store and Load takes a reference with std::atomic_load.
+// These are not lock-free: libstdc++ and MSVC guard them with a small
+// internal spinlock. Each side holds it only to copy one pointer and bump
+// a reference count, so a reader never waits while a table is built or a
+// writer while a table is read. The replaced snapshot is freed by whoever
+// drops the last reference to it.
+class DeviceSnapshotCell {
+public:
+    DeviceSnapshotPtr Load() const { return std::atomic_load(&current); }
+    void Store(DeviceSnapshotPtr next) { std::atomic_store(&current, std::move(next)); }
+
+private:
+    DeviceSnapshotPtr current = std::make_shared<const DeviceSnapshot>();
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DeviceIds.h"
+
+// Result of querying one device, detached from the RazerDevice that
+// produced it so it can be printed, cached or sent to other processes.
+struct DeviceStatus {
+    std::string serial;        // device key: serial, or PID_<hex> when unknown
+    int pid = 0;
+    RazerDeviceType type = RazerDeviceType::Unknown;
+    std::string name;
+    int level = -1;            // 0-100, -1 if unknown
+    bool charging = false;
+    uint32_t latencyMs = 0;    // time spent querying level + charging
+    std::string error;         // empty on success, else "timeout", "query_failed", "asleep", "unavailable" or "over_budget"
+    bool asleep = false;       // radio asleep: level/charging are the last reading
+    // From the poller's BatteryEstimator; -1 when there is no estimate
+    int secondsToEmpty = -1;   // while discharging
+    int secondsToFull = -1;    // while charging; 0 once full
+    int lowBatteryThreshold = -1; // device's own warning level (0x07/0x81), -1 unknown
+};
+
+const char* DeviceTypeName(RazerDeviceType type);
+
+// Appends {"serial":...,"pid":...,...} to `out`. Unknown level and
+// estimates are null.
+void AppendJson(std::string& out, const DeviceStatus& status);
+void AppendJson(std::string& out, const std::vector<DeviceStatus>& statuses);
+
+// Parses one line written by IpcServer: {"type":...,"version":...,"devices":[...]}.
+// The single "device" of an "alert" message is returned in `devices`.
+// Unknown keys are skipped. Returns false on malformed input.
+bool ParseStatusMessage(const std::string& json, std::string& type, uint64_t& version,
+                        std::vector<DeviceStatus>& devices);
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "DeviceSnapshot.h"
+#include "DeviceStatus.h"
+
+// Latest status of every device, as last queried. Consumers read the
+// published snapshot instead of talking to the hardware themselves; reading
+// it takes no lock and never holds up the publishing thread.
+class DeviceStatusStore {
+public:
+    using Listener = std::function<void(uint64_t version)>;
+
+    // Replaces the snapshot. The version is bumped and listeners run (on
+    // the caller's thread) only when something a consumer would show
+    // changed; latency alone does not count. Returns true on change.
+    bool Publish(std::vector<DeviceStatus> statuses);
+
+    // Never null; version 0 and no devices before the first Publish.
+    DeviceSnapshotPtr GetSnapshot() const { return current.Load(); }
+    uint64_t GetVersion() const { return current.Load()->version; }
+
+    // Listeners must not call Subscribe/Unsubscribe. Once Unsubscribe
+    // returns, the listener is not running and will not run again.
+    int Subscribe(Listener listener);
+    void Unsubscribe(int id);
+
+private:
+    std::mutex publishMutex;    // serializes publishers; readers never take it
+    DeviceSnapshotCell current;
+
+    std::mutex listenersMutex;
+    std::map<int, Listener> listeners;
+    int nextListenerId = 1;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "MappedFile.h"
+
+// Binary protocol event log. Fixed-size records are appended to a
+// preallocated memory-mapped file; when it fills up it is rotated to
+// "<path>.1", "<path>.2", ... Decode with RazerEventDecode.
+
+#define RAZER_EVENTLOG_MAGIC "RZEVLOG1"
+#define RAZER_EVENTLOG_VERSION 1
+
+enum class EventStrategy : uint8_t {
+    None = 0,
+    FeatureReport = 1,     // SET_REPORT/GET_REPORT on feature report 0
+    OutputInputReport = 2, // output report + input report fallback
+};
+
+#pragma pack(push, 1)
+
+struct EventLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;          // records the file can hold
+    uint64_t count;             // records written so far
+    int64_t wallClockBaseUs;    // system clock at creation (µs since epoch)
+    uint64_t monotonicBaseUs;   // EventLog::NowUs() at creation
+    uint8_t reserved[16];
+};
+
+struct ProtocolEvent {
+    uint64_t timestampUs;       // EventLog::NowUs() when the request was sent
+    char deviceKey[24];         // serial or PID_xxxx, NUL-padded
+    uint16_t pid;
+    int8_t interfaceNumber;
+    uint8_t strategy;           // EventStrategy
+    uint8_t transactionId;
+    uint8_t commandClass;
+    uint8_t commandId;
+    uint8_t status;             // response status byte (0x02 = success)
+    uint32_t latencyUs;
+    int16_t result;             // bytes transferred or libusb error code
+    uint8_t reserved[2];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(EventLogHeader) == 64, "EventLogHeader layout changed");
+static_assert(sizeof(ProtocolEvent) == 48, "ProtocolEvent layout changed");
+
+class EventLog {
+public:
+    static constexpr uint64_t DefaultCapacity = 65536; // 3 MB per generation
+    static constexpr int DefaultGenerations = 2;
+
+    static EventLog& Instance();
+
+    // Monotonic microseconds, shared by all event timestamps.
+    static uint64_t NowUs();
+
+    bool Open(const std::string& path, uint64_t capacity = DefaultCapacity,
+              int generations = DefaultGenerations);
+    void Close();
+
+    bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    void Append(const ProtocolEvent& event);
+
+private:
+    EventLog() = default;
+    ~EventLog();
+
+    bool CreateGeneration();
+    void Rotate();
+    void ShiftGenerations();
+    // A log at `path` that holds at least one record
+    static bool HasRecords(const std::string& path);
+
+    std::atomic<bool> enabled{false};
+    std::mutex mutex;
+    MappedFile file;
+    std::string path;
+    uint64_t capacity = 0;
+    int generations = 0;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class RazerDevice;
+
+// Why a device is being queried, most urgent first.
+enum class IoPriority : uint8_t {
+    Interactive,    // a tray or CLI asked for a refresh
+    Alert,          // re-query of a device near its low-battery threshold
+    Background,     // scheduled poll, device arrival/removal, follow-up
+};
+
+const char* IoPriorityName(IoPriority priority);
+
+// Status queries waiting to run, at most one per device: asking again for
+// a device that is already waiting raises its priority instead of adding
+// a second query. Taken one priority class at a time, most urgent first,
+// so queued background work is overtaken by anything a user is waiting
+// on. Not thread-safe: the poller's polling thread owns it.
+class DeviceIoQueue {
+public:
+    void Push(const std::shared_ptr<RazerDevice>& device, IoPriority priority);
+    // Every device waiting at the most urgent class present, in the order
+    // they were first queued; `priority` is set to that class.
+    std::vector<std::shared_ptr<RazerDevice>> PopTop(IoPriority& priority);
+    // Drops the devices not in `devices` (after a re-enumeration).
+    void Retain(const std::vector<std::shared_ptr<RazerDevice>>& devices);
+
+    bool Empty() const { return entries.empty(); }
+    size_t Size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        std::shared_ptr<RazerDevice> device;
+        IoPriority priority;
+    };
+    std::vector<Entry> entries; // first-queued order; a handful of devices
+};
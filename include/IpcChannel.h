@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include "LocalAccess.h"
+
+// Line-oriented byte stream to a local peer: a named pipe instance on
+// Windows, a Unix domain socket elsewhere. One thread may read while
+// another writes; Interrupt() wakes both and makes further I/O fail.
+class IpcChannel {
+public:
+    ~IpcChannel();
+
+    IpcChannel(const IpcChannel&) = delete;
+    IpcChannel& operator=(const IpcChannel&) = delete;
+
+    // Client side. Returns nullptr if nothing is listening on `endpoint`.
+    static std::unique_ptr<IpcChannel> Connect(const std::string& endpoint);
+
+    // Reads up to the next '\n' (not included). False on EOF, error or interrupt.
+    bool ReadLine(std::string& line);
+    // Writes `line` followed by '\n'.
+    bool WriteLine(const std::string& line);
+    void Interrupt();
+
+private:
+    friend class IpcListener;
+
+    static constexpr size_t MaxLineBytes = 64 * 1024;
+
+    std::string readBuffer;
+    std::atomic<bool> interrupted{false};
+#ifdef _WIN32
+    explicit IpcChannel(void* pipe, bool serverSide);
+    void* pipe = nullptr;
+    bool serverSide = false;
+    bool Transfer(bool write, void* data, unsigned long length, unsigned long& transferred);
+#else
+    explicit IpcChannel(int fd);
+    int fd = -1;
+#endif
+};
+
+// Accepts IpcChannel connections on a local endpoint.
+class IpcListener {
+public:
+    IpcListener() = default;
+    ~IpcListener();
+
+    IpcListener(const IpcListener&) = delete;
+    IpcListener& operator=(const IpcListener&) = delete;
+
+    // RAZER_IPC_ENDPOINT if set. Otherwise \\.\pipe\RazerBattery on
+    // Windows. Elsewhere /run/razerbattery.sock for a poller running as
+    // root (and for clients once it exists), else
+    // $XDG_RUNTIME_DIR/razerbattery.sock or /tmp/razerbattery-<uid>.sock.
+    static std::string DefaultEndpoint();
+
+    // Fails if another process is already serving `endpoint`.
+    bool Listen(const std::string& endpoint, LocalAccess access = LocalAccess::CurrentUser);
+    // Blocks until a client connects; nullptr after Interrupt() or on error.
+    std::unique_ptr<IpcChannel> Accept();
+    void Interrupt();
+    void Close();
+
+private:
+    std::string endpoint;
+    LocalAccess access = LocalAccess::CurrentUser;
+    std::atomic<bool> interrupted{false};
+#ifdef _WIN32
+    void* pendingPipe = nullptr; // instance created ahead of the next Accept
+    void* stopEvent = nullptr;
+    void* CreateInstance(bool first);
+#else
+    int fd = -1;
+#endif
+};
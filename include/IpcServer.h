@@ -0,0 +1,78 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeviceStatusStore.h"
+#include "IpcChannel.h"
+
+// Serves the DeviceStatusStore to local consumers so the devices are
+// queried once no matter how many programs want the data.
+//
+// Protocol: newline-delimited text. The client sends a command line, the
+// server answers with one JSON object per line.
+//   get        -> {"type":"snapshot","version":N,"devices":[...]}
+//   refresh    -> {"type":"refresh","accepted":true|false}; asks the owner
+//                 to re-query the devices (it may coalesce requests)
+//   subscribe  -> the snapshot above, then {"type":"changed",...} (same
+//                 shape) every time the store changes; a "changed" whose
+//                 version is not newer than the last one seen can be ignored,
+//                 and any event the owner broadcasts, e.g.
+//                 {"type":"alert","kind":"low_battery","threshold":N,"device":{...}}
+// Anything else gets {"type":"error","message":"..."}.
+class IpcServer {
+public:
+    explicit IpcServer(DeviceStatusStore& store);
+    ~IpcServer();
+
+    bool Start(const std::string& endpoint = IpcListener::DefaultEndpoint(),
+               LocalAccess access = LocalAccess::CurrentUser);
+    void Stop();
+
+    // Handles "refresh"; returns whether the request was accepted. Set
+    // before Start. Without a handler every refresh is declined.
+    void SetRefreshHandler(std::function<bool()> handler) { refreshHandler = std::move(handler); }
+
+    // Sends one JSON line to every subscriber.
+    void Broadcast(const std::string& message);
+
+    size_t GetClientCount();
+
+private:
+    struct Client {
+        std::unique_ptr<IpcChannel> channel;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::string> outbox;
+        bool subscribed = false;
+        bool closed = false;
+        std::thread reader;
+        std::thread writer;
+    };
+
+    // Subscribers that fall this far behind are disconnected
+    static constexpr size_t MaxQueuedMessages = 64;
+
+    void AcceptLoop();
+    void ReadLoop(Client* client);
+    void WriteLoop(Client* client);
+    void Enqueue(Client& client, std::string message);
+    void CloseClient(Client& client);
+    void ReapClosedClients();
+    void OnStoreChanged();
+    std::string SnapshotMessage(const char* type);
+
+    DeviceStatusStore& store;
+    std::function<bool()> refreshHandler;
+    IpcListener listener;
+    std::thread acceptThread;
+    int subscription = 0;
+    bool running = false;
+
+    std::mutex clientsMutex;
+    std::vector<std::unique_ptr<Client>> clients;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <memory>
+#include "UsbBackend.h"
+
+struct libusb_context;
+class LibusbEventThread;
+
+// UsbBackend on top of libusb-1.0.
+class LibusbBackend : public UsbBackend {
+public:
+    LibusbBackend();
+    ~LibusbBackend() override;
+
+    bool IsAvailable() const override { return ctx != nullptr; }
+    std::vector<std::shared_ptr<UsbDevice>> ListDevices() override;
+
+private:
+    libusb_context* ctx;
+    // Runs the event loop for interrupt listeners (UsbDeviceHandle::StartListening)
+    std::unique_ptr<LibusbEventThread> events;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+// Who may open the endpoints and shared memory the app exposes. A poller
+// running as a service serves every session on the machine; anything run
+// per user keeps the default of owner-only access.
+enum class LocalAccess { CurrentUser, AllUsers };
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sddl.h>
+
+// Security attributes for a named pipe or section created with `access`.
+// CurrentUser yields NULL, i.e. the creator's default DACL.
+class LocalSecurityAttributes {
+public:
+    // Pipes: authenticated users may read and write but not create
+    // instances (no squatting). Sections: authenticated users may map
+    // read-only. SYSTEM and administrators keep full control.
+    LocalSecurityAttributes(LocalAccess access, bool pipe) {
+        if (access != LocalAccess::AllUsers) return;
+        const wchar_t* sddl = pipe ? L"D:(A;;GA;;;SY)(A;;GA;;;BA)(A;;0x12018b;;;AU)"
+                                   : L"D:(A;;GA;;;SY)(A;;GA;;;BA)(A;;GR;;;AU)";
+        if (ConvertStringSecurityDescriptorToSecurityDescriptorW(sddl, SDDL_REVISION_1, &descriptor, NULL)) {
+            attributes.nLength = sizeof(attributes);
+            attributes.lpSecurityDescriptor = descriptor;
+            attributes.bInheritHandle = FALSE;
+        }
+    }
+
+    ~LocalSecurityAttributes() {
+        if (descriptor) LocalFree(descriptor);
+    }
+
+    LocalSecurityAttributes(const LocalSecurityAttributes&) = delete;
+    LocalSecurityAttributes& operator=(const LocalSecurityAttributes&) = delete;
+
+    SECURITY_ATTRIBUTES* Get() { return descriptor ? &attributes : NULL; }
+
+private:
+    PSECURITY_DESCRIPTOR descriptor = NULL;
+    SECURITY_ATTRIBUTES attributes = {};
+};
+#endif
@@ -1,22 +1,185 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <mutex>
-#include <sstream>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <chrono>
 #include <ctime>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <ios>
+#include <type_traits>
+
+enum class LogLevel : int { Debug = 0, Info = 1, Error = 2, Off = 3 };
+
+// Statements below this level are compiled out entirely (the discarded
+// branch is still type-checked so it cannot bit-rot).
+#ifndef RAZER_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define RAZER_LOG_MIN_LEVEL 1 // Info
+#else
+#define RAZER_LOG_MIN_LEVEL 0 // Debug
+#endif
+#endif
+
+// Fixed-size, stack-allocated formatter. Supports the subset of ostream
+// syntax used by the LOG_* call sites (strings, numbers, pointers,
+// std::hex/std::dec) without touching iostreams or the heap.
+class LogLine {
+public:
+    static constexpr size_t Capacity = 512;
+
+    std::string_view View() const { return std::string_view(buf, len); }
+
+    LogLine& operator<<(std::string_view s) {
+        Append(s.data(), s.size());
+        return *this;
+    }
+    LogLine& operator<<(const char* s) { return *this << std::string_view(s ? s : "(null)"); }
+    LogLine& operator<<(const std::string& s) { return *this << std::string_view(s); }
+    LogLine& operator<<(char c) { Append(&c, 1); return *this; }
+    LogLine& operator<<(bool b) { return *this << (b ? "true" : "false"); }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value &&
+                                                  !std::is_same<T, bool>::value &&
+                                                  !std::is_same<T, char>::value, int>::type = 0>
+    LogLine& operator<<(T value) {
+        auto r = std::to_chars(buf + len, buf + Capacity, value, hex ? 16 : 10);
+        if (r.ec == std::errc()) len = static_cast<size_t>(r.ptr - buf);
+        return *this;
+    }
+
+    LogLine& operator<<(double value) {
+        auto r = std::to_chars(buf + len, buf + Capacity, value, std::chars_format::fixed, 2);
+        if (r.ec == std::errc()) len = static_cast<size_t>(r.ptr - buf);
+        return *this;
+    }
+
+    template <typename T, typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value, int>::type = 0>
+    LogLine& operator<<(T* ptr) {
+        *this << "0x";
+        auto r = std::to_chars(buf + len, buf + Capacity, reinterpret_cast<uintptr_t>(ptr), 16);
+        if (r.ec == std::errc()) len = static_cast<size_t>(r.ptr - buf);
+        return *this;
+    }
+
+    // std::hex / std::dec
+    LogLine& operator<<(std::ios_base& (*manip)(std::ios_base&)) {
+        if (manip == static_cast<std::ios_base& (*)(std::ios_base&)>(std::hex)) hex = true;
+        if (manip == static_cast<std::ios_base& (*)(std::ios_base&)>(std::dec)) hex = false;
+        return *this;
+    }
+
+private:
+    char buf[Capacity];
+    size_t len = 0;
+    bool hex = false;
+
+    void Append(const char* s, size_t n) {
+        size_t room = Capacity - len;
+        if (n > room) n = room;
+        memcpy(buf + len, s, n);
+        len += n;
+    }
+};
+
+// Rotation of RazerBatteryTray.log. The active file is rotated once it
+// would exceed maxFileBytes or is older than maxAge; rotated generations
+// are named .1 (newest) to .N and optionally gzip-compressed. The oldest
+// generations are deleted so that all files together never exceed
+// maxTotalBytes.
+struct LogRotationPolicy {
+    uint64_t maxFileBytes = 1024 * 1024;
+    uint64_t maxTotalBytes = 8 * 1024 * 1024;
+    int generations = 5;
+    std::chrono::hours maxAge{24 * 7};
+    bool compress = true; // ignored when built without zlib
+};
 
 class Logger {
 public:
     static Logger& Instance();
-    void Log(const std::string& level, const std::string& message);
+
+    // Cheap runtime filter, checked before any formatting happens.
+    static bool IsEnabled(LogLevel level) {
+        return static_cast<int>(level) >= runtimeLevel.load(std::memory_order_relaxed);
+    }
+    static void SetLevel(LogLevel level) { runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+    static LogLevel GetLevel() { return static_cast<LogLevel>(runtimeLevel.load(std::memory_order_relaxed)); }
+    static LogLevel ParseLevel(std::string_view name, LogLevel fallback);
+
+    // File name used instead of RazerBatteryTray.log; only effective
+    // before the first Instance() call (the writer opens it right away).
+    static void SetFileName(const std::string& name);
+
+    // Queues the message for the writer thread; never waits for file I/O.
+    void Log(LogLevel level, std::string_view message);
+
+    void SetRotationPolicy(const LogRotationPolicy& policy);
+
+    // Directory the log ended up in (cwd or the temp fallback); other
+    // diagnostics files are placed next to it. Waits for the writer
+    // thread to open the file.
+    std::string GetDirectory();
+
+    // Messages discarded because the writer fell behind.
+    uint64_t GetDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
 
 private:
     Logger();
     ~Logger();
+
+    struct Entry {
+        std::time_t time;
+        LogLevel level;
+        std::string message;
+    };
+
+    static constexpr size_t MaxQueuedEntries = 8192;
+
+    void WriterThread();
+    bool OpenLogFile();
+    void WriteEntry(const Entry& entry);
+    void RotateIfNeeded(size_t nextLineBytes);
+    void Rotate();
+    void CompressGeneration(const std::string& path);
+    void EnforceTotalCap();
+    std::string GenerationPath(int index, bool compressed) const;
+
+    std::string logPath;
     std::ofstream logFile;
-    std::mutex logMutex;
+    uint64_t fileBytes = 0;
+    std::chrono::system_clock::time_point fileOpened;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::condition_variable openedCv;
+    std::vector<Entry> queue;
+    LogRotationPolicy policy;
+    bool opened = false;
+    bool stopping = false;
+    std::atomic<uint64_t> dropped{0};
+    std::thread writer;
+
+    // Initialised from RAZER_LOG_LEVEL (debug|info|error|off), default Info.
+    static std::atomic<int> runtimeLevel;
 };
 
-#define LOG_INFO(msg) { std::ostringstream oss; oss << msg; Logger::Instance().Log("INFO", oss.str()); }
-#define LOG_ERROR(msg) { std::ostringstream oss; oss << msg; Logger::Instance().Log("ERROR", oss.str()); }
-#define LOG_DEBUG(msg) { std::ostringstream oss; oss << msg; Logger::Instance().Log("DEBUG", oss.str()); }
+#define RAZER_LOG(level, msg) do { \
+    if constexpr (static_cast<int>(level) >= RAZER_LOG_MIN_LEVEL) { \
+        if (Logger::IsEnabled(level)) { \
+            LogLine logLine_; \
+            logLine_ << msg; \
+            Logger::Instance().Log(level, logLine_.View()); \
+        } \
+    } \
+} while (0)
+
+#define LOG_INFO(msg) RAZER_LOG(LogLevel::Info, msg)
+#define LOG_ERROR(msg) RAZER_LOG(LogLevel::Error, msg)
+#define LOG_DEBUG(msg) RAZER_LOG(LogLevel::Debug, msg)
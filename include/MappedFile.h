@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "LocalAccess.h"
+
+// Thin RAII wrapper over a memory-mapped file (CreateFileMapping on
+// Windows, mmap elsewhere). The mapping always covers the whole file.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Creates (or truncates) the file, preallocates `size` bytes and maps it read-write.
+    bool Create(const std::string& path, size_t size);
+    // Maps an existing file read-write, keeping its current contents.
+    bool OpenExisting(const std::string& path);
+    // Maps an existing file read-only.
+    bool OpenReadOnly(const std::string& path);
+
+    // Named shared memory not backed by a file: a pagefile-backed section
+    // on Windows (e.g. "Local\\Name"), a POSIX shm object elsewhere
+    // (e.g. "/name"). CreateShared reuses an existing segment of that name.
+    bool CreateShared(const std::string& name, size_t size, LocalAccess access = LocalAccess::CurrentUser);
+    bool OpenSharedReadOnly(const std::string& name);
+    // Removes the name so new readers cannot open it (no-op on Windows,
+    // where the section goes away with its last handle).
+    static void RemoveShared(const std::string& name);
+
+    void Flush();
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    uint8_t* Data() const { return static_cast<uint8_t*>(data); }
+    size_t Size() const { return size; }
+
+private:
+    void* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    bool Map(const std::string& path, size_t createSize, bool create, bool writable);
+    bool MapShared(const std::string& name, size_t createSize, bool create, LocalAccess access);
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "RadioBudget.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Log-linear latency histogram in microseconds: 8 linear sub-buckets per
+// power of two, from 1 µs up to ~67 s (larger values land in the last
+// bucket). Recording a sample is a single relaxed atomic increment.
+class LatencyHistogram {
+public:
+    static constexpr int SubBucketBits = 3;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int MaxExponent = 26;
+    static constexpr int BucketCount = (MaxExponent - SubBucketBits + 1) * SubBuckets;
+
+    struct Snapshot {
+        std::array<uint64_t, BucketCount> counts{};
+
+        uint64_t Count() const;
+        // Upper bound (µs) of the bucket holding the p-th quantile, p in [0, 1].
+        uint64_t Percentile(double p) const;
+        void Merge(const Snapshot& other);
+    };
+
+    static int BucketFor(uint64_t us) {
+        if (us < SubBuckets) return static_cast<int>(us);
+        int msb = HighestBit(us);
+        if (msb >= MaxExponent) return BucketCount - 1;
+        int shift = msb - SubBucketBits;
+        return (shift + 1) * SubBuckets + static_cast<int>((us >> shift) & (SubBuckets - 1));
+    }
+    static int HighestBit(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+    static uint64_t BucketLowerBound(int bucket);
+    static uint64_t BucketUpperBound(int bucket);
+
+    void Record(uint64_t us) { buckets[BucketFor(us)].fetch_add(1, std::memory_order_relaxed); }
+    Snapshot Read() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> buckets{};
+};
+
+// Per-device query outcomes. Query count is the latency histogram's count.
+struct DeviceMetrics {
+    std::atomic<uint64_t> batteryFailures{0};
+    std::atomic<uint64_t> tidFallbacks{0};      // answered only on a non-default transaction ID
+    std::atomic<uint64_t> commandFallbacks{0};  // answered only by the 0x0F/0x02 query
+    std::atomic<uint64_t> chargingFailures{0};
+    std::atomic<uint64_t> lastBatterySuccessUs{0}; // EventLog::NowUs() of the last answer, 0 = never
+    // Answers from a device quiet for longer than its idle time, i.e.
+    // queries that probably woke its radio; in total and for one UTC day
+    std::atomic<uint64_t> radioWakeups{0};
+    std::atomic<int64_t> wakeupDay{-1};             // days since epoch of wakeupsOnDay
+    std::atomic<uint64_t> wakeupsOnDay{0};
+    // Control transfers sent to the device (each half of a report exchange
+    // counts) and the bytes they moved; in total and for one UTC day
+    std::atomic<uint64_t> controlTransfers{0};
+    std::atomic<uint64_t> transferBytes{0};
+    std::atomic<int64_t> trafficDay{-1};            // days since epoch of the *OnDay counts
+    std::atomic<uint64_t> transfersOnDay{0};
+    std::atomic<uint64_t> bytesOnDay{0};
+    std::atomic<uint64_t> transferBudget{0};        // daily limit, 0 = none (RadioBudget)
+    std::atomic<uint64_t> overBudgetReads{0};       // statuses served from cache over budget
+    std::atomic<uint64_t> asleepReads{0};           // statuses served from cache while asleep
+    // Interrupt-endpoint reports: decoded notifications, and anything else
+    std::atomic<uint64_t> notifications{0};
+    std::atomic<uint64_t> ignoredReports{0};
+    std::atomic<uint64_t> breakerTrips{0};          // a command's circuit breaker opened
+    std::atomic<uint64_t> skippedQueries{0};        // commands skipped while their breaker was open
+    // RazerDevice::QueryStatus cache: fresh hits, stale hits served while
+    // another caller revalidated, queries that went to the device, and
+    // callers that joined one in flight
+    std::atomic<uint64_t> cacheHits{0};
+    std::atomic<uint64_t> staleHits{0};
+    std::atomic<uint64_t> cacheMisses{0};
+    std::atomic<uint64_t> coalesced{0};
+    LatencyHistogram batteryLatency;
+    LatencyHistogram chargingLatency;
+    LatencyHistogram cacheAge;                      // age of each status served from cache
+
+    // Single writer (the device's polling thread)
+    void RecordWakeup(int64_t day) {
+        radioWakeups.fetch_add(1, std::memory_order_relaxed);
+        if (wakeupDay.load(std::memory_order_relaxed) != day) {
+            wakeupsOnDay.store(0, std::memory_order_relaxed);
+            wakeupDay.store(day, std::memory_order_relaxed);
+        }
+        wakeupsOnDay.fetch_add(1, std::memory_order_relaxed);
+    }
+    void RecordTransfer(int64_t day, uint64_t bytes) {
+        controlTransfers.fetch_add(1, std::memory_order_relaxed);
+        transferBytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (trafficDay.load(std::memory_order_relaxed) != day) {
+            transfersOnDay.store(0, std::memory_order_relaxed);
+            bytesOnDay.store(0, std::memory_order_relaxed);
+            trafficDay.store(day, std::memory_order_relaxed);
+        }
+        transfersOnDay.fetch_add(1, std::memory_order_relaxed);
+        bytesOnDay.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    uint64_t TransfersOn(int64_t day) const {
+        return trafficDay.load(std::memory_order_relaxed) == day ? transfersOnDay.load(std::memory_order_relaxed) : 0;
+    }
+};
+
+// One (interface, strategy, transaction ID, command) combination as tried
+// by RazerDevice::SendRequest. Attempt count is the histogram's count.
+struct ProtocolMetrics {
+    std::atomic<uint64_t> successes{0};
+    LatencyHistogram latency;
+};
+
+struct DeviceMetricsSnapshot {
+    std::string key;
+    uint64_t batteryQueries = 0;
+    uint64_t batteryFailures = 0;
+    uint64_t tidFallbacks = 0;
+    uint64_t commandFallbacks = 0;
+    uint64_t chargingQueries = 0;
+    uint64_t chargingFailures = 0;
+    uint64_t lastBatterySuccessUs = 0;
+    uint64_t radioWakeups = 0;
+    uint64_t wakeupsToday = 0;      // UTC day of the snapshot
+    uint64_t controlTransfers = 0;
+    uint64_t transferBytes = 0;
+    uint64_t transfersToday = 0;
+    uint64_t bytesToday = 0;
+    uint64_t transferBudget = 0;
+    RadioBudgetState budgetState = RadioBudgetState::Normal; // at the time of the snapshot
+    uint64_t overBudgetReads = 0;
+    uint64_t asleepReads = 0;
+    uint64_t notifications = 0;
+    uint64_t ignoredReports = 0;
+    uint64_t breakerTrips = 0;
+    uint64_t skippedQueries = 0;
+    uint64_t cacheHits = 0;
+    uint64_t staleHits = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t coalesced = 0;
+    LatencyHistogram::Snapshot batteryLatency;
+    LatencyHistogram::Snapshot chargingLatency;
+    LatencyHistogram::Snapshot cacheAge;
+
+    // Share of QueryStatus calls answered without a device query of their
+    // own; 0 before the first call
+    double CacheHitRatio() const {
+        uint64_t served = cacheHits + staleHits + coalesced;
+        uint64_t total = served + cacheMisses;
+        return total ? static_cast<double>(served) / static_cast<double>(total) : 0;
+    }
+};
+
+struct ProtocolMetricsSnapshot {
+    int interfaceNumber = 0;
+    uint8_t strategy = 0;
+    uint8_t transactionId = 0;
+    uint8_t commandClass = 0;
+    uint8_t commandId = 0;
+    uint64_t attempts = 0;
+    uint64_t successes = 0;
+    LatencyHistogram::Snapshot latency;
+};
+
+struct MetricsSnapshot {
+    std::vector<DeviceMetricsSnapshot> devices;
+    std::vector<ProtocolMetricsSnapshot> protocol;
+};
+
+// Process-wide, lock-free metrics tables. Entries are claimed with a CAS on
+// first use and never removed, so returned pointers stay valid for the
+// lifetime of the process; callers should cache them. When a table is
+// full, lookups fall back to a shared overflow entry.
+class MetricsRegistry {
+public:
+    static constexpr size_t MaxDevices = 64;
+    static constexpr size_t MaxProtocolEntries = 512;
+    static constexpr size_t MaxKeyLength = 31;
+
+    static MetricsRegistry& Instance();
+
+    DeviceMetrics& ForDevice(std::string_view key);
+    ProtocolMetrics& ForProtocol(int interfaceNumber, uint8_t strategy, uint8_t transactionId,
+                                 uint8_t commandClass, uint8_t commandId);
+
+    MetricsSnapshot Snapshot() const;
+    void DumpToLog() const;
+
+private:
+    MetricsRegistry() = default;
+
+    struct DeviceSlot {
+        std::atomic<uint64_t> hash{0};     // 0 = free
+        std::atomic<bool> ready{false};    // key text written
+        char key[MaxKeyLength + 1] = {};
+        DeviceMetrics metrics;
+    };
+    struct ProtocolSlot {
+        std::atomic<uint64_t> key{0};      // packed combination + 1; 0 = free
+        ProtocolMetrics metrics;
+    };
+
+    std::array<DeviceSlot, MaxDevices> devices;
+    DeviceMetrics deviceOverflow;
+    std::array<ProtocolSlot, MaxProtocolEntries> protocol;
+    ProtocolMetrics protocolOverflow;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeviceStatus.h"
+#include "DeviceStatusStore.h"
+#include "Metrics.h"
+
+// Renders the Prometheus text exposition format (0.0.4) for `devices`,
+// joined by key with the query metrics in `metrics`:
+//   razer_battery_level_percent, razer_battery_charging, razer_device_up,
+//   razer_battery_last_success_age_seconds, razer_battery_query_duration_seconds
+//   (histogram), razer_battery_query_failures_total, ...
+// each labelled {serial, pid, type}. `nowUs` is EventLog::NowUs().
+void FormatPrometheusMetrics(std::string& out, const std::vector<DeviceStatus>& devices,
+                             uint64_t version, const MetricsSnapshot& metrics, uint64_t nowUs);
+
+// Minimal HTTP/1.0 listener on 127.0.0.1 serving GET /metrics. Each scrape
+// copies the store and the metrics tables and never touches a device, so
+// its cost does not depend on how slow the devices are. Connections are
+// handled one at a time on the listener's thread.
+class MetricsHttpServer {
+public:
+    explicit MetricsHttpServer(DeviceStatusStore& store);
+    ~MetricsHttpServer();
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    // Port 0 picks a free one (see GetPort). Fails if the port is taken.
+    bool Start(uint16_t port);
+    void Stop();
+
+    uint16_t GetPort() const { return port; }
+    uint64_t GetScrapeCount() const { return scrapes.load(std::memory_order_relaxed); }
+
+private:
+    // Requests larger than this, or slower than ReceiveTimeoutMs, are dropped
+    static constexpr size_t MaxRequestBytes = 8 * 1024;
+    static constexpr int ReceiveTimeoutMs = 2000;
+
+    void AcceptLoop();
+    void Serve(intptr_t client);
+
+    DeviceStatusStore& store;
+    intptr_t listenFd = -1; // SOCKET on Windows
+    uint16_t port = 0;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> scrapes{0};
+    std::thread thread;
+};
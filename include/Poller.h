@@ -0,0 +1,193 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include "BatteryAlerts.h"
+#include "BatteryEstimator.h"
+#include "BatteryHistory.h"
+#include "DeviceStatusStore.h"
+#include "IoQueue.h"
+#include "IpcServer.h"
+#include "Metrics.h"
+#include "MetricsHttpServer.h"
+#include "PowerState.h"
+#include "RazerManager.h"
+#include "SharedStatusWriter.h"
+#include "UsbBackend.h"
+#include "WorkPool.h"
+
+struct PollerOptions {
+    std::string endpoint = IpcListener::DefaultEndpoint();
+    std::string sharedStatusName = DefaultSharedStatusName();
+    // AllUsers when one poller serves every session (service / root daemon)
+    LocalAccess access = LocalAccess::AllUsers;
+    std::chrono::milliseconds refreshInterval{5 * 60 * 1000};
+    // Client refresh requests are deferred until this long after the last
+    // refresh and merged, so N sessions asking cost the same USB traffic as
+    // one. With interactiveFirst, only earlier requests count.
+    std::chrono::milliseconds minRequestInterval{2 * 1000};
+    // Device arrival/removal notifications come in bursts; wait this long
+    // after the last one before enumerating.
+    std::chrono::milliseconds enumerateDelay{500};
+    // A device discharging within a few points of its low-battery threshold
+    // is re-queried on its own this often, so the alert is not up to a
+    // whole refreshInterval late; the other devices keep their schedule.
+    std::chrono::milliseconds nearThresholdInterval{60 * 1000};
+    // Probe devices that are probably asleep instead of querying them, and
+    // serve their last reading while they sleep (RazerDevice::QueryStatus).
+    bool idleAware = true;
+    // Devices opened and queried at once (WorkPool). Each probe mostly
+    // waits on its receiver, so a refresh takes about as long as the
+    // slowest device rather than the sum; 1 queries them in turn.
+    size_t probeConcurrency = WorkPool::DefaultConcurrency;
+    // Hard bound on one refresh's USB I/O, enumeration included. Each
+    // transfer waits at most what is left of it; devices it cuts short
+    // report their last reading with error "timeout" and are retried by
+    // one follow-up refresh minRequestInterval later.
+    std::chrono::milliseconds refreshBudget{1500};
+    // Client requests go ahead of background work (DeviceIoQueue). They
+    // are spaced only from earlier requests, since a scheduled poll that
+    // just ran left its readings in the status cache, and one that falls
+    // due while a background or alert batch is querying cancels that
+    // batch: transfers not yet started are skipped, and the devices it had
+    // not finished are queued again behind the request. false queues
+    // requests behind background work like any other refresh.
+    bool interactiveFirst = true;
+    // Control transfers each device may be sent per UTC day (RadioBudget);
+    // 0 leaves traffic unaccounted against any limit. A device running
+    // ahead of the day's pace is left out of scheduled and near-threshold
+    // polls until overBudgetInterval has passed since its last query;
+    // client requests and device changes still reach it. Once the day's
+    // allowance is spent, the device is served from its last reading with
+    // error "over_budget" and sent nothing until 00:00 UTC.
+    uint64_t dailyTransferBudget = 0;
+    std::chrono::milliseconds overBudgetInterval{30 * 60 * 1000};
+    // Listen for each device's own battery, charging and link
+    // notifications on its interrupt endpoint (RazerDevice::StartListening)
+    // and publish every one at once. Scheduled and near-threshold polls of
+    // a device that has sent one come only every listeningRefreshInterval,
+    // as a fallback; a device that reconnects is queried right away. Off by
+    // default: the notification format is a placeholder (DeviceEvents.h).
+    bool listenForEvents = false;
+    std::chrono::milliseconds listeningRefreshInterval{30 * 60 * 1000};
+    // While it reports the system suspended, the display off, the lid
+    // closed or battery saver on, no USB I/O is done at all; when that
+    // ends, one enumerate + refresh runs enumerateDelay later, absorbing
+    // the device notifications a resume produces. nullptr: always active.
+    std::shared_ptr<PowerEventSource> powerSource;
+    // Prometheus /metrics on 127.0.0.1; 0 leaves the listener off.
+    uint16_t metricsPort = 0;
+    // Every reading is appended to a per-device BatteryHistory file here;
+    // empty keeps no history.
+    std::string historyDirectory;
+};
+
+// The one process that talks to the hardware. Owns RazerManager, refreshes
+// on a schedule and on device changes, and publishes the results to the
+// IPC endpoint, the shared-memory table and optionally /metrics; per-session
+// tray clients only render what it publishes. Low-battery alerts are
+// broadcast to IPC subscribers as {"type":"alert",...}.
+class Poller {
+public:
+    Poller(std::shared_ptr<UsbBackend> backend, PollerOptions options = PollerOptions());
+    ~Poller();
+
+    // Starts serving and the polling thread; the first enumeration runs
+    // on that thread. Fails if another poller owns the endpoint.
+    bool Start();
+    void Stop();
+
+    // Device arrival/removal (debounced by enumerateDelay).
+    void RequestEnumerate();
+    // Client request: enumerate and re-query soon (see minRequestInterval).
+    // Returns false only when the poller is not running.
+    bool RequestRefresh();
+
+    DeviceStatusStore& GetStore() { return store; }
+    // Query batches run, of any priority
+    uint64_t GetRefreshCount() const;
+    // Batches cancelled for an interactive request
+    uint64_t GetPreemptionCount() const;
+    // Device notifications published
+    uint64_t GetNotificationCount() const;
+    // From the first client request of a refresh to its table being published
+    LatencyHistogram::Snapshot GetInteractiveLatency() const { return interactiveLatency.Read(); }
+    bool IsPaused() const;
+
+    // Time-left estimator settings for these options: the longest a device
+    // can go between polls is not a gap to splice out
+    static BatteryEstimator::Options EstimatorOptions(const PollerOptions& options);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Run();
+    void OnPowerEvent(PowerEvent event);
+    // Queries one batch taken from the queue and merges the results into
+    // the published table; devices outside the batch stand as published.
+    void Refresh(IoPriority priority, std::vector<std::shared_ptr<RazerDevice>> targets,
+                 const Deadline& deadline);
+    // Publishes statuses of some devices: history, estimates, alerts and the
+    // table merge. The rest stand as last published.
+    void Publish(const std::vector<std::shared_ptr<RazerDevice>>& targets, std::vector<DeviceStatus> statuses);
+    struct Notification {
+        std::weak_ptr<RazerDevice> device;
+        DeviceEventKind kind;
+        DeviceStatus status;
+    };
+    void ApplyNotifications(std::vector<Notification> arrived);
+    void Listen(const std::shared_ptr<RazerDevice>& device);
+    // Left out of scheduled polls: a device that notifies for itself until
+    // listeningRefreshInterval, one ahead of its transfer budget's pace
+    // until overBudgetInterval has passed since its last query
+    bool Deferred(RazerDevice& device, Clock::time_point now);
+
+    struct PublishedStatus {
+        std::weak_ptr<RazerDevice> device; // expired once the manager dropped it
+        DeviceStatus status;
+    };
+
+    PollerOptions options;
+    WorkPool probes;
+    RazerManager manager;
+    DeviceStatusStore store;
+    IpcServer ipc;
+    MetricsHttpServer metrics;
+    SharedStatusWriter shared;
+    int sharedSubscription = 0;
+    BatteryHistoryStore history; // polling thread only
+    BatteryEstimatorSet estimators; // polling thread only
+    BatteryAlertEngine alerts;      // polling thread only
+    std::set<const RazerDevice*> nearDevices; // polling thread only
+    bool followingUpCut = false;    // polling thread only
+    DeviceIoQueue queue;            // polling thread only
+    std::map<const RazerDevice*, PublishedStatus> published; // polling thread only
+    Clock::time_point interactiveRequestedAt; // polling thread only
+    std::map<const RazerDevice*, Clock::time_point> lastQueried; // polling thread only
+    LatencyHistogram interactiveLatency;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::thread thread;
+    bool stopping = true;
+    PowerState power;
+    bool pending = true;        // enumerate + query every device at pendingAt
+    IoPriority pendingPriority = IoPriority::Background;
+    Clock::time_point pendingAt;
+    Clock::time_point requestedAt;  // first client request of the pending refresh
+    Clock::time_point lastRefresh;
+    Clock::time_point lastNearRefresh;
+    Clock::time_point lastInteractive;
+    bool batchRunning = false;
+    IoPriority batchPriority = IoPriority::Background;
+    Deadline batchDeadline;     // cancelled to preempt the running batch
+    uint64_t refreshCount = 0;
+    uint64_t preemptionCount = 0;
+    std::vector<Notification> notifications; // from event threads, not yet published
+    uint64_t notificationCount = 0;
+};
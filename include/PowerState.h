@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// System power notifications the poller reacts to.
+enum class PowerEvent : uint8_t {
+    Suspend,        // system going to sleep (PBT_APMSUSPEND, logind PrepareForSleep(true))
+    Resume,         // back from sleep (PBT_APMRESUME*, PrepareForSleep(false))
+    DisplayOff,     // GUID_CONSOLE_DISPLAY_STATE 0; dimmed counts as on
+    DisplayOn,
+    LidClosed,      // GUID_LIDSWITCH_STATE_CHANGE
+    LidOpened,
+    SaverOn,        // GUID_POWER_SAVING_STATUS (battery saver)
+    SaverOff,
+};
+
+const char* PowerEventName(PowerEvent event);
+
+// What the notifications received so far add up to. Nobody is looking at
+// the tray while any of these holds, so the poller does no I/O.
+struct PowerState {
+    bool suspended = false;
+    bool displayOff = false;
+    bool lidClosed = false;
+    bool batterySaver = false;
+
+    void Apply(PowerEvent event);
+    bool IsIdle() const { return suspended || displayOff || lidClosed || batterySaver; }
+};
+
+// Pluggable origin of PowerEvents. Start delivers events to `sink` (on any
+// thread) until Stop.
+class PowerEventSource {
+public:
+    using Sink = std::function<void(PowerEvent)>;
+
+    virtual ~PowerEventSource() = default;
+    virtual bool Start(Sink sink) = 0;
+    virtual void Stop() = 0;
+};
+
+// Events pushed by hand. The Linux poller feeds one from its signal loop
+// (SIGUSR1/SIGUSR2 sent by a systemd-sleep hook stand in for logind's
+// PrepareForSleep), and harnesses use it as a fake OS.
+class ManualPowerSource : public PowerEventSource {
+public:
+    bool Start(Sink sink) override;
+    void Stop() override;
+    // Dropped while not started.
+    void Emit(PowerEvent event);
+
+private:
+    std::mutex mutex;
+    Sink sink;
+};
+
+// The platform's native source: on Windows a hidden window receiving
+// WM_POWERBROADCAST and RegisterPowerSettingNotification updates for the
+// display, lid and battery-saver settings. nullptr where there is none.
+std::unique_ptr<PowerEventSource> CreateSystemPowerSource();
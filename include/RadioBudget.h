@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+enum class RadioBudgetState : uint8_t {
+    Normal,     // within the day's pace
+    Stretched,  // ahead of pace: scheduled polls come less often
+    Exhausted,  // the day's transfers are spent: statuses come from cache only
+};
+
+const char* RadioBudgetStateName(RadioBudgetState state);
+
+// A device's daily allowance of control transfers, per UTC day. Spent
+// evenly, it allows dailyTransfers * (time since 00:00 UTC) / 24 h by any
+// point of the day. A device that has used more than that, plus a head
+// start of headStartSeconds worth, is running ahead of pace; one that has
+// used the whole allowance stays Exhausted until 00:00 UTC.
+struct RadioBudget {
+    uint64_t dailyTransfers = 0;    // 0 = unlimited
+    int64_t headStartSeconds = 3600;
+
+    RadioBudgetState StateAt(uint64_t usedToday, int64_t secondsIntoDay) const;
+};
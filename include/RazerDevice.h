@@ -1,44 +1,209 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <string>
-#include <windows.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "CircuitBreaker.h"
+#include "Deadline.h"
+#include "DeviceEvents.h"
+#include "RadioBudget.h"
 #include "DeviceIds.h"
 #include "RazerProtocol.h"
+#include "UsbBackend.h"
+#include "DeviceStatus.h"
+#include "EventLog.h"
 
-struct libusb_device;
-struct libusb_device_handle;
+struct DeviceMetrics;
 
 class RazerDevice {
 public:
-    RazerDevice(struct libusb_device* device, int pid);
+    RazerDevice(std::shared_ptr<UsbDevice> device, int pid, unsigned int responseDelayMs = 50);
     ~RazerDevice();
 
     bool Open();
     void Close();
 
-    // Returns 0-100, or -1 if unknown/error.
+    // Bounds every transfer from now on (see Deadline); the default is
+    // unlimited. Calls cut short by it return what they have without
+    // blaming the device: no breaker failure, no cached fallback serial.
+    void SetDeadline(const Deadline& budget) { deadline = budget; }
+
+    // Daily allowance of control transfers (RadioBudget; 0 = unlimited).
+    // Transfers are counted per device key, so the count carries over a
+    // re-enumeration. Once the day's allowance is spent, QueryStatus sends
+    // nothing until 00:00 UTC and serves the last reading with error
+    // "over_budget".
+    void SetDailyTransferBudget(uint64_t transfers) { transferBudget.store(transfers); }
+    // Where the device stands against it now; Normal until a query has
+    // counted anything. Safe to call from any thread.
+    RadioBudgetState GetBudgetState();
+
+    // Returns 0-100, or -1 if unknown/error. Each battery command has its
+    // own circuit breaker: one that keeps failing is skipped, with
+    // backing-off retries, so a dead device costs a bounded amount of
+    // timeouts instead of the whole fallback matrix every poll.
     int GetBatteryLevel();
 
+    // Every battery command's breaker is open: the device has failed too
+    // often to be worth asking right now.
+    bool IsUnavailable() const { return unavailable; }
+
     // Returns the last successfully queried battery level, or -1.
     int GetLastBatteryLevel() const { return lastBatteryLevel; }
 
     // Returns true if charging.
     bool IsCharging();
 
+    // The device's own low-battery warning level (0x07/0x81), 0-100, or -1
+    // if it does not report one. Asked once per device, on the interface
+    // its battery answered on, then cached.
+    int GetLowBatteryThreshold();
+
+    // Seconds of inactivity after which the device puts its radio to sleep
+    // (0x07/0x83), or -1 if it does not report one. Asked once, cached.
+    int GetIdleTime();
+
     std::wstring GetSerial();
-    bool IsSameDevice(struct libusb_device* other);
+    bool IsSameDevice(const UsbDevice& other) const;
 
     int GetPID() const { return pid; }
     RazerDeviceType GetType() const;
     std::wstring GetName() const;
 
+    // Queries level and charging state and packs them with the identity
+    // fields. Charging is not asked for when the battery query failed.
+    //
+    // idleAware: a device that has probably gone to sleep (quiet for longer
+    // than its idle time, or last found asleep) gets one short probe on the
+    // known interface instead of the full query. If the receiver answers
+    // for it (busy / no response) or the probe times out, the status is
+    // served from the last reading with `asleep` set, and the radio is left
+    // alone. While IsUnavailable() the status carries error "unavailable".
+    // Over its transfer budget, a device is served from the last reading
+    // with error "over_budget" and not queried at all.
+    //
+    // `budget` becomes the deadline for the query. If it runs out before
+    // the battery answers, the last reading is reported with error
+    // "timeout".
+    //
+    // Cached and single-flight; safe to call from several threads. A status
+    // younger than StatusTtlMs is returned without I/O. Callers arriving
+    // while a query is in flight share its result. If the cached status is
+    // younger than StatusTtlMs + StatusStaleMs, they get it at once instead
+    // of waiting (stale-while-revalidate). "timeout" results are not cached.
+    DeviceStatus QueryStatus(bool idleAware = false, const Deadline& budget = Deadline());
+
+    // Listens for the device's own notifications (DeviceEvents.h) on the
+    // interrupt endpoint of the interface its battery answered on. Each one
+    // decoded updates the cached status at once, which is then passed to
+    // `onChange` on the backend's event thread. False until a query has
+    // found that interface, or when it has no endpoint to listen on or the
+    // backend cannot listen. Call between queries, not during one.
+    using ChangeCallback = std::function<void(DeviceEventKind, const DeviceStatus&)>;
+    bool StartListening(ChangeCallback onChange);
+    // Once it returns, `onChange` is not running and is not called again.
+    void StopListening();
+    bool IsListening() const { return listening.load(); }
+    // A notification has been decoded since listening started, so the
+    // device does send them
+    bool HasNotified() const { return notified.load(); }
+
+    // A refresh right after the enumeration (or a second refresh request)
+    // reuses a status this young
+    static constexpr unsigned int StatusTtlMs = 2000;
+    static constexpr unsigned int StatusStaleMs = 60000;
+
 private:
-    struct libusb_device* device;
-    struct libusb_device_handle* handle;
+    std::shared_ptr<UsbDevice> device;
+    std::unique_ptr<UsbDeviceHandle> handle;
     int pid;
+    unsigned int responseDelayMs;
     std::wstring cachedSerial;
     int workingInterface;
     int lastBatteryLevel = -1;
+    bool lastCharging = false;
+    bool thresholdQueried = false;
+    int lowBatteryThreshold = -1;
+    bool idleQueried = false;
+    int idleTimeSeconds = -1;
+    DeviceMetrics* metrics = nullptr;
+
+    // Idle tracking
+    struct BatteryQuery {
+        uint8_t commandClass;
+        uint8_t commandId;
+        uint8_t dataSize;
+        bool scaleFromByte;
+    };
+    enum class ProbeResult { Answered, Asleep, Inconclusive };
+    static constexpr unsigned int TransferTimeoutMs = 1000;
+    static constexpr unsigned int ProbeTimeoutMs = 100;
+    EventStrategy workingStrategy = EventStrategy::None;
+    BatteryQuery answeredQuery = {0x07, 0x80, 0x02, true}; // the battery query that last answered
+    uint8_t answeredTid = 0;        // 0 until one has
+    uint64_t lastContactUs = 0;     // EventLog::NowUs() of the last answered exchange
+    bool deviceUnreachable = false; // last SendRequest/SendOptional got busy / no response
+    bool asleep = false;
+    bool unavailable = false;
+
+    // Status cache and the in-flight query, guarded by flightMutex. Every
+    // other member belongs to the thread running the flight.
+    std::mutex flightMutex;
+    std::condition_variable flightDone;
+    bool inFlight = false;
+    uint64_t flightGeneration = 0;  // completed flights
+    DeviceStatus flightResult;
+    bool cacheValid = false;
+    DeviceStatus cachedStatus;
+    uint64_t cachedAtUs = 0;
+    DeviceMetrics* cacheMetrics = nullptr; // set by the first flight
+    uint64_t eventCount = 0;        // notifications applied to cachedStatus
+
+    Deadline deadline;
+    uint64_t uncutFailures = 0;     // failed exchanges that had their full timeout
+    std::atomic<uint64_t> transferBudget{0};
+
+    // Interrupt listening; the interface and callback belong to whoever
+    // starts and stops it, the flags are read from any thread
+    int listeningInterface = -1;
+    int refusedInterface = -1;      // could not be listened on; not retried
+    ChangeCallback onChange;
+    std::atomic<bool> listening{false};
+    std::atomic<bool> notified{false};
+    std::map<uint16_t, CircuitBreaker> breakers; // by command class << 8 | id
+
+    DeviceStatus FetchStatus(bool idleAware, const Deadline& budget);
+    void LastReading(DeviceStatus& status);
+    std::string GetKeyString() const;
+    CircuitBreaker& Breaker(uint8_t commandClass, uint8_t commandId);
+    // False (and counted) while the command's breaker is open
+    bool AllowCommand(CircuitBreaker& breaker, uint64_t nowUs);
+    void CommandFailed(CircuitBreaker& breaker, uint8_t commandClass, uint8_t commandId);
+    DeviceMetrics& GetMetrics();
+    RadioBudgetState BudgetState(const DeviceMetrics& deviceMetrics) const;
+    // One control transfer and what it moved, against the device's day
+    void CountTransfer(int result);
+
+    bool ProbablyAsleep() const;
+    ProbeResult ProbeBattery(int& level);
+    void RecordWakeup();
+    // On the event thread: applies one report to the cached status
+    void OnReport(const unsigned char* data, int length);
 
     bool SendRequest(razer_report& request, razer_report& response);
-    unsigned char CalculateCRC(razer_report* report);
+    // For queries a device may not implement (0x07/0x81, 0x07/0x83): one
+    // exchange on the interface, strategy and transaction ID the battery
+    // answered on, no fallbacks. A refusal keeps the interface and the
+    // listener; only a transport error drops them. False, sending nothing,
+    // until the battery has answered.
+    bool SendOptional(razer_report& request, razer_report& response);
+    // One request/response exchange with one report strategy. Returns the
+    // last transfer's result (90 for a whole report) and records the event.
+    int Exchange(int iface, EventStrategy strategy, razer_report& request, razer_report& response,
+                 unsigned int timeoutMs);
+    void RecordEvent(const razer_report& request, const razer_report& response,
+                     int iface, uint8_t strategy, uint64_t startUs, int result);
 };
@@ -2,18 +2,31 @@
 #include <vector>
 #include <memory>
 #include "RazerDevice.h"
-
-struct libusb_context;
+#include "UsbBackend.h"
+#include "WorkPool.h"
 
 class RazerManager {
 public:
-    RazerManager();
+    // With a pool, devices are opened (and queried) concurrently; the
+    // resulting table is the same as a sequential pass would build.
+    explicit RazerManager(std::shared_ptr<UsbBackend> backend, WorkPool* pool = nullptr);
     ~RazerManager();
 
-    void EnumerateDevices();
+    // queryBattery=false skips the per-device battery read (callers that
+    // query devices themselves); collisions between two interfaces of the
+    // same device are still resolved by battery. Every device's transfers
+    // are bounded by `deadline`; a device cut short keeps its PID key
+    // until a later pass reads its serial.
+    void EnumerateDevices(bool queryBattery = true, const Deadline& deadline = Deadline());
     const std::vector<std::shared_ptr<RazerDevice>>& GetDevices() const;
 
+    // Applied to every device from the next enumeration on (see
+    // RazerDevice::SetDailyTransferBudget); 0, the default, is unlimited.
+    void SetDailyTransferBudget(uint64_t transfers) { transferBudget = transfers; }
+
 private:
     std::vector<std::shared_ptr<RazerDevice>> devices;
-    libusb_context* ctx;
+    std::shared_ptr<UsbBackend> backend;
+    WorkPool* pool;
+    uint64_t transferBudget = 0;
 };
@@ -35,3 +35,31 @@ struct razer_report {
 };
 
 #pragma pack(pop)
+
+// XOR of bytes 2..87 (everything between the header and the CRC byte).
+inline unsigned char razer_calculate_crc(const razer_report* report) {
+    unsigned char crc = 0;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(report);
+    for (int i = 2; i < 88; i++) {
+        crc ^= bytes[i];
+    }
+    return crc;
+}
+
+// Zeroed request for the given command, as OpenRazer's get_razer_report().
+inline razer_report get_razer_report(uint8_t command_class, uint8_t command_id, uint8_t data_size) {
+    razer_report report = {0};
+    report.status = 0x00;
+    report.transaction_id.id = 0xFF;
+    report.remaining_packets = 0x00;
+    report.protocol_type = 0x00;
+    report.command_class = command_class;
+    report.command_id.id = command_id;
+    report.data_size = data_size;
+    return report;
+}
+
+// 0x07/0x80 reports the charge as 0-255; convert to a 0-100 percentage.
+inline int razer_scale_battery(uint8_t raw) {
+    return (raw * 100 + 127) / 255;
+}
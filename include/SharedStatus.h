@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+
+// Device table published by the app into named shared memory for readers
+// that poll at frame rate (game overlays). Readers take a consistent copy
+// under a seqlock: no syscalls, no locks, and the writer never waits.
+//
+// Link RazerBatteryStatusReader (this header, SharedStatus.cpp and
+// MappedFile.cpp) to read it from another program.
+
+#define RAZER_SHARED_STATUS_MAGIC 0x3130545453415A52ull // "RZASTT01"
+#define RAZER_SHARED_STATUS_LAYOUT 3
+
+// DeviceStatus::error as a code. OverBudget still carries the last level.
+enum class SharedStatusError : uint8_t {
+    None = 0,
+    Timeout = 1,
+    QueryFailed = 2,
+    Unavailable = 3,
+    Asleep = 4,
+    OverBudget = 5,
+};
+
+struct SharedDeviceRecord {
+    char serial[32];        // device key (serial or PID_xxxx), NUL-padded
+    char name[64];          // NUL-padded
+    uint16_t pid;
+    uint8_t type;           // RazerDeviceType
+    uint8_t charging;
+    int8_t level;           // 0-100, -1 unknown
+    uint8_t error;          // SharedStatusError
+    uint8_t reserved[2];
+    uint32_t latencyMs;
+    int32_t secondsToEmpty; // -1 unknown; see DeviceStatus
+    int32_t secondsToFull;
+    uint8_t reserved2[12];
+};
+
+struct SharedStatusSnapshot {
+    static constexpr uint32_t MaxDevices = 16;
+    static constexpr uint32_t WriterStopped = 1;
+
+    uint64_t version;       // bumped whenever the table changes
+    uint64_t publishedUs;   // steady clock µs (EventLog::NowUs()) of the last publish
+    uint32_t count;
+    uint32_t flags;
+    SharedDeviceRecord devices[MaxDevices];
+};
+
+static_assert(sizeof(SharedDeviceRecord) == 128, "SharedDeviceRecord layout changed");
+static_assert(sizeof(SharedStatusSnapshot) % 8 == 0, "snapshot must be a whole number of words");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "seqlock words must be lock-free");
+
+// The mapped segment. The snapshot is stored as relaxed atomic words so
+// that a reader racing the writer is well-defined; the sequence number
+// tells it whether the copy it took is torn.
+struct SharedStatusSegment {
+    static constexpr size_t PayloadWords = sizeof(SharedStatusSnapshot) / 8;
+    static constexpr size_t HeaderWords = offsetof(SharedStatusSnapshot, devices) / 8;
+    static constexpr size_t RecordWords = sizeof(SharedDeviceRecord) / 8;
+
+    uint64_t magic;
+    uint32_t layout;
+    uint32_t recordSize;
+    uint32_t maxDevices;
+    uint32_t reserved;
+    std::atomic<uint64_t> sequence; // odd while an update is in progress
+    std::atomic<uint64_t> payload[PayloadWords];
+};
+
+// Default segment name: Global\RazerBatteryStatus on Windows (visible to
+// every session; a poller without the privilege to create global objects
+// falls back to Local\RazerBatteryStatus), /razerbattery-status elsewhere.
+std::string DefaultSharedStatusName();
+#ifdef _WIN32
+#define RAZER_SHARED_STATUS_LOCAL_NAME "Local\\RazerBatteryStatus"
+#endif
+
+class SharedStatusReader {
+public:
+    // With the default name, the session-local fallback is tried too.
+    bool Open(const std::string& name = DefaultSharedStatusName());
+    void Close() { file.Close(); segment = nullptr; }
+    bool IsOpen() const { return segment != nullptr; }
+
+    // Copies the current table into `out`. Only the header and `count`
+    // records are copied. Returns false if not open, or if the writer was
+    // mid-update on every one of `maxAttempts` tries.
+    bool Read(SharedStatusSnapshot& out, int maxAttempts = 64) const;
+
+    // Sequence number of the last completed publish; cheap change check.
+    uint64_t GetSequence() const;
+
+private:
+    MappedFile file;
+    const SharedStatusSegment* segment = nullptr;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "DeviceStatus.h"
+#include "MappedFile.h"
+#include "SharedStatus.h"
+
+// Writer side of the shared-memory device table (see SharedStatus.h).
+// Single writer; Publish must not be called concurrently.
+class SharedStatusWriter {
+public:
+    ~SharedStatusWriter();
+
+    bool Create(const std::string& name = DefaultSharedStatusName(),
+                LocalAccess access = LocalAccess::CurrentUser);
+    // Marks the table as stopped for readers still attached, then unmaps.
+    void Close();
+
+    // Devices beyond SharedStatusSnapshot::MaxDevices are dropped.
+    void Publish(const std::vector<DeviceStatus>& statuses, uint64_t version);
+
+private:
+    void Write(const SharedStatusSnapshot& snapshot);
+
+    std::string name;
+    MappedFile file;
+    SharedStatusSegment* segment = nullptr;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped trace spans exported as Chrome trace-event JSON (open the file in
+// ui.perfetto.dev or chrome://tracing). Spans go into a per-thread ring
+// buffer; with tracing disabled a span is a single relaxed load.
+struct TraceArg {
+    const char* name = nullptr;
+    int64_t value = 0;
+};
+
+class Trace {
+public:
+    static constexpr size_t MaxArgs = 4;
+    static constexpr size_t EventsPerThread = 16384;
+
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool on);
+
+    // Monotonic microseconds (same clock as EventLog::NowUs).
+    static uint64_t NowUs();
+
+    // Records a finished span. `name` and argument names must be string literals.
+    static void Complete(const char* name, uint64_t startUs, uint64_t endUs,
+                         const TraceArg* args = nullptr, size_t argCount = 0);
+
+    // Writes every buffered span of every thread; returns false on I/O error.
+    static bool ExportChromeJson(const std::string& path);
+    static void Clear();
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(Trace::IsEnabled() ? name : nullptr) {
+        if (this->name) startUs = Trace::NowUs();
+    }
+    ~TraceScope() {
+        if (name) Trace::Complete(name, startUs, Trace::NowUs(), args, argCount);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void Arg(const char* argName, int64_t value) {
+        if (name && argCount < Trace::MaxArgs) args[argCount++] = {argName, value};
+    }
+
+private:
+    const char* name;
+    uint64_t startUs = 0;
+    TraceArg args[Trace::MaxArgs];
+    size_t argCount = 0;
+};
+
+#define RAZER_TRACE_CONCAT_(a, b) a##b
+#define RAZER_TRACE_CONCAT(a, b) RAZER_TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope RAZER_TRACE_CONCAT(traceScope_, __LINE__)(name)
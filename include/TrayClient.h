@@ -0,0 +1,57 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeviceSnapshot.h"
+#include "DeviceStatus.h"
+#include "IpcChannel.h"
+
+// Session-side view of the poller: keeps a subscription open and reports
+// every published device table. Reconnects (with backoff) when the poller
+// restarts, so the tray can be started before or after it. Never touches USB.
+class TrayClient {
+public:
+    // Runs on the client's thread. `connected` is false (and `devices`
+    // empty) while the poller is unreachable; reported once per outage.
+    using Callback = std::function<void(const std::vector<DeviceStatus>& devices, bool connected)>;
+
+    // Runs on the client's thread for each low-battery alert the poller
+    // broadcasts; `device` is the reading that crossed the threshold.
+    using AlertCallback = std::function<void(const DeviceStatus& device)>;
+
+    explicit TrayClient(Callback callback, std::string endpoint = IpcListener::DefaultEndpoint());
+    ~TrayClient();
+
+    // Set before Start.
+    void SetAlertCallback(AlertCallback handler) { alertCallback = std::move(handler); }
+
+    void Start();
+    void Stop();
+
+    // Asks the poller to re-query the devices (e.g. the user opened the
+    // menu). The poller may decline if it refreshed recently.
+    bool RequestRefresh();
+
+    // The last table received, from any thread and without blocking the
+    // client's thread; stored before the callback runs. Empty (version 0)
+    // while the poller is unreachable.
+    DeviceSnapshotPtr GetSnapshot() const { return latest.Load(); }
+
+private:
+    void Run();
+
+    Callback callback;
+    AlertCallback alertCallback;
+    std::string endpoint;
+    DeviceSnapshotCell latest;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread thread;
+    bool stopping = false;
+    IpcChannel* active = nullptr; // interrupted by Stop
+};
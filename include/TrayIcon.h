@@ -8,15 +8,23 @@ public:
     TrayIcon(HWND hwnd, UINT id);
     ~TrayIcon();
 
-    void Update(int batteryLevel, bool charging, RazerDeviceType type);
+    // `estimate` is FormatEstimate()'s text, appended to the tooltip
+    void Update(int batteryLevel, bool charging, RazerDeviceType type, const std::string& estimate = std::string());
+    // Balloon / toast attached to this icon.
+    void ShowNotification(const std::wstring& title, const std::wstring& text);
     void Remove();
     void UpdatePlaceholder();
+    // Connected but not answering; shown instead of a level.
+    void UpdateUnavailable(RazerDeviceType type);
+
+    // GDI rendering at the small-icon size; the caller destroys the icon.
+    // Static so that RazerBatteryBench can time them without a window.
+    static HICON CreateBatteryIcon(int level, bool charging, RazerDeviceType type);
+    static HICON CreatePlaceholderIcon();
+    static HICON CreateUnavailableIcon(RazerDeviceType type);
 
 private:
     HWND hwnd;
     UINT id;
     NOTIFYICONDATA nid;
-
-    HICON CreateBatteryIcon(int level, bool charging, RazerDeviceType type);
-    HICON CreatePlaceholderIcon();
 };
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// USB transport used by RazerDevice/RazerManager. The production backend
+// wraps libusb (LibusbBackend); tests and soak runs plug in a simulated
+// one. Return codes follow libusb: >= 0 on success, LIBUSB_ERROR_* (< 0)
+// on failure, so logs read the same whichever backend is active.
+
+// Receives each report read from an interrupt IN endpoint, on the
+// backend's event thread. A negative length is the error that ended the
+// listening (device gone); no call follows it.
+using UsbReportCallback = std::function<void(const unsigned char* data, int length)>;
+
+class UsbDeviceHandle {
+public:
+    virtual ~UsbDeviceHandle() = default;
+
+    virtual int ClaimInterface(int iface) = 0;
+    virtual int ReleaseInterface(int iface) = 0;
+    virtual int ControlTransfer(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+                                unsigned char* data, uint16_t length, unsigned int timeoutMs) = 0;
+    // Two transfers (language IDs, then the string) that together wait at
+    // most timeoutMs.
+    virtual int GetStringDescriptorAscii(uint8_t index, unsigned char* data, int length, unsigned int timeoutMs) = 0;
+
+    // Keeps a read posted on the interrupt IN endpoint of `iface` (claimed
+    // through this handle) and hands every report to `onReport`, until
+    // StopListening or the handle closes. One endpoint per handle. Returns
+    // LIBUSB_ERROR_NOT_FOUND when the interface has no such endpoint, and
+    // LIBUSB_ERROR_NOT_SUPPORTED (the default) when the backend cannot listen.
+    virtual int StartListening(int iface, UsbReportCallback onReport) {
+        (void)iface;
+        (void)onReport;
+        return -12; // LIBUSB_ERROR_NOT_SUPPORTED
+    }
+    // Cancels the posted read; once it returns, `onReport` is not running
+    // and will not be called again. Must not be called from `onReport`.
+    virtual void StopListening() {}
+};
+
+class UsbDevice {
+public:
+    virtual ~UsbDevice() = default;
+
+    virtual uint16_t GetVendorId() const = 0;
+    virtual uint16_t GetProductId() const = 0;
+    virtual uint8_t GetSerialNumberIndex() const = 0;
+    virtual uint8_t GetBusNumber() const = 0;
+    virtual uint8_t GetAddress() const = 0;
+    // Interfaces in the active configuration, or 0 if it cannot be read.
+    virtual int GetInterfaceCount() = 0;
+
+    // Returns nullptr and sets `error` on failure.
+    virtual std::unique_ptr<UsbDeviceHandle> Open(int& error) = 0;
+};
+
+class UsbBackend {
+public:
+    virtual ~UsbBackend() = default;
+
+    virtual bool IsAvailable() const = 0;
+    virtual std::vector<std::shared_ptr<UsbDevice>> ListDevices() = 0;
+
+    // Pause between writing a report and reading the reply (the firmware
+    // needs time to prepare it).
+    virtual unsigned int GetResponseDelayMs() const { return 50; }
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed pool for batches of blocking per-device work (open, serial
+// read, battery query), where each task mostly waits on a receiver.
+//
+// Run deals the task indices round-robin onto one deque per participant;
+// each takes from the back of its own deque and, once that is empty,
+// steals from the front of the others, so one slow receiver delays only
+// the tasks actually queued behind it. The calling thread is one of the
+// participants. Results are expected to go into slot `index` of a
+// caller-owned vector, which keeps them in submission order however the
+// tasks were scheduled.
+class WorkPool {
+public:
+    static constexpr size_t DefaultConcurrency = 4;
+
+    // concurrency counts the calling thread; 1 runs every batch inline.
+    explicit WorkPool(size_t concurrency = DefaultConcurrency);
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    // Runs task(0) .. task(count - 1) and returns once all have finished.
+    // One batch at a time; tasks must not throw or call Run.
+    void Run(size_t count, const std::function<void(size_t)>& task);
+
+    size_t GetConcurrency() const { return queues.size(); }
+    uint64_t GetSteals() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    void WorkerLoop(size_t self);
+    void Work(size_t self, const std::function<void(size_t)>& task);
+    bool Take(size_t self, size_t& index);
+
+    std::vector<std::unique_ptr<Queue>> queues; // [0] is the caller's
+    std::vector<std::thread> workers;
+
+    std::mutex runMutex;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* current = nullptr;
+    uint64_t generation = 0;
+    size_t remaining = 0;       // tasks of the current batch not yet finished
+    size_t active = 0;          // workers that may still touch `current`
+    uint64_t steals = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,45 @@
+#include "BatteryAlerts.h"
+
+int BatteryAlertEngine::ThresholdFor(const DeviceStatus& status) const {
+    return status.lowBatteryThreshold >= 0 ? status.lowBatteryThreshold : options.defaultThreshold;
+}
+
+std::vector<BatteryAlert> BatteryAlertEngine::Update(const std::vector<DeviceStatus>& statuses, int64_t time) {
+    std::vector<BatteryAlert> alerts;
+    for (const auto& status : statuses) {
+        if (status.level < 0 || !status.error.empty()) continue;
+        int threshold = ThresholdFor(status);
+        // A threshold of 0 means the user turned the device's warning off
+        if (threshold <= 0) continue;
+
+        State& state = states[status.serial];
+        if (status.charging || status.level >= threshold + options.hysteresisPoints) {
+            state.armed = true;
+            continue;
+        }
+        if (!state.armed || status.level > threshold) continue;
+
+        state.armed = false;
+        if (state.lastAlert != INT64_MIN && time - state.lastAlert < options.minIntervalSeconds) continue;
+        state.lastAlert = time;
+        alerts.push_back(BatteryAlert{status, threshold});
+    }
+    return alerts;
+}
+
+bool BatteryAlertEngine::IsNearThreshold(const DeviceStatus& status) const {
+    // A sleeping device's level cannot move until it wakes
+    if (status.level < 0 || status.charging || status.asleep || !status.error.empty()) return false;
+    int threshold = ThresholdFor(status);
+    // Once at or below the threshold the alert has been decided
+    return threshold > 0 && status.level > threshold && status.level <= threshold + options.watchMarginPoints;
+}
+
+std::string AlertMessage(const BatteryAlert& alert) {
+    std::string message = "{\"type\":\"alert\",\"kind\":\"low_battery\",\"threshold\":";
+    message += std::to_string(alert.threshold);
+    message += ",\"device\":";
+    AppendJson(message, alert.device);
+    message += '}';
+    return message;
+}
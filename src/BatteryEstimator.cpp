@@ -0,0 +1,154 @@
+#include "BatteryEstimator.h"
+#include <cmath>
+
+void BatteryEstimator::Reset() {
+    sw = sx = sy = sxx = sxy = 0;
+    offset = 0;
+    samples = 0;
+    span = 0;
+    lastLevel = -1;
+    suspectLevel = -1;
+}
+
+void BatteryEstimator::Add(int64_t time, int level, bool isCharging) {
+    if (level < 0) return;
+    if (samples == 0 || isCharging != charging) {
+        Reset();
+        charging = isCharging;
+        lastTime = time;
+        Accept(level);
+        return;
+    }
+
+    int64_t dt = time - lastTime;
+    if (dt < 0 || dt > options.maxGapSeconds) {
+        Splice(level);
+        lastTime = time;
+        suspectLevel = -1;
+        return;
+    }
+
+    // Age the sums and move the origin to `time`: x' = x - dt
+    double decay = std::exp2(-static_cast<double>(dt) / static_cast<double>(options.halfLifeSeconds));
+    double d = static_cast<double>(dt);
+    double w = sw * decay, x = sx * decay, y = sy * decay, xx = sxx * decay, xy = sxy * decay;
+    xx = xx - 2 * d * x + d * d * w;
+    xy = xy - d * y;
+    x = x - d * w;
+
+    if (samples >= options.minSamples) {
+        double denom = w * xx - x * x;
+        double slope = denom > 1e-9 ? (w * xy - x * y) / denom : 0;
+        double predicted = (y - slope * x) / w;
+        if (std::fabs(level + offset - predicted) > options.outlierPoints) {
+            bool confirmed = suspectLevel >= 0 && std::abs(level - suspectLevel) <= options.outlierPoints;
+            if (!confirmed) {
+                suspectLevel = level;
+                return;
+            }
+            // A step, not a glitch: continue the line from where it was
+            offset = predicted - level;
+        }
+    }
+
+    sw = w;
+    sx = x;
+    sy = y;
+    sxx = xx;
+    sxy = xy;
+    span += dt;
+    lastTime = time;
+    Accept(level);
+}
+
+void BatteryEstimator::Accept(int level) {
+    double y = level + offset;
+    sw += 1;
+    sy += y;
+    samples++;
+    lastLevel = level;
+    suspectLevel = -1;
+}
+
+void BatteryEstimator::Splice(int level) {
+    // The gap adds no time, so the new reading continues the last one
+    offset += lastLevel - level;
+    lastLevel = level;
+}
+
+bool BatteryEstimator::Ready() const {
+    return samples >= options.minSamples && span >= options.minSpanSeconds;
+}
+
+double BatteryEstimator::Slope() const {
+    double denom = sw * sxx - sx * sx;
+    return denom > 1e-9 ? (sw * sxy - sx * sy) / denom : 0;
+}
+
+double BatteryEstimator::RatePerHour() const {
+    return Ready() ? Slope() * 3600 : 0;
+}
+
+int64_t BatteryEstimator::SecondsToEmpty() const {
+    if (charging || !Ready()) return -1;
+    double slope = Slope();
+    if (slope >= 0) return -1;
+    double seconds = lastLevel / -slope;
+    return seconds > options.maxEstimateSeconds ? -1 : std::llround(seconds);
+}
+
+int64_t BatteryEstimator::SecondsToFull() const {
+    if (!charging || lastLevel < 0) return -1;
+    if (lastLevel >= 100) return 0;
+    if (!Ready()) return -1;
+    double slope = Slope();
+    if (slope <= 0) return -1;
+    double seconds = (100 - lastLevel) / slope;
+    return seconds > options.maxEstimateSeconds ? -1 : std::llround(seconds);
+}
+
+static int RoundToMinute(int64_t seconds) {
+    return seconds < 0 ? -1 : static_cast<int>((seconds + 30) / 60 * 60);
+}
+
+void BatteryEstimatorSet::Apply(std::vector<DeviceStatus>& statuses, int64_t time) {
+    for (auto& status : statuses) {
+        if (status.level < 0 || !status.error.empty()) continue;
+        auto it = estimators.find(status.serial);
+        if (it == estimators.end()) it = estimators.emplace(status.serial, BatteryEstimator(options)).first;
+        // Asleep: the level is a cached reading; the next fresh one after
+        // a long sleep is spliced as a gap
+        if (!status.asleep) it->second.Add(time, status.level, status.charging);
+        status.secondsToEmpty = RoundToMinute(it->second.SecondsToEmpty());
+        status.secondsToFull = RoundToMinute(it->second.SecondsToFull());
+    }
+}
+
+const BatteryEstimator* BatteryEstimatorSet::Get(const std::string& deviceKey) const {
+    auto it = estimators.find(deviceKey);
+    return it == estimators.end() ? nullptr : &it->second;
+}
+
+static std::string FormatDuration(int seconds) {
+    int minutes = (seconds + 30) / 60;
+    if (minutes < 1) minutes = 1;
+    int hours = minutes / 60;
+    minutes %= 60;
+    if (hours >= 24) {
+        int days = hours / 24;
+        hours %= 24;
+        return std::to_string(days) + " d" + (hours ? " " + std::to_string(hours) + " h" : "");
+    }
+    if (hours == 0) return std::to_string(minutes) + " min";
+    return std::to_string(hours) + " h" + (minutes ? " " + std::to_string(minutes) + " min" : "");
+}
+
+std::string FormatEstimate(const DeviceStatus& status) {
+    if (status.charging) {
+        if (status.secondsToFull == 0) return "full";
+        if (status.secondsToFull > 0) return "~" + FormatDuration(status.secondsToFull) + " to full";
+    } else if (status.secondsToEmpty >= 0) {
+        return "~" + FormatDuration(status.secondsToEmpty) + " left";
+    }
+    return "";
+}
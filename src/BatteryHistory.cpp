@@ -0,0 +1,389 @@
+#include "BatteryHistory.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+uint64_t ZigZag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t UnZigZag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+size_t PutVarint(uint8_t* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = static_cast<uint8_t>(v) | 0x80;
+        v >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(v);
+    return n;
+}
+
+bool GetVarint(const uint8_t* data, size_t end, size_t& offset, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && offset < end; shift += 7) {
+        uint8_t byte = data[offset++];
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+enum RecordKind : uint64_t { KindSample = 0, KindRepeat = 1, KindCharge = 2 };
+
+} // namespace
+
+bool BatteryHistory::Open(const std::string& path, const std::string& deviceKey, uint32_t blocks) {
+    Close();
+    writable = true;
+    if (file.OpenExisting(path) && Validate()) {
+        Recover();
+        return true;
+    }
+    file.Close();
+
+    if (blocks == 0) blocks = DefaultBlocks;
+    if (!file.Create(path, sizeof(HistoryFileHeader) + static_cast<size_t>(blocks) * BlockSize)) {
+        LOG_ERROR("Failed to create battery history: " << path);
+        return false;
+    }
+    HistoryFileHeader* header = Header();
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, RAZER_HISTORY_MAGIC, sizeof(header->magic));
+    header->version = RAZER_HISTORY_VERSION;
+    header->blockSize = BlockSize;
+    header->blockCount = blocks;
+    memcpy(header->deviceKey, deviceKey.data(), std::min(deviceKey.size(), sizeof(header->deviceKey)));
+    return true;
+}
+
+bool BatteryHistory::OpenReadOnly(const std::string& path) {
+    Close();
+    writable = false;
+    if (file.OpenReadOnly(path) && Validate()) return true;
+    file.Close();
+    return false;
+}
+
+void BatteryHistory::Close() {
+    if (writable) file.Flush();
+    file.Close();
+    state = State();
+    haveBlock = false;
+    repeatOffset = SIZE_MAX;
+    repeatCount = 0;
+}
+
+bool BatteryHistory::Validate() const {
+    if (file.Size() < sizeof(HistoryFileHeader)) return false;
+    const HistoryFileHeader* header = Header();
+    return memcmp(header->magic, RAZER_HISTORY_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == RAZER_HISTORY_VERSION && header->blockSize == BlockSize &&
+           header->blockCount > 0 && header->firstBlock < header->blockCount &&
+           header->usedBlocks <= header->blockCount &&
+           file.Size() >= sizeof(HistoryFileHeader) + static_cast<size_t>(header->blockCount) * BlockSize;
+}
+
+HistoryBlockHeader* BatteryHistory::Block(uint32_t logical) const {
+    const HistoryFileHeader* header = Header();
+    uint32_t physical = (header->firstBlock + logical) % header->blockCount;
+    return reinterpret_cast<HistoryBlockHeader*>(file.Data() + sizeof(HistoryFileHeader) +
+                                                 static_cast<size_t>(physical) * BlockSize);
+}
+
+// Replays the newest block to restore the encoder state after a restart.
+void BatteryHistory::Recover() {
+    const HistoryFileHeader* header = Header();
+    if (header->usedBlocks == 0) return;
+
+    HistoryBlockHeader* block = Block(header->usedBlocks - 1);
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(block + 1);
+    size_t used = std::min<size_t>(block->usedBytes, PayloadBytes);
+    state = State{block->baseTime, 0, block->baseLevel, block->baseCharging != 0};
+
+    size_t offset = 0;
+    HistoryRecord::Kind kind;
+    uint64_t repeats = 0;
+    while (offset < used) {
+        size_t start = offset;
+        if (!Decode(payload, used, offset, state, kind, repeats)) {
+            // Torn tail: keep what decodes and overwrite the rest
+            block->usedBytes = static_cast<uint16_t>(start);
+            break;
+        }
+        state.time += static_cast<int64_t>(repeats) * state.dt;
+        bool isRepeat = repeats > 0 && offset - start == 1;
+        repeatOffset = isRepeat ? start : SIZE_MAX;
+        repeatCount = isRepeat ? repeats : 0;
+    }
+    haveBlock = true;
+}
+
+bool BatteryHistory::Decode(const uint8_t* payload, size_t used, size_t& offset, State& state,
+                            HistoryRecord::Kind& kind, uint64_t& repeats) {
+    uint64_t tag;
+    repeats = 0;
+    if (!GetVarint(payload, used, offset, tag)) return false;
+
+    switch (tag & 3) {
+    case KindSample: {
+        uint64_t delta;
+        if (!GetVarint(payload, used, offset, delta)) return false;
+        state.dt += UnZigZag(tag >> 2);
+        state.time += state.dt;
+        state.level += static_cast<int>(UnZigZag(delta));
+        kind = HistoryRecord::Kind::Sample;
+        return true;
+    }
+    case KindRepeat:
+        // The caller expands the run; state is left at the run's start
+        repeats = tag >> 2;
+        kind = HistoryRecord::Kind::Sample;
+        return repeats > 0;
+    case KindCharge:
+        state.time += UnZigZag(tag >> 3);
+        state.charging = (tag >> 2) & 1;
+        kind = state.charging ? HistoryRecord::Kind::ChargeStarted : HistoryRecord::Kind::ChargeStopped;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void BatteryHistory::StartBlock() {
+    HistoryFileHeader* header = Header();
+    if (header->usedBlocks == header->blockCount) {
+        // Recycle the oldest block; drop it from the live range first so a
+        // crash never leaves it looking like the newest data
+        header->firstBlock = (header->firstBlock + 1) % header->blockCount;
+        header->usedBlocks--;
+    }
+    HistoryBlockHeader* block = Block(header->usedBlocks);
+    block->baseTime = state.time;
+    block->baseLevel = static_cast<int8_t>(state.level);
+    block->baseCharging = state.charging ? 1 : 0;
+    memset(block->reserved, 0, sizeof(block->reserved));
+    block->usedBytes = 0;
+    header->usedBlocks++;
+
+    state.dt = 0;
+    haveBlock = true;
+    repeatOffset = SIZE_MAX;
+    repeatCount = 0;
+}
+
+// Writes an encoded record after the current block's data. The byte count
+// is published after the bytes, so readers never see a partial record.
+void BatteryHistory::Emit(const uint8_t* bytes, size_t length, const State& after) {
+    HistoryBlockHeader* block = Block(Header()->usedBlocks - 1);
+    uint8_t* payload = reinterpret_cast<uint8_t*>(block + 1);
+    memcpy(payload + block->usedBytes, bytes, length);
+    block->usedBytes = static_cast<uint16_t>(block->usedBytes + length);
+    state = after;
+}
+
+void BatteryHistory::AppendSample(int64_t time, int level) {
+    int64_t dt = time - state.time;
+    if (dt == state.dt && level == state.level) {
+        // Extend the trailing run in place while its tag stays one byte
+        HistoryBlockHeader* block = Block(Header()->usedBlocks - 1);
+        uint8_t* payload = reinterpret_cast<uint8_t*>(block + 1);
+        if (repeatOffset != SIZE_MAX && repeatCount < MaxInPlaceRepeats) {
+            repeatCount++;
+            payload[repeatOffset] = static_cast<uint8_t>(repeatCount << 2 | KindRepeat);
+            state.time = time;
+            return;
+        }
+        if (static_cast<size_t>(block->usedBytes) + 1 <= PayloadBytes) {
+            uint8_t tag = static_cast<uint8_t>(1 << 2 | KindRepeat);
+            repeatOffset = block->usedBytes;
+            repeatCount = 1;
+            State after = state;
+            after.time = time;
+            Emit(&tag, 1, after);
+            return;
+        }
+    }
+
+    uint8_t bytes[20];
+    size_t n = PutVarint(bytes, ZigZag(dt - state.dt) << 2 | KindSample);
+    n += PutVarint(bytes + n, ZigZag(level - state.level));
+    if (Block(Header()->usedBlocks - 1)->usedBytes + n > PayloadBytes) {
+        StartBlock();
+        dt = time - state.time;
+        n = PutVarint(bytes, ZigZag(dt - state.dt) << 2 | KindSample);
+        n += PutVarint(bytes + n, ZigZag(level - state.level));
+    }
+    State after = state;
+    after.dt = dt;
+    after.time = time;
+    after.level = level;
+    repeatOffset = SIZE_MAX;
+    repeatCount = 0;
+    Emit(bytes, n, after);
+}
+
+void BatteryHistory::AppendCharge(int64_t time, bool charging) {
+    uint8_t bytes[12];
+    size_t n = PutVarint(bytes, (ZigZag(time - state.time) << 1 | (charging ? 1 : 0)) << 2 | KindCharge);
+    if (Block(Header()->usedBlocks - 1)->usedBytes + n > PayloadBytes) {
+        StartBlock();
+        n = PutVarint(bytes, (ZigZag(time - state.time) << 1 | (charging ? 1 : 0)) << 2 | KindCharge);
+    }
+    State after = state;
+    after.time = time;
+    after.charging = charging;
+    repeatOffset = SIZE_MAX;
+    repeatCount = 0;
+    Emit(bytes, n, after);
+}
+
+void BatteryHistory::Append(int64_t time, int level, bool charging) {
+    if (!writable || !file.IsOpen() || level < 0 || level > 100) return;
+
+    if (!haveBlock) {
+        // First reading: it becomes the base of the first block
+        state = State{time, 0, level, charging};
+        StartBlock();
+        AppendSample(time, level);
+        return;
+    }
+    if (charging != state.charging) AppendCharge(time, charging);
+    AppendSample(time, level);
+}
+
+size_t BatteryHistory::GetUsedBytes() const {
+    if (!file.IsOpen()) return 0;
+    const HistoryFileHeader* header = Header();
+    size_t bytes = sizeof(HistoryFileHeader);
+    if (header->usedBlocks > 0) {
+        bytes += static_cast<size_t>(header->usedBlocks - 1) * BlockSize;
+        bytes += sizeof(HistoryBlockHeader) + Block(header->usedBlocks - 1)->usedBytes;
+    }
+    return bytes;
+}
+
+BatteryHistory::Range BatteryHistory::Query(int64_t from, int64_t to) const {
+    Range range;
+    if (!file.IsOpen() || from >= to) return range;
+    const HistoryFileHeader* header = Header();
+    if (header->usedBlocks == 0) return range;
+
+    // Last block starting at or before `from`; blocks are in time order
+    uint32_t lo = 0, hi = header->usedBlocks;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (Block(mid)->baseTime <= from) lo = mid;
+        else hi = mid;
+    }
+
+    Iterator& it = range.first;
+    it.history = this;
+    it.block = lo;
+    it.to = to;
+    const HistoryBlockHeader* block = Block(lo);
+    it.record.time = block->baseTime;
+    it.record.level = block->baseLevel;
+    it.record.charging = block->baseCharging != 0;
+
+    while (it.Step()) {
+        if (it.record.time >= to) break;
+        if (it.record.time >= from) return range;
+    }
+    it.history = nullptr;
+    return range;
+}
+
+BatteryHistory::Iterator& BatteryHistory::Iterator::operator++() {
+    if (!Step() || record.time >= to) history = nullptr;
+    return *this;
+}
+
+// Moves to the next record, crossing into the next block when needed.
+bool BatteryHistory::Iterator::Step() {
+    if (pendingRepeats > 0) {
+        pendingRepeats--;
+        record.kind = HistoryRecord::Kind::Sample;
+        record.time += dt;
+        return true;
+    }
+
+    const HistoryFileHeader* header = history->Header();
+    while (block < header->usedBlocks) {
+        const HistoryBlockHeader* current = history->Block(block);
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(current + 1);
+        size_t used = std::min<size_t>(current->usedBytes, PayloadBytes);
+        State state{record.time, dt, record.level, record.charging};
+        HistoryRecord::Kind kind;
+        uint64_t repeats = 0;
+        if (offset < used && Decode(payload, used, offset, state, kind, repeats)) {
+            dt = state.dt;
+            record.kind = kind;
+            record.time = state.time;
+            record.level = state.level;
+            record.charging = state.charging;
+            if (repeats > 0) {
+                pendingRepeats = repeats - 1;
+                record.time += dt;
+            }
+            return true;
+        }
+
+        // End of the block's data (or an undecodable record): the next
+        // block restarts from its own base
+        if (++block >= header->usedBlocks) break;
+        const HistoryBlockHeader* next = history->Block(block);
+        offset = 0;
+        dt = 0;
+        record.time = next->baseTime;
+        record.level = next->baseLevel;
+        record.charging = next->baseCharging != 0;
+    }
+    return false;
+}
+
+std::string BatteryHistoryStore::PathFor(const std::string& directory, const std::string& deviceKey) {
+    std::string name = deviceKey;
+    for (char& c : name) {
+        bool safe = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '-' || c == '_';
+        if (!safe) c = '_';
+    }
+    return directory + "/RazerBatteryHistory-" + name + ".bin";
+}
+
+bool BatteryHistoryStore::Open(const std::string& dir, uint32_t blocksPerDevice) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        LOG_ERROR("Cannot create history directory " << dir << ": " << ec.message());
+        return false;
+    }
+    directory = dir;
+    blocks = blocksPerDevice;
+    return true;
+}
+
+void BatteryHistoryStore::Record(const std::vector<DeviceStatus>& statuses, int64_t time) {
+    if (directory.empty()) return;
+    for (const auto& status : statuses) {
+        // A sleeping or timed-out device's level is its last reading,
+        // already recorded
+        if (status.level < 0 || status.asleep || !status.error.empty()) continue;
+        auto& history = histories[status.serial];
+        if (!history) {
+            history = std::make_unique<BatteryHistory>();
+            if (!history->Open(PathFor(directory, status.serial), status.serial, blocks)) continue;
+        }
+        history->Append(time, status.level, status.charging);
+    }
+}
+
+BatteryHistory* BatteryHistoryStore::Get(const std::string& deviceKey) {
+    auto it = histories.find(deviceKey);
+    return it != histories.end() && it->second->IsOpen() ? it->second.get() : nullptr;
+}
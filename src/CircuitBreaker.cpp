@@ -0,0 +1,50 @@
+#include "CircuitBreaker.h"
+#include <algorithm>
+
+bool CircuitBreaker::Allow(uint64_t nowUs) {
+    switch (state) {
+    case BreakerState::Closed:
+        return true;
+    case BreakerState::Open:
+        if (nowUs < retryAtUs) return false;
+        state = BreakerState::HalfOpen;
+        retryAtUs = nowUs + backoffUs;
+        return true;
+    case BreakerState::HalfOpen:
+        if (nowUs < retryAtUs) return false;
+        // The trial's outcome was never recorded
+        Reopen(nowUs);
+        return false;
+    }
+    return true;
+}
+
+void CircuitBreaker::RecordNoOutcome() {
+    if (state != BreakerState::HalfOpen) return;
+    state = BreakerState::Open;
+    retryAtUs = 0;
+}
+
+void CircuitBreaker::RecordSuccess() {
+    state = BreakerState::Closed;
+    failures = 0;
+    backoffUs = 0;
+}
+
+bool CircuitBreaker::RecordFailure(uint64_t nowUs) {
+    if (state == BreakerState::Closed) {
+        if (++failures < options.failureThreshold) return false;
+        backoffUs = options.initialBackoffUs;
+    } else {
+        backoffUs = std::min(backoffUs * 2, options.maxBackoffUs);
+    }
+    bool opened = state == BreakerState::Closed;
+    Reopen(nowUs);
+    return opened;
+}
+
+void CircuitBreaker::Reopen(uint64_t nowUs) {
+    std::uniform_real_distribution<double> spread(1 - options.jitter, 1 + options.jitter);
+    retryAtUs = nowUs + static_cast<uint64_t>(static_cast<double>(backoffUs) * spread(random));
+    state = BreakerState::Open;
+}
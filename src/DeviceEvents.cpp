@@ -0,0 +1,36 @@
+#include "DeviceEvents.h"
+#include "RazerProtocol.h"
+
+const char* DeviceEventKindName(DeviceEventKind kind) {
+    switch (kind) {
+    case DeviceEventKind::Battery: return "battery";
+    case DeviceEventKind::Charging: return "charging";
+    case DeviceEventKind::Connected: return "connected";
+    case DeviceEventKind::Disconnected: return "disconnected";
+    }
+    return "unknown";
+}
+
+bool DecodeDeviceEvent(const unsigned char* data, int length, DeviceEvent& event) {
+    if (!data || length < 3 || data[0] != NotificationReportId) return false;
+    for (int i = 3; i < length; i++) {
+        if (data[i] != 0) return false;
+    }
+    uint8_t value = data[2];
+    switch (static_cast<NotificationCode>(data[1])) {
+    case NotificationCode::Link:
+        if (value > 1) return false;
+        event.kind = value ? DeviceEventKind::Connected : DeviceEventKind::Disconnected;
+        return true;
+    case NotificationCode::Battery:
+        event.kind = DeviceEventKind::Battery;
+        event.level = razer_scale_battery(value);
+        return true;
+    case NotificationCode::Charging:
+        if (value > 1) return false;
+        event.kind = DeviceEventKind::Charging;
+        event.charging = value == 1;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,273 @@
+#include "DeviceStatus.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+const char* DeviceTypeName(RazerDeviceType type) {
+    switch (type) {
+    case RazerDeviceType::Mouse: return "mouse";
+    case RazerDeviceType::Keyboard: return "keyboard";
+    case RazerDeviceType::Headset: return "headset";
+    case RazerDeviceType::Accessory: return "accessory";
+    default: return "unknown";
+    }
+}
+
+static void AppendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+void AppendJson(std::string& out, const DeviceStatus& status) {
+    char buf[32];
+    out += "{\"serial\":";
+    AppendJsonString(out, status.serial);
+    snprintf(buf, sizeof(buf), ",\"pid\":\"0x%04x\"", status.pid);
+    out += buf;
+    out += ",\"type\":\"";
+    out += DeviceTypeName(status.type);
+    out += "\",\"name\":";
+    AppendJsonString(out, status.name);
+    out += ",\"level\":";
+    out += status.level < 0 ? "null" : std::to_string(status.level);
+    out += ",\"charging\":";
+    out += status.charging ? "true" : "false";
+    if (status.asleep) out += ",\"asleep\":true";
+    out += ",\"latency_ms\":";
+    out += std::to_string(status.latencyMs);
+    out += ",\"seconds_to_empty\":";
+    out += status.secondsToEmpty < 0 ? "null" : std::to_string(status.secondsToEmpty);
+    out += ",\"seconds_to_full\":";
+    out += status.secondsToFull < 0 ? "null" : std::to_string(status.secondsToFull);
+    out += ",\"low_battery_threshold\":";
+    out += status.lowBatteryThreshold < 0 ? "null" : std::to_string(status.lowBatteryThreshold);
+    if (!status.error.empty()) {
+        out += ",\"error\":";
+        AppendJsonString(out, status.error);
+    }
+    out += '}';
+}
+
+void AppendJson(std::string& out, const std::vector<DeviceStatus>& statuses) {
+    out += '[';
+    for (size_t i = 0; i < statuses.size(); i++) {
+        if (i) out += ',';
+        AppendJson(out, statuses[i]);
+    }
+    out += ']';
+}
+
+namespace {
+
+// Just enough JSON for the messages above: objects, arrays, strings
+// (ASCII escapes), integers, true/false/null.
+class JsonCursor {
+public:
+    explicit JsonCursor(const std::string& text) : p(text.c_str()), end(text.c_str() + text.size()) {}
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (p < end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    bool Peek(char c) {
+        SkipSpace();
+        return p < end && *p == c;
+    }
+
+    bool ReadString(std::string& out) {
+        out.clear();
+        if (!Consume('"')) return false;
+        while (p < end && *p != '"') {
+            char c = *p++;
+            if (c == '\\') {
+                if (p >= end) return false;
+                char e = *p++;
+                switch (e) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u':
+                    if (end - p < 4) return false;
+                    c = static_cast<char>(strtol(std::string(p, 4).c_str(), nullptr, 16));
+                    p += 4;
+                    break;
+                default: c = e; break;
+                }
+            }
+            out += c;
+        }
+        return Consume('"');
+    }
+
+    bool ReadInteger(long long& out) {
+        SkipSpace();
+        char* next = nullptr;
+        out = strtoll(p, &next, 10);
+        if (next == p) return false;
+        p = next;
+        // Fractions are not expected; skip them if present
+        while (p < end && (*p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-' || (*p >= '0' && *p <= '9'))) p++;
+        return true;
+    }
+
+    // Returns 1 for true, 0 for false, -1 for null, -2 on error.
+    int ReadLiteral() {
+        SkipSpace();
+        if (Match("true")) return 1;
+        if (Match("false")) return 0;
+        if (Match("null")) return -1;
+        return -2;
+    }
+
+    bool SkipValue() {
+        SkipSpace();
+        if (p >= end) return false;
+        if (*p == '"') {
+            std::string ignored;
+            return ReadString(ignored);
+        }
+        if (*p == '{' || *p == '[') {
+            char close = *p == '{' ? '}' : ']';
+            bool object = *p == '{';
+            p++;
+            if (Consume(close)) return true;
+            do {
+                if (object) {
+                    std::string key;
+                    if (!ReadString(key) || !Consume(':')) return false;
+                }
+                if (!SkipValue()) return false;
+            } while (Consume(','));
+            return Consume(close);
+        }
+        if (*p == 't' || *p == 'f' || *p == 'n') return ReadLiteral() != -2;
+        long long ignored;
+        return ReadInteger(ignored);
+    }
+
+private:
+    const char* p;
+    const char* end;
+
+    void SkipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    }
+
+    bool Match(const char* word) {
+        size_t n = strlen(word);
+        if (static_cast<size_t>(end - p) < n || strncmp(p, word, n) != 0) return false;
+        p += n;
+        return true;
+    }
+};
+
+RazerDeviceType DeviceTypeFromName(const std::string& name) {
+    if (name == "mouse") return RazerDeviceType::Mouse;
+    if (name == "keyboard") return RazerDeviceType::Keyboard;
+    if (name == "headset") return RazerDeviceType::Headset;
+    if (name == "accessory") return RazerDeviceType::Accessory;
+    return RazerDeviceType::Unknown;
+}
+
+bool ParseDevice(JsonCursor& json, DeviceStatus& status) {
+    if (!json.Consume('{')) return false;
+    if (json.Consume('}')) return true;
+    do {
+        std::string key, text;
+        long long number = 0;
+        if (!json.ReadString(key) || !json.Consume(':')) return false;
+
+        if (key == "serial" || key == "name" || key == "error" || key == "type" || key == "pid") {
+            if (!json.ReadString(text)) return false;
+            if (key == "serial") status.serial = text;
+            else if (key == "name") status.name = text;
+            else if (key == "error") status.error = text;
+            else if (key == "type") status.type = DeviceTypeFromName(text);
+            else status.pid = static_cast<int>(strtol(text.c_str(), nullptr, 16));
+        } else if (key == "level" || key == "seconds_to_empty" || key == "seconds_to_full" ||
+                   key == "low_battery_threshold") {
+            if (json.Peek('n')) {
+                if (json.ReadLiteral() != -1) return false;
+                number = -1;
+            } else if (!json.ReadInteger(number)) {
+                return false;
+            }
+            if (key == "level") status.level = static_cast<int>(number);
+            else if (key == "seconds_to_empty") status.secondsToEmpty = static_cast<int>(number);
+            else if (key == "seconds_to_full") status.secondsToFull = static_cast<int>(number);
+            else status.lowBatteryThreshold = static_cast<int>(number);
+        } else if (key == "charging" || key == "asleep") {
+            int value = json.ReadLiteral();
+            if (value < 0) return false;
+            if (key == "charging") status.charging = value == 1;
+            else status.asleep = value == 1;
+        } else if (key == "latency_ms") {
+            if (!json.ReadInteger(number)) return false;
+            status.latencyMs = static_cast<uint32_t>(number);
+        } else if (!json.SkipValue()) {
+            return false;
+        }
+    } while (json.Consume(','));
+    return json.Consume('}');
+}
+
+} // namespace
+
+bool ParseStatusMessage(const std::string& text, std::string& type, uint64_t& version,
+                        std::vector<DeviceStatus>& devices) {
+    JsonCursor json(text);
+    type.clear();
+    version = 0;
+    devices.clear();
+
+    if (!json.Consume('{')) return false;
+    if (json.Consume('}')) return true;
+    do {
+        std::string key;
+        if (!json.ReadString(key) || !json.Consume(':')) return false;
+
+        if (key == "type") {
+            if (!json.ReadString(type)) return false;
+        } else if (key == "version") {
+            long long number = 0;
+            if (!json.ReadInteger(number)) return false;
+            version = static_cast<uint64_t>(number);
+        } else if (key == "devices") {
+            if (!json.Consume('[')) return false;
+            if (!json.Consume(']')) {
+                do {
+                    DeviceStatus status;
+                    if (!ParseDevice(json, status)) return false;
+                    devices.push_back(std::move(status));
+                } while (json.Consume(','));
+                if (!json.Consume(']')) return false;
+            }
+        } else if (key == "device") {
+            DeviceStatus status;
+            if (!ParseDevice(json, status)) return false;
+            devices.push_back(std::move(status));
+        } else if (!json.SkipValue()) {
+            return false;
+        }
+    } while (json.Consume(','));
+    return json.Consume('}');
+}
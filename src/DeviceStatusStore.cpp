@@ -0,0 +1,43 @@
+#include "DeviceStatusStore.h"
+
+static bool SameState(const DeviceStatus& a, const DeviceStatus& b) {
+    return a.serial == b.serial && a.pid == b.pid && a.level == b.level &&
+           a.charging == b.charging && a.asleep == b.asleep && a.error == b.error &&
+           a.secondsToEmpty == b.secondsToEmpty && a.secondsToFull == b.secondsToFull &&
+           a.lowBatteryThreshold == b.lowBatteryThreshold;
+}
+
+bool DeviceStatusStore::Publish(std::vector<DeviceStatus> next) {
+    uint64_t published;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        DeviceSnapshotPtr previous = current.Load();
+        bool changed = next.size() != previous->devices.size();
+        for (size_t i = 0; !changed && i < next.size(); i++) {
+            changed = !SameState(next[i], previous->devices[i]);
+        }
+        // Readers may still hold the previous snapshot; it is never touched
+        auto snapshot = std::make_shared<DeviceSnapshot>();
+        snapshot->version = changed ? previous->version + 1 : previous->version;
+        snapshot->devices = std::move(next);
+        current.Store(std::move(snapshot));
+        if (!changed) return false;
+        published = previous->version + 1;
+    }
+
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    for (auto& pair : listeners) pair.second(published);
+    return true;
+}
+
+int DeviceStatusStore::Subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    int id = nextListenerId++;
+    listeners[id] = std::move(listener);
+    return id;
+}
+
+void DeviceStatusStore::Unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    listeners.erase(id);
+}
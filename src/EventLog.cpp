@@ -0,0 +1,110 @@
+#include "EventLog.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+EventLog& EventLog::Instance() {
+    static EventLog instance;
+    return instance;
+}
+
+EventLog::~EventLog() {
+    Close();
+}
+
+uint64_t EventLog::NowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool EventLog::Open(const std::string& logPath, uint64_t recordCapacity, int keepGenerations) {
+    std::lock_guard<std::mutex> lock(mutex);
+    path = logPath;
+    capacity = recordCapacity > 0 ? recordCapacity : DefaultCapacity;
+    generations = keepGenerations > 0 ? keepGenerations : 1;
+
+    // Creating truncates: keep the previous run's records as <path>.1
+    if (HasRecords(path)) ShiftGenerations();
+    if (!CreateGeneration()) {
+        LOG_ERROR("Failed to create event log: " << path);
+        return false;
+    }
+    enabled.store(true, std::memory_order_relaxed);
+    LOG_INFO("Event log: " << path << " (" << capacity << " records)");
+    return true;
+}
+
+void EventLog::Close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled.store(false, std::memory_order_relaxed);
+    file.Flush();
+    file.Close();
+}
+
+bool EventLog::CreateGeneration() {
+    size_t bytes = sizeof(EventLogHeader) + static_cast<size_t>(capacity) * sizeof(ProtocolEvent);
+    if (!file.Create(path, bytes)) return false;
+
+    EventLogHeader* header = reinterpret_cast<EventLogHeader*>(file.Data());
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, RAZER_EVENTLOG_MAGIC, sizeof(header->magic));
+    header->version = RAZER_EVENTLOG_VERSION;
+    header->recordSize = sizeof(ProtocolEvent);
+    header->capacity = capacity;
+    header->count = 0;
+    header->wallClockBaseUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header->monotonicBaseUs = NowUs();
+    return true;
+}
+
+bool EventLog::HasRecords(const std::string& logPath) {
+    std::ifstream in(logPath, std::ios::binary);
+    EventLogHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    return memcmp(header.magic, RAZER_EVENTLOG_MAGIC, sizeof(header.magic)) == 0 && header.count > 0;
+}
+
+// <path>.N-1 -> <path>.N ... <path> -> <path>.1; the oldest falls off.
+void EventLog::ShiftGenerations() {
+    std::error_code ec;
+    if (generations > 1) {
+        std::filesystem::remove(path + "." + std::to_string(generations - 1), ec);
+        for (int i = generations - 2; i >= 1; i--) {
+            std::filesystem::rename(path + "." + std::to_string(i), path + "." + std::to_string(i + 1), ec);
+        }
+        std::filesystem::rename(path, path + ".1", ec);
+    }
+}
+
+void EventLog::Rotate() {
+    file.Flush();
+    file.Close();
+    ShiftGenerations();
+
+    if (!CreateGeneration()) {
+        enabled.store(false, std::memory_order_relaxed);
+        LOG_ERROR("Event log rotation failed, disabling: " << path);
+    }
+}
+
+void EventLog::Append(const ProtocolEvent& event) {
+    if (!IsEnabled()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.IsOpen()) return;
+
+    EventLogHeader* header = reinterpret_cast<EventLogHeader*>(file.Data());
+    if (header->count >= header->capacity) {
+        Rotate();
+        if (!file.IsOpen()) return;
+        header = reinterpret_cast<EventLogHeader*>(file.Data());
+    }
+
+    ProtocolEvent* records = reinterpret_cast<ProtocolEvent*>(file.Data() + sizeof(EventLogHeader));
+    records[header->count] = event;
+    // Bump the count only once the record body is in place
+    header->count = header->count + 1;
+}
@@ -0,0 +1,40 @@
+#include "IoQueue.h"
+#include <algorithm>
+
+const char* IoPriorityName(IoPriority priority) {
+    switch (priority) {
+    case IoPriority::Interactive: return "interactive";
+    case IoPriority::Alert: return "alert";
+    case IoPriority::Background: return "background";
+    }
+    return "unknown";
+}
+
+void DeviceIoQueue::Push(const std::shared_ptr<RazerDevice>& device, IoPriority priority) {
+    for (auto& entry : entries) {
+        if (entry.device != device) continue;
+        entry.priority = std::min(entry.priority, priority);
+        return;
+    }
+    entries.push_back({device, priority});
+}
+
+std::vector<std::shared_ptr<RazerDevice>> DeviceIoQueue::PopTop(IoPriority& priority) {
+    std::vector<std::shared_ptr<RazerDevice>> devices;
+    if (entries.empty()) return devices;
+    priority = std::min_element(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.priority < b.priority;
+    })->priority;
+    auto rest = std::stable_partition(entries.begin(), entries.end(), [&](const Entry& entry) {
+        return entry.priority == priority;
+    });
+    for (auto it = entries.begin(); it != rest; ++it) devices.push_back(std::move(it->device));
+    entries.erase(entries.begin(), rest);
+    return devices;
+}
+
+void DeviceIoQueue::Retain(const std::vector<std::shared_ptr<RazerDevice>>& devices) {
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+        return std::find(devices.begin(), devices.end(), entry.device) == devices.end();
+    }), entries.end());
+}
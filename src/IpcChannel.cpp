@@ -0,0 +1,311 @@
+#include "IpcChannel.h"
+#include "Logger.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <cstdlib>
+#else
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+bool IpcChannel::ReadLine(std::string& line) {
+    for (;;) {
+        size_t newline = readBuffer.find('\n');
+        if (newline != std::string::npos) {
+            line.assign(readBuffer, 0, newline);
+            readBuffer.erase(0, newline + 1);
+            return true;
+        }
+        // A peer that never sends a newline must not grow the buffer forever
+        if (readBuffer.size() > MaxLineBytes) return false;
+
+        char chunk[4096];
+        long n = 0;
+#ifdef _WIN32
+        unsigned long transferred = 0;
+        if (!Transfer(false, chunk, sizeof(chunk), transferred)) return false;
+        n = static_cast<long>(transferred);
+#else
+        if (interrupted.load()) return false;
+        n = static_cast<long>(recv(fd, chunk, sizeof(chunk), 0));
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) return false;
+        readBuffer.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+bool IpcChannel::WriteLine(const std::string& line) {
+    std::string data = line;
+    data += '\n';
+    size_t offset = 0;
+    while (offset < data.size()) {
+#ifdef _WIN32
+        unsigned long transferred = 0;
+        if (!Transfer(true, &data[offset], static_cast<unsigned long>(data.size() - offset), transferred)) return false;
+        offset += transferred;
+#else
+        if (interrupted.load()) return false;
+        ssize_t n = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        offset += static_cast<size_t>(n);
+#endif
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+// Pipes are opened for overlapped I/O so a blocked ReadFile does not
+// serialize WriteFile calls from another thread; each call still waits.
+IpcChannel::IpcChannel(void* pipe, bool serverSide) : pipe(pipe), serverSide(serverSide) {
+}
+
+IpcChannel::~IpcChannel() {
+    if (pipe) {
+        if (serverSide) DisconnectNamedPipe(pipe);
+        CloseHandle(pipe);
+    }
+}
+
+bool IpcChannel::Transfer(bool write, void* data, unsigned long length, unsigned long& transferred) {
+    if (interrupted.load()) return false;
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!overlapped.hEvent) return false;
+
+    BOOL ok = write ? WriteFile(pipe, data, length, NULL, &overlapped)
+                    : ReadFile(pipe, data, length, NULL, &overlapped);
+    if (!ok && GetLastError() != ERROR_IO_PENDING && GetLastError() != ERROR_MORE_DATA) {
+        CloseHandle(overlapped.hEvent);
+        return false;
+    }
+    DWORD n = 0;
+    ok = GetOverlappedResult(pipe, &overlapped, &n, TRUE);
+    CloseHandle(overlapped.hEvent);
+    transferred = n;
+    return (ok || GetLastError() == ERROR_MORE_DATA) && n > 0;
+}
+
+void IpcChannel::Interrupt() {
+    interrupted.store(true);
+    CancelIoEx(pipe, NULL);
+    // Fails I/O issued after the cancel as well
+    if (serverSide) DisconnectNamedPipe(pipe);
+}
+
+std::unique_ptr<IpcChannel> IpcChannel::Connect(const std::string& endpoint) {
+    std::wstring name(endpoint.begin(), endpoint.end());
+    for (int attempt = 0; attempt < 2; attempt++) {
+        HANDLE pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                                  OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            return std::unique_ptr<IpcChannel>(new IpcChannel(pipe, false));
+        }
+        // All instances busy: the server creates the next one right after Accept
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(name.c_str(), 1000)) break;
+    }
+    return nullptr;
+}
+
+std::string IpcListener::DefaultEndpoint() {
+    if (const char* overridden = getenv("RAZER_IPC_ENDPOINT")) return overridden;
+    return "\\\\.\\pipe\\RazerBattery";
+}
+
+void* IpcListener::CreateInstance(bool first) {
+    std::wstring name(endpoint.begin(), endpoint.end());
+    DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    LocalSecurityAttributes security(access, true);
+    HANDLE pipe = CreateNamedPipeW(name.c_str(), openMode,
+                                   PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                   PIPE_UNLIMITED_INSTANCES, 4096, 4096, 0, security.Get());
+    return pipe == INVALID_HANDLE_VALUE ? nullptr : pipe;
+}
+
+bool IpcListener::Listen(const std::string& path, LocalAccess endpointAccess) {
+    Close();
+    endpoint = path;
+    access = endpointAccess;
+    interrupted.store(false);
+
+    // FILE_FLAG_FIRST_PIPE_INSTANCE fails if another server owns the name
+    pendingPipe = CreateInstance(true);
+    if (!pendingPipe) {
+        LOG_ERROR("IPC: cannot create pipe " << endpoint << " (error " << (int)GetLastError() << ")");
+        return false;
+    }
+    stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    return stopEvent != nullptr;
+}
+
+std::unique_ptr<IpcChannel> IpcListener::Accept() {
+    while (!interrupted.load()) {
+        if (!pendingPipe) pendingPipe = CreateInstance(false);
+        if (!pendingPipe) return nullptr;
+
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+        if (!overlapped.hEvent) return nullptr;
+
+        bool connected = ConnectNamedPipe(pendingPipe, &overlapped) != FALSE;
+        DWORD error = GetLastError();
+        if (!connected && error == ERROR_PIPE_CONNECTED) {
+            connected = true;
+        } else if (!connected && error == ERROR_IO_PENDING) {
+            HANDLE events[] = {overlapped.hEvent, stopEvent};
+            DWORD which = WaitForMultipleObjects(2, events, FALSE, INFINITE);
+            if (which == WAIT_OBJECT_0) {
+                DWORD unused = 0;
+                connected = GetOverlappedResult(pendingPipe, &overlapped, &unused, FALSE) != FALSE;
+            } else {
+                CancelIoEx(pendingPipe, &overlapped);
+                DWORD unused = 0;
+                GetOverlappedResult(pendingPipe, &overlapped, &unused, TRUE);
+            }
+        }
+        CloseHandle(overlapped.hEvent);
+
+        if (connected) {
+            void* pipe = pendingPipe;
+            pendingPipe = nullptr;
+            return std::unique_ptr<IpcChannel>(new IpcChannel(pipe, true));
+        }
+        // Client gave up between connect and accept; recycle the instance
+        DisconnectNamedPipe(pendingPipe);
+    }
+    return nullptr;
+}
+
+void IpcListener::Interrupt() {
+    interrupted.store(true);
+    if (stopEvent) SetEvent(stopEvent);
+}
+
+void IpcListener::Close() {
+    if (pendingPipe) {
+        CloseHandle(pendingPipe);
+        pendingPipe = nullptr;
+    }
+    if (stopEvent) {
+        CloseHandle(stopEvent);
+        stopEvent = nullptr;
+    }
+}
+
+#else
+
+IpcChannel::IpcChannel(int fd) : fd(fd) {
+}
+
+IpcChannel::~IpcChannel() {
+    if (fd >= 0) close(fd);
+}
+
+void IpcChannel::Interrupt() {
+    interrupted.store(true);
+    shutdown(fd, SHUT_RDWR);
+}
+
+static bool MakeAddress(const std::string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+std::unique_ptr<IpcChannel> IpcChannel::Connect(const std::string& endpoint) {
+    sockaddr_un address;
+    if (!MakeAddress(endpoint, address)) return nullptr;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return nullptr;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    return std::unique_ptr<IpcChannel>(new IpcChannel(fd));
+}
+
+std::string IpcListener::DefaultEndpoint() {
+    if (const char* overridden = getenv("RAZER_IPC_ENDPOINT")) return overridden;
+
+    // A system-wide poller serves every user from one well-known socket
+    const char* systemEndpoint = "/run/razerbattery.sock";
+    if (geteuid() == 0 || ::access(systemEndpoint, F_OK) == 0) return systemEndpoint;
+
+    const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) return std::string(runtimeDir) + "/razerbattery.sock";
+    return "/tmp/razerbattery-" + std::to_string(getuid()) + ".sock";
+}
+
+bool IpcListener::Listen(const std::string& path, LocalAccess endpointAccess) {
+    Close();
+    endpoint = path;
+    access = endpointAccess;
+    interrupted.store(false);
+
+    sockaddr_un address;
+    if (!MakeAddress(endpoint, address)) return false;
+
+    // A socket file left by a crashed server is removed; a live one is not
+    if (auto existing = IpcChannel::Connect(endpoint)) {
+        LOG_ERROR("IPC: another server is already listening on " << endpoint);
+        return false;
+    }
+    unlink(endpoint.c_str());
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    // Owner-only, like the per-user runtime directory it normally lives
+    // in, unless every local user is meant to connect
+    mode_t oldMask = umask(077);
+    int r = bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    umask(oldMask);
+    if (r == 0 && access == LocalAccess::AllUsers) r = chmod(endpoint.c_str(), 0666);
+    if (r != 0 || listen(fd, 16) != 0) {
+        LOG_ERROR("IPC: cannot listen on " << endpoint << " (errno " << errno << ")");
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<IpcChannel> IpcListener::Accept() {
+    while (!interrupted.load()) {
+        int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client >= 0) return std::unique_ptr<IpcChannel>(new IpcChannel(client));
+        if (errno != EINTR && errno != ECONNABORTED) break;
+    }
+    return nullptr;
+}
+
+void IpcListener::Interrupt() {
+    interrupted.store(true);
+    // Wakes a blocked accept() on Linux
+    if (fd >= 0) shutdown(fd, SHUT_RDWR);
+}
+
+void IpcListener::Close() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+        unlink(endpoint.c_str());
+    }
+}
+
+#endif
+
+IpcListener::~IpcListener() {
+    Close();
+}
@@ -0,0 +1,181 @@
+#include "IpcServer.h"
+#include "Logger.h"
+
+IpcServer::IpcServer(DeviceStatusStore& store) : store(store) {
+}
+
+IpcServer::~IpcServer() {
+    Stop();
+}
+
+bool IpcServer::Start(const std::string& endpoint, LocalAccess access) {
+    if (running) return true;
+    if (!listener.Listen(endpoint, access)) return false;
+
+    subscription = store.Subscribe([this](uint64_t) { OnStoreChanged(); });
+    acceptThread = std::thread(&IpcServer::AcceptLoop, this);
+    running = true;
+    LOG_INFO("IPC: serving device status on " << endpoint);
+    return true;
+}
+
+void IpcServer::Stop() {
+    if (!running) return;
+    running = false;
+
+    store.Unsubscribe(subscription);
+    listener.Interrupt();
+    acceptThread.join();
+    listener.Close();
+
+    std::vector<std::unique_ptr<Client>> remaining;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        remaining.swap(clients);
+    }
+    for (auto& client : remaining) {
+        CloseClient(*client);
+        client->reader.join();
+        client->writer.join();
+    }
+}
+
+size_t IpcServer::GetClientCount() {
+    ReapClosedClients();
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    return clients.size();
+}
+
+void IpcServer::AcceptLoop() {
+    while (auto channel = listener.Accept()) {
+        ReapClosedClients();
+
+        auto client = std::make_unique<Client>();
+        client->channel = std::move(channel);
+
+        // Threads are assigned under the lock the reaper scans with
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        client->reader = std::thread(&IpcServer::ReadLoop, this, client.get());
+        client->writer = std::thread(&IpcServer::WriteLoop, this, client.get());
+        clients.push_back(std::move(client));
+    }
+}
+
+void IpcServer::ReadLoop(Client* client) {
+    std::string line;
+    while (client->channel->ReadLine(line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (line == "get") {
+            Enqueue(*client, SnapshotMessage("snapshot"));
+        } else if (line == "refresh") {
+            bool accepted = refreshHandler && refreshHandler();
+            Enqueue(*client, accepted ? "{\"type\":\"refresh\",\"accepted\":true}"
+                                      : "{\"type\":\"refresh\",\"accepted\":false}");
+        } else if (line == "subscribe") {
+            // Queue the snapshot under the client lock so every change
+            // notification lands after it (possibly repeating its version)
+            std::lock_guard<std::mutex> lock(client->mutex);
+            client->subscribed = true;
+            client->outbox.push_back(SnapshotMessage("snapshot"));
+            client->cv.notify_one();
+        } else if (!line.empty()) {
+            Enqueue(*client, "{\"type\":\"error\",\"message\":\"unknown command\"}");
+        }
+    }
+    CloseClient(*client);
+}
+
+void IpcServer::WriteLoop(Client* client) {
+    for (;;) {
+        std::string message;
+        {
+            std::unique_lock<std::mutex> lock(client->mutex);
+            client->cv.wait(lock, [client] { return client->closed || !client->outbox.empty(); });
+            if (client->closed) return;
+            message = std::move(client->outbox.front());
+            client->outbox.pop_front();
+        }
+        if (!client->channel->WriteLine(message)) {
+            CloseClient(*client);
+            return;
+        }
+    }
+}
+
+void IpcServer::Enqueue(Client& client, std::string message) {
+    {
+        std::lock_guard<std::mutex> lock(client.mutex);
+        if (client.closed) return;
+        if (client.outbox.size() < MaxQueuedMessages) {
+            client.outbox.push_back(std::move(message));
+            client.cv.notify_one();
+            return;
+        }
+    }
+    LOG_ERROR("IPC: client stopped reading, disconnecting it");
+    CloseClient(client);
+}
+
+void IpcServer::CloseClient(Client& client) {
+    {
+        std::lock_guard<std::mutex> lock(client.mutex);
+        if (client.closed) return;
+        client.closed = true;
+        client.cv.notify_all();
+    }
+    client.channel->Interrupt();
+}
+
+void IpcServer::ReapClosedClients() {
+    std::vector<std::unique_ptr<Client>> closed;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto it = clients.begin(); it != clients.end();) {
+            bool isClosed;
+            {
+                std::lock_guard<std::mutex> clientLock((*it)->mutex);
+                isClosed = (*it)->closed;
+            }
+            if (isClosed) {
+                closed.push_back(std::move(*it));
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& client : closed) {
+        client->reader.join();
+        client->writer.join();
+    }
+}
+
+void IpcServer::OnStoreChanged() {
+    Broadcast(SnapshotMessage("changed"));
+}
+
+void IpcServer::Broadcast(const std::string& message) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (auto& client : clients) {
+        bool subscribed;
+        {
+            std::lock_guard<std::mutex> clientLock(client->mutex);
+            subscribed = client->subscribed && !client->closed;
+        }
+        if (subscribed) Enqueue(*client, message);
+    }
+}
+
+std::string IpcServer::SnapshotMessage(const char* type) {
+    DeviceSnapshotPtr snapshot = store.GetSnapshot();
+
+    std::string message = "{\"type\":\"";
+    message += type;
+    message += "\",\"version\":";
+    message += std::to_string(snapshot->version);
+    message += ",\"devices\":";
+    AppendJson(message, snapshot->devices);
+    message += '}';
+    return message;
+}
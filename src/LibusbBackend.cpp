@@ -0,0 +1,283 @@
+#include "LibusbBackend.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <libusb.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// libusb's event loop for posted interrupt reads, on a thread of its own
+// started by the first listener. Synchronous control transfers do not
+// need it; they run the loop themselves while they wait.
+class LibusbEventThread {
+public:
+    explicit LibusbEventThread(libusb_context* ctx) : ctx(ctx) {}
+    ~LibusbEventThread() {
+        if (!thread.joinable()) return;
+        stopping.store(true);
+        libusb_interrupt_event_handler(ctx);
+        thread.join();
+    }
+
+    void Start() {
+        std::call_once(started, [this] {
+            thread = std::thread([this] {
+                while (!stopping.load()) {
+                    timeval timeout = {1, 0};
+                    libusb_handle_events_timeout_completed(ctx, &timeout, nullptr);
+                }
+            });
+        });
+    }
+
+private:
+    libusb_context* ctx;
+    std::once_flag started;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+namespace {
+
+class LibusbDeviceHandle : public UsbDeviceHandle {
+public:
+    LibusbDeviceHandle(libusb_device_handle* handle, LibusbEventThread* events) : handle(handle), events(events) {}
+    ~LibusbDeviceHandle() override {
+        StopListening();
+        libusb_close(handle);
+    }
+
+    int ClaimInterface(int iface) override { return libusb_claim_interface(handle, iface); }
+    int ReleaseInterface(int iface) override { return libusb_release_interface(handle, iface); }
+
+    int ControlTransfer(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+                        unsigned char* data, uint16_t length, unsigned int timeoutMs) override {
+        return libusb_control_transfer(handle, requestType, request, value, index, data, length, timeoutMs);
+    }
+
+    // libusb_get_string_descriptor_ascii with the caller's timeout in place
+    // of its fixed 1 s: first language ID, then the UTF-16LE string, with
+    // non-ASCII characters replaced by '?'. The string read gets what the
+    // language ID read left of timeoutMs.
+    int GetStringDescriptorAscii(uint8_t index, unsigned char* data, int length, unsigned int timeoutMs) override {
+        if (length <= 0) return LIBUSB_ERROR_INVALID_PARAM;
+        const auto start = std::chrono::steady_clock::now();
+        unsigned char buffer[255];
+        int r = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN, LIBUSB_REQUEST_GET_DESCRIPTOR,
+                                        LIBUSB_DT_STRING << 8, 0, buffer, sizeof(buffer), timeoutMs);
+        if (r < 0) return r;
+        if (r < 4) return LIBUSB_ERROR_IO;
+        uint16_t langId = static_cast<uint16_t>(buffer[2] | (buffer[3] << 8));
+
+        auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        // libusb reads a 0 timeout as "wait forever"
+        if (spent >= static_cast<long long>(timeoutMs)) return LIBUSB_ERROR_TIMEOUT;
+        r = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN, LIBUSB_REQUEST_GET_DESCRIPTOR,
+                                    static_cast<uint16_t>((LIBUSB_DT_STRING << 8) | index), langId,
+                                    buffer, sizeof(buffer), timeoutMs - static_cast<unsigned int>(spent));
+        if (r < 0) return r;
+        if (r < 2 || buffer[1] != LIBUSB_DT_STRING || buffer[0] > r) return LIBUSB_ERROR_IO;
+
+        int out = 0;
+        for (int i = 2; i + 1 < buffer[0] && out < length - 1; i += 2) {
+            data[out++] = (buffer[i] & 0x80) || buffer[i + 1] ? '?' : buffer[i];
+        }
+        data[out] = 0;
+        return out;
+    }
+
+    int StartListening(int iface, UsbReportCallback onReport) override {
+        if (transfer) return LIBUSB_ERROR_BUSY;
+        uint8_t endpoint = 0;
+        int packetSize = 0;
+        if (!FindInterruptIn(iface, endpoint, packetSize)) return LIBUSB_ERROR_NOT_FOUND;
+        transfer = libusb_alloc_transfer(0);
+        if (!transfer) return LIBUSB_ERROR_NO_MEM;
+
+        // One packet per read: each HID report arrives on its own
+        buffer.assign(packetSize, 0);
+        callback = std::move(onReport);
+        libusb_fill_interrupt_transfer(transfer, handle, endpoint, buffer.data(), packetSize, OnTransfer, this, 0);
+        std::lock_guard<std::mutex> lock(listenMutex);
+        cancelling = false;
+        int r = libusb_submit_transfer(transfer);
+        if (r != 0) {
+            libusb_free_transfer(transfer);
+            transfer = nullptr;
+            return r;
+        }
+        posted = true;
+        events->Start();
+        return 0;
+    }
+
+    void StopListening() override {
+        if (!transfer) return;
+        {
+            std::unique_lock<std::mutex> lock(listenMutex);
+            cancelling = true;
+            if (posted) libusb_cancel_transfer(transfer);
+            listenDone.wait(lock, [this] { return !posted; });
+        }
+        libusb_free_transfer(transfer);
+        transfer = nullptr;
+        callback = nullptr;
+    }
+
+private:
+    libusb_device_handle* handle;
+    LibusbEventThread* events;
+
+    // The posted interrupt read. `posted` and `cancelling` are guarded by
+    // listenMutex; the rest belongs to whoever started listening.
+    libusb_transfer* transfer = nullptr;
+    std::vector<unsigned char> buffer;
+    UsbReportCallback callback;
+    std::mutex listenMutex;
+    std::condition_variable listenDone;
+    bool posted = false;
+    bool cancelling = false;
+
+    bool FindInterruptIn(int iface, uint8_t& endpoint, int& packetSize) {
+        libusb_config_descriptor* config = nullptr;
+        if (libusb_get_active_config_descriptor(libusb_get_device(handle), &config) != 0 || !config) return false;
+        for (int i = 0; i < config->bNumInterfaces && packetSize == 0; i++) {
+            const libusb_interface& intf = config->interface[i];
+            if (intf.num_altsetting < 1 || intf.altsetting[0].bInterfaceNumber != iface) continue;
+            const libusb_interface_descriptor& alt = intf.altsetting[0];
+            for (int e = 0; e < alt.bNumEndpoints; e++) {
+                const libusb_endpoint_descriptor& ep = alt.endpoint[e];
+                if ((ep.bmAttributes & 0x03) == LIBUSB_TRANSFER_TYPE_INTERRUPT && (ep.bEndpointAddress & LIBUSB_ENDPOINT_IN)) {
+                    endpoint = ep.bEndpointAddress;
+                    packetSize = ep.wMaxPacketSize & 0x7FF;
+                    break;
+                }
+            }
+        }
+        libusb_free_config_descriptor(config);
+        return packetSize > 0;
+    }
+
+    // On the event thread. Hands the report over, then posts the read
+    // again unless StopListening is waiting for it.
+    static void LIBUSB_CALL OnTransfer(libusb_transfer* completed) {
+        auto* self = static_cast<LibusbDeviceHandle*>(completed->user_data);
+        int error = 0;
+        switch (completed->status) {
+        case LIBUSB_TRANSFER_COMPLETED:
+            self->callback(completed->buffer, completed->actual_length);
+            break;
+        case LIBUSB_TRANSFER_TIMED_OUT:
+        case LIBUSB_TRANSFER_CANCELLED:
+            break;
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            error = LIBUSB_ERROR_NO_DEVICE;
+            break;
+        default:
+            error = LIBUSB_ERROR_IO;
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(self->listenMutex);
+        if (!self->cancelling && error == 0) {
+            error = libusb_submit_transfer(completed);
+            if (error == 0) return;
+        }
+        bool failed = !self->cancelling && error != 0;
+        if (failed) {
+            // Still posted while the callback runs, so StopListening waits
+            // for it before freeing the transfer or the handle
+            lock.unlock();
+            LOG_ERROR("Interrupt listening stopped: " << libusb_error_name(error));
+            self->callback(nullptr, error);
+            lock.lock();
+        }
+        self->posted = false;
+        self->listenDone.notify_all();
+    }
+};
+
+class LibusbDevice : public UsbDevice {
+public:
+    LibusbDevice(libusb_device* device, const libusb_device_descriptor& desc, LibusbEventThread* events)
+        : device(libusb_ref_device(device)), desc(desc), events(events) {}
+    ~LibusbDevice() override { libusb_unref_device(device); }
+
+    uint16_t GetVendorId() const override { return desc.idVendor; }
+    uint16_t GetProductId() const override { return desc.idProduct; }
+    uint8_t GetSerialNumberIndex() const override { return desc.iSerialNumber; }
+    uint8_t GetBusNumber() const override { return libusb_get_bus_number(device); }
+    uint8_t GetAddress() const override { return libusb_get_device_address(device); }
+
+    int GetInterfaceCount() override {
+        libusb_config_descriptor* config = nullptr;
+        if (libusb_get_active_config_descriptor(device, &config) != 0 || !config) return 0;
+        int count = config->bNumInterfaces;
+        libusb_free_config_descriptor(config);
+        return count;
+    }
+
+    std::unique_ptr<UsbDeviceHandle> Open(int& error) override {
+        TRACE_SCOPE("libusb_open");
+        libusb_device_handle* handle = nullptr;
+        error = libusb_open(device, &handle);
+        if (error != 0) return nullptr;
+
+        if (libusb_has_capability(LIBUSB_CAP_SUPPORTS_DETACH_KERNEL_DRIVER)) {
+            libusb_set_auto_detach_kernel_driver(handle, 1);
+        }
+        return std::make_unique<LibusbDeviceHandle>(handle, events);
+    }
+
+private:
+    libusb_device* device;
+    libusb_device_descriptor desc;
+    LibusbEventThread* events;
+};
+
+} // namespace
+
+LibusbBackend::LibusbBackend() : ctx(nullptr) {
+    int r = libusb_init(&ctx);
+    if (r < 0) {
+        LOG_ERROR("libusb_init failed: " << libusb_error_name(r));
+        ctx = nullptr;
+    } else {
+        // Optional: Set debug level
+        // libusb_set_option(ctx, LIBUSB_OPTION_LOG_LEVEL, LIBUSB_LOG_LEVEL_WARNING);
+        events = std::make_unique<LibusbEventThread>(ctx);
+    }
+}
+
+LibusbBackend::~LibusbBackend() {
+    events.reset();
+    if (ctx) {
+        libusb_exit(ctx);
+        ctx = nullptr;
+    }
+}
+
+std::vector<std::shared_ptr<UsbDevice>> LibusbBackend::ListDevices() {
+    std::vector<std::shared_ptr<UsbDevice>> result;
+    if (!ctx) return result;
+
+    libusb_device** list;
+    ssize_t cnt = libusb_get_device_list(ctx, &list);
+    if (cnt < 0) {
+        LOG_ERROR("libusb_get_device_list failed: " << libusb_error_name((int)cnt));
+        return result;
+    }
+
+    for (ssize_t i = 0; i < cnt; i++) {
+        struct libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(list[i], &desc) == 0) {
+            result.push_back(std::make_shared<LibusbDevice>(list[i], desc, events.get()));
+        }
+    }
+
+    libusb_free_device_list(list, 1); // Unref devices in list; LibusbDevice holds its own ref
+    return result;
+}
@@ -1,43 +1,281 @@
 #include "Logger.h"
 #include <iostream>
 #include <filesystem>
-#include <windows.h>
+#include <cstdlib>
+#include <cstdio>
+#ifdef RAZER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static int LevelFromEnvironment() {
+    const char* env = std::getenv("RAZER_LOG_LEVEL");
+    return static_cast<int>(env ? Logger::ParseLevel(env, LogLevel::Info) : LogLevel::Info);
+}
+
+std::atomic<int> Logger::runtimeLevel{LevelFromEnvironment()};
 
 Logger& Logger::Instance() {
     static Logger instance;
     return instance;
 }
 
+LogLevel Logger::ParseLevel(std::string_view name, LogLevel fallback) {
+    if (name == "debug" || name == "DEBUG") return LogLevel::Debug;
+    if (name == "info" || name == "INFO") return LogLevel::Info;
+    if (name == "error" || name == "ERROR") return LogLevel::Error;
+    if (name == "off" || name == "OFF") return LogLevel::Off;
+    return fallback;
+}
+
 Logger::Logger() {
+    // File open and all writes happen on the writer thread
+    writer = std::thread(&Logger::WriterThread, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void Logger::Log(LogLevel level, std::string_view message) {
+    Entry entry{std::time(nullptr), level, std::string(message)};
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (queue.size() >= MaxQueuedEntries) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queue.push_back(std::move(entry));
+    }
+    queueCv.notify_one();
+}
+
+void Logger::SetRotationPolicy(const LogRotationPolicy& newPolicy) {
+    LogRotationPolicy p = newPolicy;
+    if (p.generations < 1) p.generations = 1;
+    if (p.maxFileBytes < 64 * 1024) p.maxFileBytes = 64 * 1024;
+    // Always leave room for the active file plus at least one generation
+    if (p.maxTotalBytes < 2 * p.maxFileBytes) p.maxTotalBytes = 2 * p.maxFileBytes;
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    policy = p;
+}
+
+std::string Logger::GetDirectory() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    openedCv.wait(lock, [this] { return opened; });
+    std::filesystem::path dir = std::filesystem::path(logPath).parent_path();
+    return dir.empty() ? std::string(".") : dir.string();
+}
+
+static std::string& LogFileName() {
+    static std::string name = "RazerBatteryTray.log";
+    return name;
+}
+
+void Logger::SetFileName(const std::string& name) {
+    LogFileName() = name;
+}
+
+bool Logger::OpenLogFile() {
     // Log to current working directory
-    std::string logPath = "RazerBatteryTray.log";
+    std::string path = LogFileName();
 
-    logFile.open(logPath, std::ios::app);
+    logFile.open(path, std::ios::app | std::ios::binary);
     if (!logFile.is_open()) {
         // Fallback to temp if current dir is not writable (e.g. Program Files)
-        char path[MAX_PATH];
-        GetTempPathA(MAX_PATH, path);
-        logPath = std::string(path) + "RazerBatteryTray.log";
-        logFile.open(logPath, std::ios::app);
+        std::error_code ec;
+        path = (std::filesystem::temp_directory_path(ec) / LogFileName()).string();
+        logFile.open(path, std::ios::app | std::ios::binary);
+    }
+
+    std::error_code ec;
+    fileBytes = logFile.is_open() ? std::filesystem::file_size(path, ec) : 0;
+    if (ec) fileBytes = 0;
+    fileOpened = std::chrono::system_clock::now();
+
+    // A log left over from a previous run counts as old as its last write
+    auto lastWrite = std::filesystem::last_write_time(path, ec);
+    if (!ec && fileBytes > 0) {
+        auto age = std::filesystem::file_time_type::clock::now() - lastWrite;
+        fileOpened -= std::chrono::duration_cast<std::chrono::system_clock::duration>(age);
     }
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    logPath = path;
+    return logFile.is_open();
 }
 
-Logger::~Logger() {
-    if (logFile.is_open()) {
-        logFile.close();
+void Logger::WriterThread() {
+    OpenLogFile();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        opened = true;
+    }
+    openedCv.notify_all();
+
+    std::vector<Entry> batch;
+    for (;;) {
+        bool exit = false;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCv.wait(lock, [this] { return stopping || !queue.empty(); });
+            batch.swap(queue);
+            exit = stopping;
+        }
+
+        for (const auto& entry : batch) {
+            WriteEntry(entry);
+        }
+        batch.clear();
+        if (logFile.is_open()) logFile.flush();
+
+        if (exit) break;
     }
 }
 
-void Logger::Log(const std::string& level, const std::string& message) {
-    std::lock_guard<std::mutex> lock(logMutex);
+void Logger::WriteEntry(const Entry& entry) {
+    static const char* const names[] = {"DEBUG", "INFO", "ERROR", "OFF"};
+
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &entry.time);
+#else
+    localtime_r(&entry.time, &timeinfo);
+#endif
+    char buf[20];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
+
+    std::string line;
+    line.reserve(entry.message.size() + 40);
+    line += "[";
+    line += buf;
+    line += "] [";
+    line += names[static_cast<int>(entry.level)];
+    line += "] ";
+    line += entry.message;
+    line += '\n';
+
+    RotateIfNeeded(line.size());
     if (logFile.is_open()) {
-        std::time_t now = std::time(nullptr);
-        struct tm timeinfo;
-        localtime_s(&timeinfo, &now);
-        char buf[20];
-        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
-
-        logFile << "[" << buf << "] [" << level << "] " << message << std::endl;
-        logFile.flush();
+        logFile.write(line.data(), static_cast<std::streamsize>(line.size()));
+        fileBytes += line.size();
+    }
+}
+
+std::string Logger::GenerationPath(int index, bool compressed) const {
+    std::string path = logPath + "." + std::to_string(index);
+    if (compressed) path += ".gz";
+    return path;
+}
+
+void Logger::RotateIfNeeded(size_t nextLineBytes) {
+    if (!logFile.is_open()) return;
+
+    LogRotationPolicy p;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        p = policy;
+    }
+
+    bool tooBig = fileBytes > 0 && fileBytes + nextLineBytes > p.maxFileBytes;
+    bool tooOld = std::chrono::system_clock::now() - fileOpened > p.maxAge;
+    if (tooBig || (tooOld && fileBytes > 0)) {
+        Rotate();
+    }
+}
+
+void Logger::Rotate() {
+    LogRotationPolicy p;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        p = policy;
+    }
+
+    logFile.close();
+
+    // .N-1 -> .N ... .1 -> .2, whichever of plain/.gz exists; the oldest falls off
+    std::error_code ec;
+    std::filesystem::remove(GenerationPath(p.generations, false), ec);
+    std::filesystem::remove(GenerationPath(p.generations, true), ec);
+    for (int i = p.generations - 1; i >= 1; i--) {
+        for (bool compressed : {false, true}) {
+            if (std::filesystem::exists(GenerationPath(i, compressed), ec)) {
+                std::filesystem::rename(GenerationPath(i, compressed), GenerationPath(i + 1, compressed), ec);
+            }
+        }
+    }
+    std::filesystem::rename(logPath, GenerationPath(1, false), ec);
+
+    logFile.open(logPath, std::ios::out | std::ios::trunc | std::ios::binary);
+    fileBytes = 0;
+    fileOpened = std::chrono::system_clock::now();
+
+    // Compression runs here, on the writer thread; callers only ever queue
+    if (p.compress) {
+        CompressGeneration(GenerationPath(1, false));
+    }
+    EnforceTotalCap();
+}
+
+void Logger::CompressGeneration(const std::string& path) {
+#ifdef RAZER_HAVE_ZLIB
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) return;
+
+    std::string gzPath = path + ".gz";
+    gzFile out = gzopen(gzPath.c_str(), "wb6");
+    if (!out) {
+        fclose(in);
+        return;
+    }
+
+    char buf[64 * 1024];
+    bool ok = true;
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        if (gzwrite(out, buf, static_cast<unsigned>(n)) != static_cast<int>(n)) {
+            ok = false;
+            break;
+        }
+    }
+    fclose(in);
+    if (gzclose(out) != Z_OK) ok = false;
+
+    std::error_code ec;
+    std::filesystem::remove(ok ? path : gzPath, ec);
+#else
+    (void)path;
+#endif
+}
+
+void Logger::EnforceTotalCap() {
+    LogRotationPolicy p;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        p = policy;
+    }
+
+    // The active file may grow up to maxFileBytes; generations share the rest
+    uint64_t budget = p.maxTotalBytes - p.maxFileBytes;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (int i = 1; i <= p.generations; i++) {
+        for (bool compressed : {false, true}) {
+            std::string path = GenerationPath(i, compressed);
+            uint64_t size = std::filesystem::file_size(path, ec);
+            if (ec) continue;
+            if (total + size > budget) {
+                std::filesystem::remove(path, ec);
+            } else {
+                total += size;
+            }
+        }
     }
 }
@@ -0,0 +1,224 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Create(const std::string& path, size_t createSize) {
+    return Map(path, createSize, true, true);
+}
+
+bool MappedFile::OpenExisting(const std::string& path) {
+    return Map(path, 0, false, true);
+}
+
+bool MappedFile::OpenReadOnly(const std::string& path) {
+    return Map(path, 0, false, false);
+}
+
+bool MappedFile::CreateShared(const std::string& name, size_t createSize, LocalAccess access) {
+    return MapShared(name, createSize, true, access);
+}
+
+bool MappedFile::OpenSharedReadOnly(const std::string& name) {
+    return MapShared(name, 0, false, LocalAccess::CurrentUser);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Map(const std::string& path, size_t createSize, bool create, bool writable) {
+    Close();
+
+    DWORD access = writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+    HANDLE file = CreateFileA(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (create) {
+        fileSize.QuadPart = static_cast<LONGLONG>(createSize);
+    } else if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        fileSize.HighPart, fileSize.LowPart, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = view;
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+bool MappedFile::MapShared(const std::string& name, size_t createSize, bool create, LocalAccess access) {
+    Close();
+
+    LocalSecurityAttributes security(access, false);
+    HANDLE mapping = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, security.Get(), PAGE_READWRITE,
+                             static_cast<DWORD>(static_cast<uint64_t>(createSize) >> 32),
+                             static_cast<DWORD>(createSize), name.c_str())
+        : OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (!mapping) return false;
+
+    void* view = MapViewOfFile(mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    // Sections are page-granular; the region size is what we can address
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQuery(view, &info, sizeof(info)) == 0) {
+        UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mappingHandle = mapping;
+    data = view;
+    size = create ? createSize : static_cast<size_t>(info.RegionSize);
+    return true;
+}
+
+void MappedFile::RemoveShared(const std::string&) {
+}
+
+void MappedFile::Flush() {
+    if (data) {
+        FlushViewOfFile(data, 0);
+    }
+}
+
+void MappedFile::Close() {
+    if (data) {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+    size = 0;
+}
+
+#else
+
+bool MappedFile::Map(const std::string& path, size_t createSize, bool create, bool writable) {
+    Close();
+
+    int flags = writable ? O_RDWR : O_RDONLY;
+    if (create) flags |= O_CREAT | O_TRUNC;
+    int file = open(path.c_str(), flags, 0644);
+    if (file < 0) return false;
+
+    size_t mapSize = createSize;
+    if (create) {
+        if (ftruncate(file, static_cast<off_t>(createSize)) != 0) {
+            close(file);
+            return false;
+        }
+    } else {
+        struct stat st;
+        if (fstat(file, &st) != 0 || st.st_size == 0) {
+            close(file);
+            return false;
+        }
+        mapSize = static_cast<size_t>(st.st_size);
+    }
+
+    void* view = mmap(nullptr, mapSize, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        close(file);
+        return false;
+    }
+
+    fd = file;
+    data = view;
+    size = mapSize;
+    return true;
+}
+
+bool MappedFile::MapShared(const std::string& name, size_t createSize, bool create, LocalAccess access) {
+    Close();
+
+    int file = shm_open(name.c_str(), create ? (O_RDWR | O_CREAT) : O_RDONLY, 0600);
+    if (file < 0) return false;
+
+    size_t mapSize = createSize;
+    if (create) {
+        // fchmod because the umask applies to shm_open's mode as well
+        mode_t mode = access == LocalAccess::AllUsers ? 0644 : 0600;
+        if (fchmod(file, mode) != 0 || ftruncate(file, static_cast<off_t>(createSize)) != 0) {
+            close(file);
+            return false;
+        }
+    } else {
+        struct stat st;
+        if (fstat(file, &st) != 0 || st.st_size == 0) {
+            close(file);
+            return false;
+        }
+        mapSize = static_cast<size_t>(st.st_size);
+    }
+
+    void* view = mmap(nullptr, mapSize, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        close(file);
+        return false;
+    }
+
+    fd = file;
+    data = view;
+    size = mapSize;
+    return true;
+}
+
+void MappedFile::RemoveShared(const std::string& name) {
+    shm_unlink(name.c_str());
+}
+
+void MappedFile::Flush() {
+    if (data) {
+        msync(data, size, MS_ASYNC);
+    }
+}
+
+void MappedFile::Close() {
+    if (data) {
+        munmap(data, size);
+        data = nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    size = 0;
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "Metrics.h"
+#include "EventLog.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+
+uint64_t LatencyHistogram::BucketLowerBound(int bucket) {
+    if (bucket < SubBuckets) return static_cast<uint64_t>(bucket);
+    int shift = bucket / SubBuckets - 1;
+    return static_cast<uint64_t>(SubBuckets + bucket % SubBuckets) << shift;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int bucket) {
+    if (bucket < SubBuckets) return static_cast<uint64_t>(bucket) + 1;
+    int shift = bucket / SubBuckets - 1;
+    return static_cast<uint64_t>(SubBuckets + bucket % SubBuckets + 1) << shift;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Read() const {
+    Snapshot s;
+    for (int i = 0; i < BucketCount; i++) {
+        s.counts[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+uint64_t LatencyHistogram::Snapshot::Count() const {
+    uint64_t total = 0;
+    for (uint64_t c : counts) total += c;
+    return total;
+}
+
+uint64_t LatencyHistogram::Snapshot::Percentile(double p) const {
+    uint64_t total = Count();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::clamp(p, 0.0, 1.0) * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        seen += counts[i];
+        if (seen >= rank) return BucketUpperBound(i);
+    }
+    return BucketUpperBound(BucketCount - 1);
+}
+
+void LatencyHistogram::Snapshot::Merge(const Snapshot& other) {
+    for (int i = 0; i < BucketCount; i++) counts[i] += other.counts[i];
+}
+
+MetricsRegistry& MetricsRegistry::Instance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+static uint64_t HashKey(std::string_view key) {
+    // FNV-1a; 0 is reserved for "free slot"
+    uint64_t h = 1469598103934665603ull;
+    for (char c : key) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+DeviceMetrics& MetricsRegistry::ForDevice(std::string_view key) {
+    uint64_t h = HashKey(key);
+    size_t start = static_cast<size_t>(h % MaxDevices);
+    for (size_t n = 0; n < MaxDevices; n++) {
+        DeviceSlot& slot = devices[(start + n) % MaxDevices];
+        uint64_t current = slot.hash.load(std::memory_order_acquire);
+        if (current == h) return slot.metrics;
+        if (current == 0) {
+            uint64_t expected = 0;
+            if (slot.hash.compare_exchange_strong(expected, h, std::memory_order_acq_rel)) {
+                size_t len = std::min(key.size(), MaxKeyLength);
+                memcpy(slot.key, key.data(), len);
+                slot.key[len] = '\0';
+                slot.ready.store(true, std::memory_order_release);
+                return slot.metrics;
+            }
+            if (expected == h) return slot.metrics;
+        }
+    }
+    return deviceOverflow;
+}
+
+ProtocolMetrics& MetricsRegistry::ForProtocol(int interfaceNumber, uint8_t strategy, uint8_t transactionId,
+                                              uint8_t commandClass, uint8_t commandId) {
+    uint64_t packed = (static_cast<uint64_t>(static_cast<uint8_t>(interfaceNumber)) << 32) |
+                      (static_cast<uint64_t>(strategy) << 24) |
+                      (static_cast<uint64_t>(transactionId) << 16) |
+                      (static_cast<uint64_t>(commandClass) << 8) |
+                      static_cast<uint64_t>(commandId);
+    uint64_t key = packed + 1;
+    size_t start = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) % MaxProtocolEntries;
+    for (size_t n = 0; n < MaxProtocolEntries; n++) {
+        ProtocolSlot& slot = protocol[(start + n) % MaxProtocolEntries];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == key) return slot.metrics;
+        if (current == 0) {
+            uint64_t expected = 0;
+            if (slot.key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) return slot.metrics;
+            if (expected == key) return slot.metrics;
+        }
+    }
+    return protocolOverflow;
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot() const {
+    MetricsSnapshot snapshot;
+    const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t today = now / 86400;
+
+    for (const auto& slot : devices) {
+        if (!slot.ready.load(std::memory_order_acquire)) continue;
+        const DeviceMetrics& m = slot.metrics;
+        DeviceMetricsSnapshot d;
+        d.key = slot.key;
+        d.batteryLatency = m.batteryLatency.Read();
+        d.chargingLatency = m.chargingLatency.Read();
+        d.batteryQueries = d.batteryLatency.Count();
+        d.chargingQueries = d.chargingLatency.Count();
+        d.batteryFailures = m.batteryFailures.load(std::memory_order_relaxed);
+        d.tidFallbacks = m.tidFallbacks.load(std::memory_order_relaxed);
+        d.commandFallbacks = m.commandFallbacks.load(std::memory_order_relaxed);
+        d.chargingFailures = m.chargingFailures.load(std::memory_order_relaxed);
+        d.lastBatterySuccessUs = m.lastBatterySuccessUs.load(std::memory_order_relaxed);
+        d.radioWakeups = m.radioWakeups.load(std::memory_order_relaxed);
+        if (m.wakeupDay.load(std::memory_order_relaxed) == today) {
+            d.wakeupsToday = m.wakeupsOnDay.load(std::memory_order_relaxed);
+        }
+        d.controlTransfers = m.controlTransfers.load(std::memory_order_relaxed);
+        d.transferBytes = m.transferBytes.load(std::memory_order_relaxed);
+        if (m.trafficDay.load(std::memory_order_relaxed) == today) {
+            d.transfersToday = m.transfersOnDay.load(std::memory_order_relaxed);
+            d.bytesToday = m.bytesOnDay.load(std::memory_order_relaxed);
+        }
+        d.transferBudget = m.transferBudget.load(std::memory_order_relaxed);
+        d.budgetState = RadioBudget{d.transferBudget}.StateAt(d.transfersToday, now % 86400);
+        d.overBudgetReads = m.overBudgetReads.load(std::memory_order_relaxed);
+        d.asleepReads = m.asleepReads.load(std::memory_order_relaxed);
+        d.notifications = m.notifications.load(std::memory_order_relaxed);
+        d.ignoredReports = m.ignoredReports.load(std::memory_order_relaxed);
+        d.breakerTrips = m.breakerTrips.load(std::memory_order_relaxed);
+        d.skippedQueries = m.skippedQueries.load(std::memory_order_relaxed);
+        d.cacheHits = m.cacheHits.load(std::memory_order_relaxed);
+        d.staleHits = m.staleHits.load(std::memory_order_relaxed);
+        d.cacheMisses = m.cacheMisses.load(std::memory_order_relaxed);
+        d.coalesced = m.coalesced.load(std::memory_order_relaxed);
+        d.cacheAge = m.cacheAge.Read();
+        snapshot.devices.push_back(std::move(d));
+    }
+
+    for (const auto& slot : protocol) {
+        uint64_t key = slot.key.load(std::memory_order_acquire);
+        if (key == 0) continue;
+        uint64_t packed = key - 1;
+        ProtocolMetricsSnapshot p;
+        p.interfaceNumber = static_cast<int8_t>((packed >> 32) & 0xFF);
+        p.strategy = static_cast<uint8_t>(packed >> 24);
+        p.transactionId = static_cast<uint8_t>(packed >> 16);
+        p.commandClass = static_cast<uint8_t>(packed >> 8);
+        p.commandId = static_cast<uint8_t>(packed);
+        p.latency = slot.metrics.latency.Read();
+        p.attempts = p.latency.Count();
+        p.successes = slot.metrics.successes.load(std::memory_order_relaxed);
+        snapshot.protocol.push_back(std::move(p));
+    }
+
+    // Stable order for diffs between dumps
+    std::sort(snapshot.devices.begin(), snapshot.devices.end(),
+              [](const DeviceMetricsSnapshot& a, const DeviceMetricsSnapshot& b) { return a.key < b.key; });
+    std::sort(snapshot.protocol.begin(), snapshot.protocol.end(),
+              [](const ProtocolMetricsSnapshot& a, const ProtocolMetricsSnapshot& b) {
+                  return std::tie(a.interfaceNumber, a.strategy, a.commandClass, a.commandId, a.transactionId) <
+                         std::tie(b.interfaceNumber, b.strategy, b.commandClass, b.commandId, b.transactionId);
+              });
+    return snapshot;
+}
+
+void MetricsRegistry::DumpToLog() const {
+    MetricsSnapshot snapshot = Snapshot();
+
+    LOG_INFO("Metrics: " << snapshot.devices.size() << " devices, " << snapshot.protocol.size() << " protocol paths");
+    for (const auto& d : snapshot.devices) {
+        LOG_INFO("  [" << d.key << "] battery n=" << d.batteryQueries << " fail=" << d.batteryFailures
+                 << " tidFallback=" << d.tidFallbacks << " cmdFallback=" << d.commandFallbacks
+                 << " p50=" << d.batteryLatency.Percentile(0.5) / 1000.0 << "ms"
+                 << " p99=" << d.batteryLatency.Percentile(0.99) / 1000.0 << "ms"
+                 << " | charging n=" << d.chargingQueries << " fail=" << d.chargingFailures
+                 << " | wakeups today=" << d.wakeupsToday << " total=" << d.radioWakeups
+                 << " asleepReads=" << d.asleepReads
+                 << " | transfers today=" << d.transfersToday << " (" << d.bytesToday << " B)"
+                 << " total=" << d.controlTransfers
+                 << " budget=" << d.transferBudget << " "
+                 << RadioBudgetStateName(d.budgetState)
+                 << " overBudgetReads=" << d.overBudgetReads
+                 << " | notifications=" << d.notifications << " ignored=" << d.ignoredReports
+                 << " | breaker trips=" << d.breakerTrips << " skipped=" << d.skippedQueries
+                 << " | cache hit=" << static_cast<int>(d.CacheHitRatio() * 100 + 0.5) << "%"
+                 << " stale=" << d.staleHits << " coalesced=" << d.coalesced
+                 << " age p99=" << d.cacheAge.Percentile(0.99) / 1000.0 << "ms");
+    }
+    for (const auto& p : snapshot.protocol) {
+        LOG_INFO("  if=" << p.interfaceNumber
+                 << (p.strategy == static_cast<uint8_t>(EventStrategy::FeatureReport) ? " feature" : " output")
+                 << " tid=0x" << std::hex << static_cast<int>(p.transactionId)
+                 << " cmd=" << static_cast<int>(p.commandClass) << ":" << static_cast<int>(p.commandId) << std::dec
+                 << " n=" << p.attempts << " ok=" << p.successes
+                 << " p50=" << p.latency.Percentile(0.5) / 1000.0 << "ms"
+                 << " p99=" << p.latency.Percentile(0.99) / 1000.0 << "ms");
+    }
+}
@@ -0,0 +1,404 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+#include "MetricsHttpServer.h"
+#include "EventLog.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+namespace {
+
+// Histogram bounds in µs; USB queries take a few ms, timeouts about a second.
+const uint64_t LatencyBucketsUs[] = {1000, 2500, 5000, 10000, 25000, 50000, 100000,
+                                     250000, 500000, 1000000, 2500000, 5000000};
+
+void AppendLabelValue(std::string& out, const std::string& value) {
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+}
+
+void AppendSeconds(std::string& out, uint64_t us) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6g", us / 1e6);
+    out += buf;
+}
+
+void AppendFamily(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void AppendSample(std::string& out, const char* name, const std::string& labels, uint64_t value) {
+    out += name;
+    out += labels;
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+} // namespace
+
+void FormatPrometheusMetrics(std::string& out, const std::vector<DeviceStatus>& devices,
+                             uint64_t version, const MetricsSnapshot& metrics, uint64_t nowUs) {
+    std::map<std::string, const DeviceMetricsSnapshot*> byKey;
+    for (const auto& m : metrics.devices) byKey[m.key] = &m;
+
+    // {serial="...",pid="0x0555",type="headset"} per device, built once
+    std::vector<std::string> labels;
+    std::vector<const DeviceMetricsSnapshot*> deviceMetrics;
+    for (const auto& d : devices) {
+        std::string l = "{serial=\"";
+        AppendLabelValue(l, d.serial);
+        char pid[8];
+        snprintf(pid, sizeof(pid), "0x%04x", d.pid & 0xFFFF);
+        l += "\",pid=\"";
+        l += pid;
+        l += "\",type=\"";
+        l += DeviceTypeName(d.type);
+        l += "\"}";
+        labels.push_back(std::move(l));
+        auto it = byKey.find(d.serial.substr(0, MetricsRegistry::MaxKeyLength));
+        deviceMetrics.push_back(it != byKey.end() ? it->second : nullptr);
+    }
+
+    AppendFamily(out, "razer_devices", "gauge", "Devices in the published snapshot.");
+    AppendSample(out, "razer_devices", "", devices.size());
+    AppendFamily(out, "razer_status_version", "gauge", "Version of the published snapshot; bumps on every change.");
+    AppendSample(out, "razer_status_version", "", version);
+
+    AppendFamily(out, "razer_device_up", "gauge", "1 if the last query of the device succeeded.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        AppendSample(out, "razer_device_up", labels[i], devices[i].error.empty() ? 1 : 0);
+    }
+
+    AppendFamily(out, "razer_battery_level_percent", "gauge", "Battery level from the last successful query.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i].level >= 0) AppendSample(out, "razer_battery_level_percent", labels[i], devices[i].level);
+    }
+
+    AppendFamily(out, "razer_battery_charging", "gauge", "1 while the device reports charging.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i].level >= 0) AppendSample(out, "razer_battery_charging", labels[i], devices[i].charging ? 1 : 0);
+    }
+
+    AppendFamily(out, "razer_device_asleep", "gauge", "1 while the device sleeps and its last reading is served.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        AppendSample(out, "razer_device_asleep", labels[i], devices[i].asleep ? 1 : 0);
+    }
+
+    AppendFamily(out, "razer_radio_wakeups_today", "gauge", "razer_radio_wakeups_total since 00:00 UTC.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (deviceMetrics[i]) AppendSample(out, "razer_radio_wakeups_today", labels[i], deviceMetrics[i]->wakeupsToday);
+    }
+
+    struct Gauge {
+        const char* name;
+        const char* help;
+        uint64_t DeviceMetricsSnapshot::*field;
+    };
+    const Gauge traffic[] = {
+        {"razer_radio_transfers_today", "razer_radio_transfers_total since 00:00 UTC.", &DeviceMetricsSnapshot::transfersToday},
+        {"razer_radio_bytes_today", "razer_radio_bytes_total since 00:00 UTC.", &DeviceMetricsSnapshot::bytesToday},
+        {"razer_radio_transfer_budget", "Control transfers allowed per UTC day; 0 = unlimited.", &DeviceMetricsSnapshot::transferBudget},
+    };
+    for (const Gauge& g : traffic) {
+        AppendFamily(out, g.name, "gauge", g.help);
+        for (size_t i = 0; i < devices.size(); i++) {
+            if (deviceMetrics[i]) AppendSample(out, g.name, labels[i], deviceMetrics[i]->*g.field);
+        }
+    }
+    AppendFamily(out, "razer_radio_budget_state", "gauge",
+                 "0 within the daily transfer budget's pace, 1 ahead of it (polled less often), 2 spent (cache only).");
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (deviceMetrics[i]) {
+            AppendSample(out, "razer_radio_budget_state", labels[i], static_cast<uint64_t>(deviceMetrics[i]->budgetState));
+        }
+    }
+
+    AppendFamily(out, "razer_battery_last_success_age_seconds", "gauge",
+                 "Time since the battery level was last read successfully.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        const DeviceMetricsSnapshot* m = deviceMetrics[i];
+        if (!m || m->lastBatterySuccessUs == 0) continue;
+        out += "razer_battery_last_success_age_seconds";
+        out += labels[i];
+        out += ' ';
+        AppendSeconds(out, nowUs > m->lastBatterySuccessUs ? nowUs - m->lastBatterySuccessUs : 0);
+        out += '\n';
+    }
+
+    AppendFamily(out, "razer_status_cache_hit_ratio", "gauge",
+                 "Share of status queries answered from the cache or by a query already in flight.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        const DeviceMetricsSnapshot* m = deviceMetrics[i];
+        if (!m) continue;
+        char ratio[32];
+        snprintf(ratio, sizeof(ratio), "%.4f", m->CacheHitRatio());
+        out += "razer_status_cache_hit_ratio";
+        out += labels[i];
+        out += ' ';
+        out += ratio;
+        out += '\n';
+    }
+
+    // Ages run up to the stale window (a minute), past the latency buckets
+    AppendFamily(out, "razer_status_cache_age_seconds", "summary", "Age of statuses served from the cache.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        const DeviceMetricsSnapshot* m = deviceMetrics[i];
+        if (!m) continue;
+        std::string prefix = labels[i].substr(0, labels[i].size() - 1) + ",quantile=\"";
+        const std::pair<const char*, double> quantiles[] = {{"0.5", 0.5}, {"0.99", 0.99}};
+        for (const auto& q : quantiles) {
+            out += "razer_status_cache_age_seconds";
+            out += prefix;
+            out += q.first;
+            out += "\"} ";
+            AppendSeconds(out, m->cacheAge.Count() ? m->cacheAge.Percentile(q.second) : 0);
+            out += '\n';
+        }
+        AppendSample(out, "razer_status_cache_age_seconds_count", labels[i], m->cacheAge.Count());
+    }
+
+    // Cumulative buckets from the log-linear histogram. A source bucket is
+    // counted under `le` once its upper bound is within it, so counts are
+    // exact at the bounds above; _sum uses bucket midpoints (within ~6%).
+    AppendFamily(out, "razer_battery_query_duration_seconds", "histogram",
+                 "Battery query latency, including transaction ID and command fallbacks.");
+    for (size_t i = 0; i < devices.size(); i++) {
+        const DeviceMetricsSnapshot* m = deviceMetrics[i];
+        if (!m) continue;
+        const LatencyHistogram::Snapshot& h = m->batteryLatency;
+        std::string prefix = labels[i].substr(0, labels[i].size() - 1) + ",le=\"";
+        uint64_t cumulative = 0;
+        uint64_t sumUs = 0;
+        int bucket = 0;
+        for (uint64_t bound : LatencyBucketsUs) {
+            for (; bucket < LatencyHistogram::BucketCount && LatencyHistogram::BucketUpperBound(bucket) <= bound; bucket++) {
+                cumulative += h.counts[bucket];
+                sumUs += h.counts[bucket] * ((LatencyHistogram::BucketLowerBound(bucket) + LatencyHistogram::BucketUpperBound(bucket)) / 2);
+            }
+            out += "razer_battery_query_duration_seconds_bucket";
+            out += prefix;
+            AppendSeconds(out, bound);
+            out += "\"} ";
+            out += std::to_string(cumulative);
+            out += '\n';
+        }
+        for (; bucket < LatencyHistogram::BucketCount; bucket++) {
+            sumUs += h.counts[bucket] * ((LatencyHistogram::BucketLowerBound(bucket) + LatencyHistogram::BucketUpperBound(bucket)) / 2);
+        }
+        AppendSample(out, "razer_battery_query_duration_seconds_bucket", prefix + "+Inf\"}", m->batteryQueries);
+        out += "razer_battery_query_duration_seconds_sum";
+        out += labels[i];
+        out += ' ';
+        AppendSeconds(out, sumUs);
+        out += '\n';
+        AppendSample(out, "razer_battery_query_duration_seconds_count", labels[i], m->batteryQueries);
+    }
+
+    struct Counter {
+        const char* name;
+        const char* help;
+        uint64_t DeviceMetricsSnapshot::*field;
+    };
+    const Counter counters[] = {
+        {"razer_battery_query_failures_total", "Battery queries no interface answered.", &DeviceMetricsSnapshot::batteryFailures},
+        {"razer_battery_tid_fallbacks_total", "Battery queries answered only on a non-default transaction ID.", &DeviceMetricsSnapshot::tidFallbacks},
+        {"razer_battery_command_fallbacks_total", "Battery queries answered only by the 0x0F/0x02 command.", &DeviceMetricsSnapshot::commandFallbacks},
+        {"razer_charging_queries_total", "Charging state queries.", &DeviceMetricsSnapshot::chargingQueries},
+        {"razer_charging_query_failures_total", "Charging state queries no interface answered.", &DeviceMetricsSnapshot::chargingFailures},
+        {"razer_radio_wakeups_total", "Answers from a device idle for longer than its idle time (likely radio wake-ups).", &DeviceMetricsSnapshot::radioWakeups},
+        {"razer_radio_transfers_total", "Control transfers sent to the device; a report exchange is two.", &DeviceMetricsSnapshot::controlTransfers},
+        {"razer_radio_bytes_total", "Bytes moved by those control transfers.", &DeviceMetricsSnapshot::transferBytes},
+        {"razer_radio_over_budget_reads_total", "Statuses served from cache because the daily transfer budget was spent.", &DeviceMetricsSnapshot::overBudgetReads},
+        {"razer_notifications_total", "Battery, charging and link notifications received from the device.", &DeviceMetricsSnapshot::notifications},
+        {"razer_notification_reports_ignored_total", "Other reports read from the device's interrupt endpoint.", &DeviceMetricsSnapshot::ignoredReports},
+        {"razer_battery_cached_while_asleep_total", "Statuses served from cache because the device was asleep.", &DeviceMetricsSnapshot::asleepReads},
+        {"razer_breaker_trips_total", "Times a command kept failing and its circuit breaker opened.", &DeviceMetricsSnapshot::breakerTrips},
+        {"razer_queries_skipped_total", "Commands skipped while their circuit breaker was open.", &DeviceMetricsSnapshot::skippedQueries},
+        {"razer_status_cache_hits_total", "Status queries answered by a cached status younger than the TTL.", &DeviceMetricsSnapshot::cacheHits},
+        {"razer_status_cache_stale_hits_total", "Status queries answered by a stale status while another caller revalidated.", &DeviceMetricsSnapshot::staleHits},
+        {"razer_status_cache_misses_total", "Status queries that went to the device.", &DeviceMetricsSnapshot::cacheMisses},
+        {"razer_status_coalesced_total", "Status queries that joined one already in flight.", &DeviceMetricsSnapshot::coalesced},
+    };
+    for (const Counter& c : counters) {
+        AppendFamily(out, c.name, "counter", c.help);
+        for (size_t i = 0; i < devices.size(); i++) {
+            if (deviceMetrics[i]) AppendSample(out, c.name, labels[i], deviceMetrics[i]->*c.field);
+        }
+    }
+}
+
+#ifdef _WIN32
+#define CloseSocket closesocket
+using SocketLength = int;
+#else
+#define CloseSocket close
+using SocketLength = socklen_t;
+#endif
+
+MetricsHttpServer::MetricsHttpServer(DeviceStatusStore& store) : store(store) {
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    Stop();
+}
+
+bool MetricsHttpServer::Start(uint16_t requestedPort) {
+    if (thread.joinable()) return false;
+#ifdef _WIN32
+    static const bool winsockReady = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!winsockReady) return false;
+    SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET) return false;
+    // Another process must not be able to bind the same port over us
+    BOOL exclusive = TRUE;
+    setsockopt(s, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&exclusive), sizeof(exclusive));
+    intptr_t fd = static_cast<intptr_t>(s);
+#else
+    int s = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s < 0) return false;
+    int reuse = 1; // restart without waiting for TIME_WAIT
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    intptr_t fd = s;
+#endif
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(requestedPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // never reachable from the network
+    SocketLength length = sizeof(addr);
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 8) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        LOG_ERROR("Metrics listener cannot bind 127.0.0.1:" << requestedPort);
+        CloseSocket(s);
+        return false;
+    }
+
+    listenFd = fd;
+    port = ntohs(addr.sin_port);
+    stopping.store(false);
+    thread = std::thread(&MetricsHttpServer::AcceptLoop, this);
+    LOG_INFO("Serving metrics on http://127.0.0.1:" << port << "/metrics");
+    return true;
+}
+
+void MetricsHttpServer::Stop() {
+    if (!thread.joinable()) return;
+    stopping.store(true);
+#ifdef _WIN32
+    // Closing the socket is what wakes a blocked accept() on Windows
+    closesocket(static_cast<SOCKET>(listenFd));
+    thread.join();
+#else
+    shutdown(static_cast<int>(listenFd), SHUT_RDWR);
+    thread.join();
+    close(static_cast<int>(listenFd));
+#endif
+    listenFd = -1;
+}
+
+void MetricsHttpServer::AcceptLoop() {
+    while (!stopping.load()) {
+#ifdef _WIN32
+        SOCKET client = accept(static_cast<SOCKET>(listenFd), nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            if (stopping.load()) break;
+            continue;
+        }
+        DWORD timeout = ReceiveTimeoutMs;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+        int client = accept4(static_cast<int>(listenFd), nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (stopping.load() || (errno != EINTR && errno != ECONNABORTED)) break;
+            continue;
+        }
+        timeval timeout = {ReceiveTimeoutMs / 1000, (ReceiveTimeoutMs % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#endif
+        Serve(static_cast<intptr_t>(client));
+        CloseSocket(client);
+    }
+}
+
+void MetricsHttpServer::Serve(intptr_t client) {
+#ifdef _WIN32
+    SOCKET s = static_cast<SOCKET>(client);
+    const int sendFlags = 0;
+#else
+    int s = static_cast<int>(client);
+    const int sendFlags = MSG_NOSIGNAL;
+#endif
+
+    // Only the request line matters; read until the end of the headers
+    std::string request;
+    char chunk[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos) {
+        if (request.size() > MaxRequestBytes) return;
+        int n = static_cast<int>(recv(s, chunk, sizeof(chunk), 0));
+        if (n <= 0) return;
+        request.append(chunk, static_cast<size_t>(n));
+    }
+
+    TRACE_SCOPE("MetricsHttpServer::Serve");
+    const char* status = "200 OK";
+    std::string body;
+    if (request.compare(0, 4, "GET ") != 0) {
+        status = "405 Method Not Allowed";
+        body = "GET only\n";
+    } else if (request.compare(4, 9, "/metrics ") != 0 && request.compare(4, 9, "/metrics?") != 0) {
+        status = "404 Not Found";
+        body = "see /metrics\n";
+    } else {
+        DeviceSnapshotPtr snapshot = store.GetSnapshot();
+        FormatPrometheusMetrics(body, snapshot->devices, snapshot->version, MetricsRegistry::Instance().Snapshot(),
+                                EventLog::NowUs());
+        scrapes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::string response = "HTTP/1.0 ";
+    response += status;
+    response += "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+
+    size_t offset = 0;
+    while (offset < response.size()) {
+        int n = static_cast<int>(send(s, response.data() + offset, static_cast<int>(response.size() - offset), sendFlags));
+        if (n <= 0) return;
+        offset += static_cast<size_t>(n);
+    }
+}
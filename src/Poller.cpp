@@ -0,0 +1,413 @@
+#include "Poller.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <algorithm>
+
+// Scheduled refreshes must not look like sleep gaps to the estimator. A
+// device that notifies for itself, or runs ahead of its transfer budget,
+// is polled less often than the rest.
+BatteryEstimator::Options Poller::EstimatorOptions(const PollerOptions& options) {
+    std::chrono::milliseconds longest = options.refreshInterval;
+    if (options.listenForEvents) longest = std::max(longest, options.listeningRefreshInterval);
+    if (options.dailyTransferBudget > 0) longest = std::max(longest, options.overBudgetInterval);
+    BatteryEstimator::Options estimatorOptions;
+    int64_t interval = std::chrono::duration_cast<std::chrono::seconds>(longest).count();
+    estimatorOptions.maxGapSeconds = std::max(estimatorOptions.maxGapSeconds, 3 * interval);
+    return estimatorOptions;
+}
+
+Poller::Poller(std::shared_ptr<UsbBackend> backend, PollerOptions pollerOptions)
+    : options(std::move(pollerOptions)), probes(options.probeConcurrency), manager(std::move(backend), &probes),
+      ipc(store), metrics(store),
+      estimators(EstimatorOptions(options)) {
+    ipc.SetRefreshHandler([this] { return RequestRefresh(); });
+    manager.SetDailyTransferBudget(options.dailyTransferBudget);
+}
+
+Poller::~Poller() {
+    Stop();
+}
+
+bool Poller::Start() {
+    if (!ipc.Start(options.endpoint, options.access)) return false;
+
+    bool shm = shared.Create(options.sharedStatusName, options.access);
+#ifdef _WIN32
+    // Global\ objects need SeCreateGlobalPrivilege, which a poller started
+    // outside the service manager may not have
+    if (!shm && options.sharedStatusName == DefaultSharedStatusName()) {
+        shm = shared.Create(RAZER_SHARED_STATUS_LOCAL_NAME, options.access);
+    }
+#endif
+    if (shm) {
+        // Listeners run on the publishing (polling) thread: a single writer
+        sharedSubscription = store.Subscribe([this](uint64_t) {
+            DeviceSnapshotPtr snapshot = store.GetSnapshot();
+            shared.Publish(snapshot->devices, snapshot->version);
+        });
+    }
+
+    if (!options.historyDirectory.empty()) history.Open(options.historyDirectory);
+
+    // Scrapes read the store; a busy port only costs the metrics
+    if (options.metricsPort) metrics.Start(options.metricsPort);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        pending = true;
+        pendingAt = Clock::now();
+    }
+    if (options.powerSource && !options.powerSource->Start([this](PowerEvent event) { OnPowerEvent(event); })) {
+        LOG_ERROR("Power notifications unavailable; polling regardless of power state");
+    }
+    thread = std::thread(&Poller::Run, this);
+    LOG_INFO("Poller started.");
+    return true;
+}
+
+void Poller::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thread.joinable()) return;
+        stopping = true;
+    }
+    cv.notify_all();
+    thread.join();
+    // Listeners call back into this poller
+    for (const auto& device : manager.GetDevices()) device->StopListening();
+
+    if (options.powerSource) options.powerSource->Stop();
+    ipc.Stop();
+    metrics.Stop();
+    if (sharedSubscription) {
+        store.Unsubscribe(sharedSubscription);
+        sharedSubscription = 0;
+    }
+    shared.Close();
+    LOG_INFO("Poller stopped.");
+}
+
+void Poller::RequestEnumerate() {
+    {
+        // Notifications come in bursts: each one pushes the refresh back
+        std::lock_guard<std::mutex> lock(mutex);
+        Clock::time_point at = Clock::now() + options.enumerateDelay;
+        if (!pending || at > pendingAt) pendingAt = at;
+        pending = true;
+    }
+    cv.notify_all();
+}
+
+bool Poller::RequestRefresh() {
+    {
+        // Requests join a refresh that is already scheduled
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return false;
+        Clock::time_point now = Clock::now();
+        Clock::time_point since = options.interactiveFirst ? lastInteractive : lastRefresh;
+        Clock::time_point due = std::max(now, since + options.minRequestInterval);
+        if (!pending) {
+            pending = true;
+            pendingAt = due;
+        }
+        if (pendingPriority != IoPriority::Interactive) {
+            pendingPriority = IoPriority::Interactive;
+            requestedAt = now;
+            // A debounced enumeration or a follow-up is no reason to make
+            // the user wait
+            if (options.interactiveFirst) pendingAt = std::min(pendingAt, due);
+        }
+        // Only worth it when this refresh can start as soon as the batch yields
+        if (options.interactiveFirst && batchRunning && batchPriority != IoPriority::Interactive &&
+            pendingAt <= now && !batchDeadline.Cancelled()) {
+            batchDeadline.Cancel();
+            preemptionCount++;
+            LOG_DEBUG("Refresh requested; cancelling the running " << IoPriorityName(batchPriority) << " batch");
+        }
+    }
+    cv.notify_all();
+    return true;
+}
+
+void Poller::OnPowerEvent(PowerEvent event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool wasIdle = power.IsIdle();
+        power.Apply(event);
+        if (power.IsIdle() == wasIdle) return;
+        LOG_INFO("Power: " << PowerEventName(event) << (wasIdle ? ", resuming polling" : ", polling paused"));
+        if (!wasIdle) return;
+        // Whatever was scheduled or requested while idle becomes this one
+        // refresh; device notifications from the resume push it back
+        pending = true;
+        pendingAt = Clock::now() + options.enumerateDelay;
+        // Time spent paused is not latency
+        if (pendingPriority == IoPriority::Interactive) requestedAt = Clock::now();
+    }
+    cv.notify_all();
+}
+
+bool Poller::IsPaused() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return power.IsIdle();
+}
+
+uint64_t Poller::GetRefreshCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return refreshCount;
+}
+
+uint64_t Poller::GetPreemptionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return preemptionCount;
+}
+
+uint64_t Poller::GetNotificationCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return notificationCount;
+}
+
+void Poller::Run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        // Notifications cost no I/O: published even while paused
+        if (!notifications.empty()) {
+            std::vector<Notification> arrived;
+            arrived.swap(notifications);
+            notificationCount += arrived.size();
+            lock.unlock();
+            ApplyNotifications(std::move(arrived));
+            lock.lock();
+            continue;
+        }
+        if (power.IsIdle()) {
+            cv.wait(lock);
+            continue;
+        }
+
+        // Requests and device changes re-enumerate and queue every device;
+        // scheduled polls queue every device and near-threshold re-queries
+        // only those devices, without enumerating. Whatever is queued runs
+        // one priority class per pass.
+        Clock::time_point now = Clock::now();
+        bool enumerate = pending && now >= pendingAt;
+        bool queueAll = false;
+        bool queueNear = false;
+        IoPriority fill = IoPriority::Background;
+        if (enumerate) {
+            pending = false;
+            queueAll = true;
+            fill = pendingPriority;
+            pendingPriority = IoPriority::Background;
+            lastRefresh = now;
+            if (fill == IoPriority::Interactive) {
+                lastInteractive = now;
+                interactiveRequestedAt = requestedAt;
+            }
+        } else if (queue.Empty()) {
+            Clock::time_point scheduled = lastRefresh + options.refreshInterval;
+            // A scheduled refresh that falls due while one is pending joins it
+            Clock::time_point next = pending ? pendingAt : scheduled;
+            if (!nearDevices.empty()) {
+                next = std::min(next, std::max(lastRefresh, lastNearRefresh) + options.nearThresholdInterval);
+            }
+            if (now < next) {
+                cv.wait_until(lock, next);
+                continue;
+            }
+            // Stamped before the I/O so that requests arriving during this
+            // refresh are spaced from its start rather than run right after it
+            if (!pending && now >= scheduled) {
+                queueAll = true;
+                lastRefresh = now;
+            } else {
+                queueNear = true;
+                lastNearRefresh = now;
+            }
+        }
+        lock.unlock();
+
+        // Enumeration and the batch after it share one budget
+        Deadline deadline = Deadline::After(options.refreshBudget);
+        if (enumerate) {
+            manager.EnumerateDevices(false, deadline);
+            queue.Retain(manager.GetDevices());
+        }
+        size_t deferred = 0;
+        for (const auto& device : manager.GetDevices()) {
+            bool wanted = queueAll || (queueNear && nearDevices.count(device.get()));
+            if (!wanted) continue;
+            // Only scheduled polls give way
+            if (!enumerate && Deferred(*device, now)) {
+                deferred++;
+                continue;
+            }
+            queue.Push(device, queueAll ? fill : IoPriority::Alert);
+        }
+        if (deferred) LOG_DEBUG("Left " << deferred << " notifying or over-budget devices out of this poll");
+        IoPriority priority = IoPriority::Background;
+        std::vector<std::shared_ptr<RazerDevice>> batch = queue.PopTop(priority);
+
+        lock.lock();
+        if (options.interactiveFirst && priority != IoPriority::Interactive && pending &&
+            pendingPriority == IoPriority::Interactive && Clock::now() >= pendingAt) {
+            // A request fell due during the enumeration: it goes first
+            for (const auto& device : batch) queue.Push(device, priority);
+            continue;
+        }
+        batchRunning = true;
+        batchPriority = priority;
+        batchDeadline = deadline;
+        lock.unlock();
+        Refresh(priority, std::move(batch), deadline);
+        lock.lock();
+        batchRunning = false;
+        batchDeadline = Deadline();
+        refreshCount++;
+    }
+}
+
+bool Poller::Deferred(RazerDevice& device, Clock::time_point now) {
+    auto it = lastQueried.find(&device);
+    if (it == lastQueried.end()) return false;
+    Clock::duration since = now - it->second;
+    if (options.listenForEvents && device.IsListening() && device.HasNotified() &&
+        since < options.listeningRefreshInterval) {
+        return true;
+    }
+    return options.dailyTransferBudget != 0 && device.GetBudgetState() != RadioBudgetState::Normal &&
+           since < options.overBudgetInterval;
+}
+
+void Poller::Listen(const std::shared_ptr<RazerDevice>& device) {
+    std::weak_ptr<RazerDevice> weak = device;
+    device->StartListening([this, weak](DeviceEventKind kind, const DeviceStatus& status) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            notifications.push_back(Notification{weak, kind, status});
+        }
+        cv.notify_all();
+    });
+}
+
+void Poller::ApplyNotifications(std::vector<Notification> arrived) {
+    TRACE_SCOPE("Poller::ApplyNotifications");
+    std::vector<std::shared_ptr<RazerDevice>> targets;
+    std::vector<DeviceStatus> statuses;
+    for (auto& notification : arrived) {
+        std::shared_ptr<RazerDevice> device = notification.device.lock();
+        if (!device) continue;
+        LOG_DEBUG("Notification from " << notification.status.serial << ": "
+                  << DeviceEventKindName(notification.kind));
+        // Back in range: read whatever changed while it was away
+        if (notification.kind == DeviceEventKind::Connected) queue.Push(device, IoPriority::Background);
+        // Each one carries the whole cached status; the latest wins
+        auto it = std::find(targets.begin(), targets.end(), device);
+        if (it != targets.end()) {
+            statuses[it - targets.begin()] = std::move(notification.status);
+        } else {
+            targets.push_back(std::move(device));
+            statuses.push_back(std::move(notification.status));
+        }
+    }
+    if (!targets.empty()) Publish(targets, std::move(statuses));
+}
+
+void Poller::Refresh(IoPriority priority, std::vector<std::shared_ptr<RazerDevice>> targets,
+                     const Deadline& deadline) {
+    TRACE_SCOPE("Poller::Refresh");
+    // One task per device, each writing its own slot: table order does
+    // not depend on which receiver answered first
+    std::vector<DeviceStatus> statuses(targets.size());
+    probes.Run(targets.size(), [&](size_t i) { statuses[i] = targets[i]->QueryStatus(options.idleAware, deadline); });
+
+    if (deadline.Cancelled()) {
+        // Preempted: the devices this batch did not finish are queued again
+        // behind the interactive refresh rather than published as cut short
+        size_t kept = 0;
+        for (size_t i = 0; i < targets.size(); i++) {
+            if (statuses[i].error == "timeout") {
+                queue.Push(targets[i], priority);
+                continue;
+            }
+            targets[kept] = std::move(targets[i]);
+            statuses[kept] = std::move(statuses[i]);
+            kept++;
+        }
+        LOG_DEBUG("Deferred " << (targets.size() - kept) << " " << IoPriorityName(priority) << " queries");
+        targets.resize(kept);
+        statuses.resize(kept);
+    }
+
+    Clock::time_point queriedAt = Clock::now();
+    for (const auto& device : targets) {
+        lastQueried[device.get()] = queriedAt;
+        // No query is running now: safe to (re)start listening
+        if (options.listenForEvents && !device->IsListening()) Listen(device);
+    }
+
+    // Devices the deadline cut short get one more chance soon, rather than
+    // a whole refreshInterval later; a second cut in a row waits for it
+    bool cut = std::any_of(statuses.begin(), statuses.end(),
+                           [](const DeviceStatus& status) { return status.error == "timeout"; });
+    if (cut && !followingUpCut) {
+        LOG_INFO("Refresh ran out of its " << options.refreshBudget.count() << " ms budget; retrying soon");
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pending) {
+            pending = true;
+            pendingAt = Clock::now() + options.minRequestInterval;
+        }
+    }
+    followingUpCut = cut && !followingUpCut;
+
+    Publish(targets, std::move(statuses));
+
+    if (priority == IoPriority::Interactive) {
+        interactiveLatency.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - interactiveRequestedAt).count()));
+    }
+}
+
+void Poller::Publish(const std::vector<std::shared_ptr<RazerDevice>>& targets, std::vector<DeviceStatus> statuses) {
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (alerts.IsNearThreshold(statuses[i])) nearDevices.insert(targets[i].get());
+        else nearDevices.erase(targets[i].get());
+    }
+
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    history.Record(statuses, now);
+    estimators.Apply(statuses, now);
+    std::vector<BatteryAlert> raised = alerts.Update(statuses, now);
+
+    // Devices outside this batch stand as last published; the table
+    // follows the manager's order and drops devices it no longer has
+    for (size_t i = 0; i < targets.size(); i++) {
+        published[targets[i].get()] = PublishedStatus{targets[i], std::move(statuses[i])};
+    }
+    std::vector<DeviceStatus> table;
+    std::map<const RazerDevice*, PublishedStatus> current;
+    std::set<const RazerDevice*> near;
+    std::map<const RazerDevice*, Clock::time_point> queried;
+    for (const auto& device : manager.GetDevices()) {
+        if (nearDevices.count(device.get())) near.insert(device.get());
+        auto last = lastQueried.find(device.get());
+        if (last != lastQueried.end()) queried.insert(*last);
+        auto it = published.find(device.get());
+        if (it == published.end() || it->second.device.lock() != device) continue;
+        table.push_back(it->second.status);
+        current.insert(std::move(*it));
+    }
+    published.swap(current);
+    nearDevices.swap(near);
+    lastQueried.swap(queried);
+    store.Publish(std::move(table));
+
+    // After the table, so subscribers already show the level they are warned about
+    for (const auto& alert : raised) {
+        LOG_INFO("Low battery: " << alert.device.serial << " at " << alert.device.level
+                 << "% (threshold " << alert.threshold << "%)");
+        ipc.Broadcast(AlertMessage(alert));
+    }
+}
@@ -0,0 +1,332 @@
+// RazerBatteryPoller [--console] [--metrics-port N] [--daily-transfer-budget N] [--listen-for-events]
+//
+// The privileged half of the tray app: owns the USB devices and publishes
+// their status to the IPC endpoint and the shared-memory table, which every
+// session's RazerBatteryTray renders from. On Windows it normally runs as
+// the "RazerBatteryPoller" service (--console runs it in the foreground
+// for debugging); elsewhere it is a plain daemon stopped with SIGINT or
+// SIGTERM, where SIGHUP requests a re-enumeration. --metrics-port (or
+// RAZER_METRICS_PORT) serves Prometheus metrics on 127.0.0.1.
+// --daily-transfer-budget (or RAZER_DAILY_TRANSFER_BUDGET) caps the control
+// transfers sent to each device per UTC day (PollerOptions).
+// --listen-for-events (or RAZER_LISTEN_FOR_EVENTS=1) reads device
+// notifications from the interrupt endpoint; their format is still a
+// placeholder (DeviceEvents.h).
+//
+// Polling pauses while the system sleeps, the display is off, the lid is
+// closed or battery saver is on. Windows reports these itself; elsewhere
+// SIGUSR1 pauses and SIGUSR2 resumes, e.g. from a systemd-sleep hook:
+//   case $1 in pre) pkill -USR1 -f RazerBatteryPoller ;; post) pkill -USR2 -f RazerBatteryPoller ;; esac
+#ifdef _WIN32
+#include <windows.h>
+#include <dbt.h>
+#include <initguid.h>
+#include <hidclass.h>
+#include <hidsdi.h>
+#include "SingleInstance.h"
+#else
+#include <signal.h>
+#include <time.h>
+#endif
+#include "Poller.h"
+#include "LibusbBackend.h"
+#include "Logger.h"
+#include "EventLog.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const auto MetricsDumpInterval = std::chrono::hours(1);
+
+bool ParseArgs(int argc, char** argv, PollerOptions& options, bool& console) {
+    if (const char* port = getenv("RAZER_METRICS_PORT")) {
+        options.metricsPort = static_cast<uint16_t>(atoi(port));
+    }
+    if (const char* budget = getenv("RAZER_DAILY_TRANSFER_BUDGET")) {
+        options.dailyTransferBudget = strtoull(budget, nullptr, 10);
+    }
+    if (const char* listen = getenv("RAZER_LISTEN_FOR_EVENTS")) {
+        options.listenForEvents = listen[0] == '1';
+    }
+#ifndef _WIN32
+    (void)console;
+#endif
+    for (int i = 1; i < argc; i++) {
+#ifdef _WIN32
+        if (strcmp(argv[i], "--console") == 0) {
+            console = true;
+            continue;
+        }
+#endif
+        if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            options.metricsPort = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--daily-transfer-budget") == 0 && i + 1 < argc) {
+            options.dailyTransferBudget = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--listen-for-events") == 0) {
+            options.listenForEvents = true;
+        } else {
+#ifdef _WIN32
+            fprintf(stderr, "usage: RazerBatteryPoller [--console] [--metrics-port N] [--daily-transfer-budget N]"
+                            " [--listen-for-events]\n");
+#else
+            fprintf(stderr, "usage: RazerBatteryPoller [--metrics-port N] [--daily-transfer-budget N] [--listen-for-events]\n");
+#endif
+            return false;
+        }
+    }
+    return true;
+}
+
+void InitDiagnostics() {
+    Logger::SetFileName("RazerBatteryPoller.log");
+    LOG_INFO("Poller starting...");
+    // RAZER_TRACE=1 traces from startup; exported when the poller stops
+    if (const char* trace = getenv("RAZER_TRACE")) {
+        if (trace[0] == '1') Trace::SetEnabled(true);
+    }
+    EventLog::Instance().Open(Logger::Instance().GetDirectory() + "/RazerBatteryEvents.bin");
+}
+
+std::string HistoryDirectory() {
+    return Logger::Instance().GetDirectory() + "/history";
+}
+
+void ShutdownDiagnostics() {
+    MetricsRegistry::Instance().DumpToLog();
+    if (Trace::IsEnabled()) {
+        Trace::SetEnabled(false);
+        Trace::ExportChromeJson(Logger::Instance().GetDirectory() + "/RazerBatteryTrace.json");
+    }
+    EventLog::Instance().Close();
+}
+
+#ifdef _WIN32
+
+const wchar_t* ServiceName = L"RazerBatteryPoller";
+
+PollerOptions g_Options;
+Poller* g_Poller = nullptr;
+HANDLE g_StopEvent = NULL;
+SERVICE_STATUS_HANDLE g_StatusHandle = NULL;
+SERVICE_STATUS g_Status = {};
+
+void ReportStatus(DWORD state, DWORD exitCode = NO_ERROR) {
+    g_Status.dwServiceType = SERVICE_WIN32_OWN_PROCESS;
+    g_Status.dwCurrentState = state;
+    g_Status.dwWin32ExitCode = exitCode;
+    g_Status.dwControlsAccepted = state == SERVICE_RUNNING ? SERVICE_ACCEPT_STOP | SERVICE_ACCEPT_SHUTDOWN : 0;
+    g_Status.dwWaitHint = state == SERVICE_RUNNING || state == SERVICE_STOPPED ? 0 : 5000;
+    SetServiceStatus(g_StatusHandle, &g_Status);
+}
+
+// Runs until g_StopEvent is set. `notifyTarget` receives device arrival
+// and removal notifications (a service status handle or a window).
+int RunPoller(HANDLE notifyTarget, DWORD notifyFlags) {
+    auto backend = std::make_shared<LibusbBackend>();
+    if (!backend->IsAvailable()) {
+        LOG_ERROR("libusb initialization failed");
+        return 1;
+    }
+
+    g_Options.historyDirectory = HistoryDirectory();
+    g_Options.powerSource = CreateSystemPowerSource();
+    Poller poller(backend, g_Options);
+    if (!poller.Start()) {
+        LOG_ERROR("Another poller already serves " << IpcListener::DefaultEndpoint());
+        return 1;
+    }
+    g_Poller = &poller;
+
+    HDEVNOTIFY devNotify = NULL;
+    if (notifyTarget) {
+        DEV_BROADCAST_DEVICEINTERFACE filter;
+        ZeroMemory(&filter, sizeof(filter));
+        filter.dbcc_size = sizeof(filter);
+        filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+        HidD_GetHidGuid(&filter.dbcc_classguid);
+        devNotify = RegisterDeviceNotification(notifyTarget, &filter, notifyFlags);
+        if (!devNotify) LOG_ERROR("RegisterDeviceNotification failed: " << GetLastError());
+    }
+
+    if (g_StatusHandle) ReportStatus(SERVICE_RUNNING);
+    const DWORD dumpMs = static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(MetricsDumpInterval).count());
+    while (WaitForSingleObject(g_StopEvent, dumpMs) == WAIT_TIMEOUT) {
+        MetricsRegistry::Instance().DumpToLog();
+    }
+
+    if (devNotify) UnregisterDeviceNotification(devNotify);
+    g_Poller = nullptr;
+    poller.Stop();
+    return 0;
+}
+
+DWORD WINAPI ServiceHandler(DWORD control, DWORD eventType, LPVOID, LPVOID) {
+    switch (control) {
+    case SERVICE_CONTROL_STOP:
+    case SERVICE_CONTROL_SHUTDOWN:
+        ReportStatus(SERVICE_STOP_PENDING);
+        SetEvent(g_StopEvent);
+        return NO_ERROR;
+    case SERVICE_CONTROL_DEVICEEVENT:
+        if ((eventType == DBT_DEVICEARRIVAL || eventType == DBT_DEVICEREMOVECOMPLETE) && g_Poller) {
+            g_Poller->RequestEnumerate();
+        }
+        return NO_ERROR;
+    case SERVICE_CONTROL_INTERROGATE:
+        return NO_ERROR;
+    default:
+        return ERROR_CALL_NOT_IMPLEMENTED;
+    }
+}
+
+void WINAPI ServiceMain(DWORD, LPWSTR*) {
+    g_StatusHandle = RegisterServiceCtrlHandlerExW(ServiceName, ServiceHandler, NULL);
+    if (!g_StatusHandle) return;
+    ReportStatus(SERVICE_START_PENDING);
+
+    InitDiagnostics();
+    int rc = RunPoller(g_StatusHandle, DEVICE_NOTIFY_SERVICE_HANDLE);
+    ShutdownDiagnostics();
+    ReportStatus(SERVICE_STOPPED, rc == 0 ? NO_ERROR : ERROR_SERVICE_SPECIFIC_ERROR);
+}
+
+BOOL WINAPI ConsoleHandler(DWORD) {
+    SetEvent(g_StopEvent);
+    return TRUE;
+}
+
+// Device notifications for --console, which has no service handle
+LRESULT CALLBACK NotifyWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (msg == WM_DEVICECHANGE && (wParam == DBT_DEVICEARRIVAL || wParam == DBT_DEVICEREMOVECOMPLETE) && g_Poller) {
+        g_Poller->RequestEnumerate();
+    }
+    if (msg == WM_DESTROY) PostQuitMessage(0);
+    return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+struct NotifyWindow {
+    HWND hwnd = NULL;
+    HANDLE ready = NULL;
+};
+
+// A window's messages are only delivered to the thread that created it,
+// so the window is created here rather than by main().
+DWORD WINAPI NotifyThread(LPVOID param) {
+    NotifyWindow* window = static_cast<NotifyWindow*>(param);
+    WNDCLASSEX wc = {0};
+    wc.cbSize = sizeof(wc);
+    wc.lpfnWndProc = NotifyWndProc;
+    wc.hInstance = GetModuleHandle(NULL);
+    wc.lpszClassName = L"RazerBatteryPollerClass";
+    RegisterClassEx(&wc);
+    window->hwnd = CreateWindowEx(0, wc.lpszClassName, L"RazerBatteryPoller", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, NULL);
+    SetEvent(window->ready);
+    if (!window->hwnd) return 1;
+
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) DispatchMessage(&msg);
+    return 0;
+}
+
+#endif
+
+} // namespace
+
+#ifdef _WIN32
+
+int main(int argc, char** argv) {
+    bool console = false;
+    if (!ParseArgs(argc, argv, g_Options, console)) return 1;
+
+    SingleInstance instance("Global\\RazerBatteryPoller_Instance_Mutex");
+    if (instance.IsAnotherInstanceRunning()) {
+        fprintf(stderr, "RazerBatteryPoller is already running.\n");
+        return 1;
+    }
+    g_StopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+    if (!console) {
+        SERVICE_TABLE_ENTRYW table[] = {{const_cast<LPWSTR>(ServiceName), ServiceMain}, {NULL, NULL}};
+        if (StartServiceCtrlDispatcherW(table)) return 0;
+        if (GetLastError() != ERROR_FAILED_SERVICE_CONTROLLER_CONNECT) return 1;
+        // Started from a shell rather than by the service manager
+    }
+
+    InitDiagnostics();
+    SetConsoleCtrlHandler(ConsoleHandler, TRUE);
+
+    NotifyWindow window;
+    window.ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+    HANDLE pump = CreateThread(NULL, 0, NotifyThread, &window, 0, NULL);
+    if (pump) WaitForSingleObject(window.ready, INFINITE);
+    int rc = RunPoller(window.hwnd, DEVICE_NOTIFY_WINDOW_HANDLE);
+    if (window.hwnd) PostMessage(window.hwnd, WM_CLOSE, 0, 0);
+    if (pump) {
+        WaitForSingleObject(pump, 1000);
+        CloseHandle(pump);
+    }
+    CloseHandle(window.ready);
+    ShutdownDiagnostics();
+    return rc;
+}
+
+#else
+
+int main(int argc, char** argv) {
+    PollerOptions options;
+    bool console = false;
+    if (!ParseArgs(argc, argv, options, console)) return 1;
+
+    // Block before any thread starts so that only sigtimedwait sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    InitDiagnostics();
+    auto backend = std::make_shared<LibusbBackend>();
+    if (!backend->IsAvailable()) {
+        fprintf(stderr, "libusb initialization failed\n");
+        return 1;
+    }
+
+    options.historyDirectory = HistoryDirectory();
+    auto power = std::make_shared<ManualPowerSource>();
+    options.powerSource = power;
+    Poller poller(backend, options);
+    if (!poller.Start()) {
+        fprintf(stderr, "another poller already serves %s\n", IpcListener::DefaultEndpoint().c_str());
+        return 1;
+    }
+
+    const auto dumpSeconds = std::chrono::duration_cast<std::chrono::seconds>(MetricsDumpInterval).count();
+    timespec timeout = {static_cast<time_t>(dumpSeconds), 0};
+    for (;;) {
+        int sig = sigtimedwait(&signals, nullptr, &timeout);
+        if (sig == SIGHUP) {
+            poller.RequestEnumerate();
+        } else if (sig == SIGUSR1) {
+            power->Emit(PowerEvent::Suspend);
+        } else if (sig == SIGUSR2) {
+            power->Emit(PowerEvent::Resume);
+        } else if (sig == SIGINT || sig == SIGTERM) {
+            break;
+        } else if (sig < 0) {
+            MetricsRegistry::Instance().DumpToLog();
+        }
+    }
+
+    poller.Stop();
+    ShutdownDiagnostics();
+    return 0;
+}
+
+#endif
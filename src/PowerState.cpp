@@ -0,0 +1,171 @@
+#include "PowerState.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <thread>
+#include "Logger.h"
+#endif
+
+const char* PowerEventName(PowerEvent event) {
+    switch (event) {
+    case PowerEvent::Suspend: return "suspend";
+    case PowerEvent::Resume: return "resume";
+    case PowerEvent::DisplayOff: return "display_off";
+    case PowerEvent::DisplayOn: return "display_on";
+    case PowerEvent::LidClosed: return "lid_closed";
+    case PowerEvent::LidOpened: return "lid_opened";
+    case PowerEvent::SaverOn: return "saver_on";
+    case PowerEvent::SaverOff: return "saver_off";
+    }
+    return "unknown";
+}
+
+void PowerState::Apply(PowerEvent event) {
+    switch (event) {
+    case PowerEvent::Suspend: suspended = true; break;
+    case PowerEvent::Resume:
+        // The display and lid report their state again after resume
+        suspended = false;
+        break;
+    case PowerEvent::DisplayOff: displayOff = true; break;
+    case PowerEvent::DisplayOn: displayOff = false; break;
+    case PowerEvent::LidClosed: lidClosed = true; break;
+    case PowerEvent::LidOpened: lidClosed = false; break;
+    case PowerEvent::SaverOn: batterySaver = true; break;
+    case PowerEvent::SaverOff: batterySaver = false; break;
+    }
+}
+
+bool ManualPowerSource::Start(Sink handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sink = std::move(handler);
+    return true;
+}
+
+void ManualPowerSource::Stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    sink = nullptr;
+}
+
+void ManualPowerSource::Emit(PowerEvent event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sink) sink(event);
+}
+
+#ifdef _WIN32
+
+namespace {
+
+// Spelled out rather than pulled in with <initguid.h>
+const GUID ConsoleDisplayState = {0x6fe69556, 0x704a, 0x47a0, {0x8f, 0x24, 0xc2, 0x8d, 0x93, 0x6f, 0xda, 0x47}};
+const GUID LidSwitchStateChange = {0xba3e0f4d, 0xb817, 0x4094, {0xa2, 0xd1, 0xd5, 0x63, 0x79, 0xe6, 0xa0, 0xf3}};
+const GUID PowerSavingStatus = {0xe00958c0, 0xc213, 0x4ace, {0xac, 0x77, 0xfe, 0xcc, 0xed, 0x2e, 0xee, 0xa5}};
+
+// Broadcasts are not delivered to message-only windows, so this is a
+// hidden top-level window with its own thread and message loop.
+class WindowsPowerSource : public PowerEventSource {
+public:
+    ~WindowsPowerSource() override { Stop(); }
+
+    bool Start(Sink handler) override {
+        sink = std::move(handler);
+        ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+        thread = std::thread(&WindowsPowerSource::Run, this);
+        WaitForSingleObject(ready, INFINITE);
+        CloseHandle(ready);
+        return hwnd != NULL;
+    }
+
+    void Stop() override {
+        if (!thread.joinable()) return;
+        if (hwnd) PostMessage(hwnd, WM_CLOSE, 0, 0);
+        thread.join();
+        hwnd = NULL;
+    }
+
+private:
+    static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        auto* self = reinterpret_cast<WindowsPowerSource*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+        if (msg == WM_POWERBROADCAST && self) {
+            self->OnPowerBroadcast(wParam, lParam);
+            return TRUE;
+        }
+        if (msg == WM_DESTROY) PostQuitMessage(0);
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
+    void OnPowerBroadcast(WPARAM wParam, LPARAM lParam) {
+        switch (wParam) {
+        case PBT_APMSUSPEND:
+            sink(PowerEvent::Suspend);
+            break;
+        case PBT_APMRESUMEAUTOMATIC:
+        case PBT_APMRESUMESUSPEND:
+            // Both arrive after a user-initiated resume; the second is a no-op
+            sink(PowerEvent::Resume);
+            break;
+        case PBT_POWERSETTINGCHANGE: {
+            auto* setting = reinterpret_cast<const POWERBROADCAST_SETTING*>(lParam);
+            if (!setting || setting->DataLength < sizeof(DWORD)) break;
+            DWORD value = *reinterpret_cast<const DWORD*>(setting->Data);
+            if (IsEqualGUID(setting->PowerSetting, ConsoleDisplayState)) {
+                sink(value == 0 ? PowerEvent::DisplayOff : PowerEvent::DisplayOn);
+            } else if (IsEqualGUID(setting->PowerSetting, LidSwitchStateChange)) {
+                sink(value == 0 ? PowerEvent::LidClosed : PowerEvent::LidOpened);
+            } else if (IsEqualGUID(setting->PowerSetting, PowerSavingStatus)) {
+                sink(value ? PowerEvent::SaverOn : PowerEvent::SaverOff);
+            }
+            break;
+        }
+        }
+    }
+
+    void Run() {
+        WNDCLASSEX wc = {0};
+        wc.cbSize = sizeof(wc);
+        wc.lpfnWndProc = WndProc;
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = L"RazerBatteryPowerClass";
+        RegisterClassEx(&wc);
+        hwnd = CreateWindowEx(0, wc.lpszClassName, L"RazerBatteryPower", 0, 0, 0, 0, 0, NULL, NULL, wc.hInstance, NULL);
+        if (!hwnd) {
+            LOG_ERROR("Power notification window failed: " << GetLastError());
+            SetEvent(ready);
+            return;
+        }
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+
+        // Each registration also reports the current value right away
+        HPOWERNOTIFY notifications[] = {
+            RegisterPowerSettingNotification(hwnd, &ConsoleDisplayState, DEVICE_NOTIFY_WINDOW_HANDLE),
+            RegisterPowerSettingNotification(hwnd, &LidSwitchStateChange, DEVICE_NOTIFY_WINDOW_HANDLE),
+            RegisterPowerSettingNotification(hwnd, &PowerSavingStatus, DEVICE_NOTIFY_WINDOW_HANDLE),
+        };
+        SetEvent(ready);
+
+        MSG msg;
+        while (GetMessage(&msg, NULL, 0, 0) > 0) DispatchMessage(&msg);
+
+        for (HPOWERNOTIFY notification : notifications) {
+            if (notification) UnregisterPowerSettingNotification(notification);
+        }
+    }
+
+    Sink sink;
+    HWND hwnd = NULL;
+    HANDLE ready = NULL;
+    std::thread thread;
+};
+
+} // namespace
+
+std::unique_ptr<PowerEventSource> CreateSystemPowerSource() {
+    return std::make_unique<WindowsPowerSource>();
+}
+
+#else
+
+std::unique_ptr<PowerEventSource> CreateSystemPowerSource() {
+    return nullptr;
+}
+
+#endif
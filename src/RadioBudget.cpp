@@ -0,0 +1,20 @@
+#include "RadioBudget.h"
+#include <algorithm>
+
+const char* RadioBudgetStateName(RadioBudgetState state) {
+    switch (state) {
+    case RadioBudgetState::Normal: return "normal";
+    case RadioBudgetState::Stretched: return "stretched";
+    case RadioBudgetState::Exhausted: return "exhausted";
+    }
+    return "unknown";
+}
+
+RadioBudgetState RadioBudget::StateAt(uint64_t usedToday, int64_t secondsIntoDay) const {
+    if (dailyTransfers == 0) return RadioBudgetState::Normal;
+    if (usedToday >= dailyTransfers) return RadioBudgetState::Exhausted;
+    const int64_t day = 86400;
+    int64_t elapsed = std::clamp<int64_t>(secondsIntoDay + headStartSeconds, 0, day);
+    double pace = static_cast<double>(dailyTransfers) * static_cast<double>(elapsed) / day;
+    return static_cast<double>(usedToday) >= pace ? RadioBudgetState::Stretched : RadioBudgetState::Normal;
+}
@@ -1,5 +1,9 @@
 #include "RazerDevice.h"
 #include "Logger.h"
+#include "EventLog.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "DeviceKey.h"
 #include <libusb.h>
 #include <vector>
 #include <iostream>
@@ -7,26 +11,29 @@
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+
+// Seconds since epoch; days are UTC days (second / 86400)
+static int64_t UtcSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
-RazerDevice::RazerDevice(libusb_device* device, int pid)
-    : device(device), handle(nullptr), pid(pid), workingInterface(-1) {
-    if (device) {
-        libusb_ref_device(device);
-    }
+RazerDevice::RazerDevice(std::shared_ptr<UsbDevice> device, int pid, unsigned int responseDelayMs)
+    : device(std::move(device)), pid(pid), responseDelayMs(responseDelayMs), workingInterface(-1) {
 }
 
 RazerDevice::~RazerDevice() {
     Close();
-    if (device) {
-        libusb_unref_device(device);
-        device = nullptr;
-    }
 }
 
-bool RazerDevice::IsSameDevice(libusb_device* other) {
-    if (!device || !other) return false;
-    return (libusb_get_bus_number(device) == libusb_get_bus_number(other)) &&
-           (libusb_get_device_address(device) == libusb_get_device_address(other));
+bool RazerDevice::IsSameDevice(const UsbDevice& other) const {
+    if (!device) return false;
+    return (device->GetBusNumber() == other.GetBusNumber()) &&
+           (device->GetAddress() == other.GetAddress());
 }
 
 bool RazerDevice::Open() {
@@ -34,27 +41,288 @@ bool RazerDevice::Open() {
 
     if (!device) return false;
 
-    int r = libusb_open(device, &handle);
-    if (r != 0) {
-        return false;
+    int r = 0;
+    handle = device->Open(r);
+    return handle != nullptr;
+}
+
+void RazerDevice::Close() {
+    StopListening();
+    if (handle) {
+        if (workingInterface != -1) {
+            handle->ReleaseInterface(workingInterface);
+            workingInterface = -1;
+        }
+        handle.reset();
     }
+}
 
-    if (libusb_has_capability(LIBUSB_CAP_SUPPORTS_DETACH_KERNEL_DRIVER)) {
-        libusb_set_auto_detach_kernel_driver(handle, 1);
+DeviceStatus RazerDevice::QueryStatus(bool idleAware, const Deadline& budget) {
+    const uint64_t ttlUs = StatusTtlMs * 1000ull;
+    const uint64_t staleUs = StatusStaleMs * 1000ull;
+
+    std::unique_lock<std::mutex> lock(flightMutex);
+    if (inFlight) {
+        uint64_t age = EventLog::NowUs() - cachedAtUs;
+        if (cacheValid && age < ttlUs + staleUs) {
+            // Revalidation is already under way; do not queue behind it
+            cacheMetrics->staleHits.fetch_add(1, std::memory_order_relaxed);
+            cacheMetrics->cacheAge.Record(age);
+            return cachedStatus;
+        }
+        // Join the flight, but not past our own deadline
+        uint64_t generation = flightGeneration;
+        while (flightGeneration == generation && !budget.Expired()) {
+            flightDone.wait_for(lock, std::chrono::milliseconds(budget.Cap(TransferTimeoutMs)));
+        }
+        if (flightGeneration != generation) {
+            if (cacheMetrics) cacheMetrics->coalesced.fetch_add(1, std::memory_order_relaxed);
+            return flightResult;
+        }
+        DeviceStatus status = cacheValid ? cachedStatus : DeviceStatus();
+        if (!cacheValid) {
+            std::wstring key = MakeDeviceKey(L"", pid);
+            status.serial = std::string(key.begin(), key.end());
+            status.pid = pid;
+            status.type = GetType();
+        }
+        status.error = "timeout";
+        return status;
+    }
+    if (cacheValid) {
+        uint64_t age = EventLog::NowUs() - cachedAtUs;
+        if (age < ttlUs) {
+            cacheMetrics->cacheHits.fetch_add(1, std::memory_order_relaxed);
+            cacheMetrics->cacheAge.Record(age);
+            return cachedStatus;
+        }
     }
+    inFlight = true;
+    uint64_t eventsBefore = eventCount;
+    lock.unlock();
+
+    DeviceStatus status = FetchStatus(idleAware, budget);
+
+    lock.lock();
+    if (eventCount != eventsBefore && cacheValid) {
+        // A notification arrived while the query ran: it is the newer word
+        // on the battery, whatever the query read before it
+        status.level = cachedStatus.level;
+        status.charging = cachedStatus.charging;
+        status.asleep = cachedStatus.asleep;
+        status.error = cachedStatus.error;
+    }
+    inFlight = false;
+    flightGeneration++;
+    flightResult = status;
+    cacheMetrics = &GetMetrics();
+    cacheMetrics->cacheMisses.fetch_add(1, std::memory_order_relaxed);
+    // A cut-short query says nothing new; the next caller tries again
+    if (status.error != "timeout") {
+        cachedStatus = status;
+        cachedAtUs = EventLog::NowUs();
+        cacheValid = true;
+    }
+    flightDone.notify_all();
+    return status;
+}
+
+DeviceStatus RazerDevice::FetchStatus(bool idleAware, const Deadline& budget) {
+    auto start = std::chrono::steady_clock::now();
+    deadline = budget;
+
+    DeviceStatus status;
+    std::wstring key = MakeDeviceKey(GetSerial(), pid);
+    status.serial = std::string(key.begin(), key.end());
+    status.pid = pid;
+    status.type = GetType();
+    std::wstring name = GetName();
+    status.name = std::string(name.begin(), name.end());
+
+    DeviceMetrics& deviceMetrics = GetMetrics();
+    deviceMetrics.transferBudget.store(transferBudget.load(), std::memory_order_relaxed);
+    bool overBudget = BudgetState(deviceMetrics) == RadioBudgetState::Exhausted;
+
+    bool dozing = ProbablyAsleep();
+    ProbeResult probe = ProbeResult::Inconclusive;
+    if (idleAware && dozing && !overBudget) probe = ProbeBattery(status.level);
+
+    if (overBudget) {
+        // Nothing more goes over the air today
+        deviceMetrics.overBudgetReads.fetch_add(1, std::memory_order_relaxed);
+        LastReading(status);
+        status.lowBatteryThreshold = thresholdQueried ? lowBatteryThreshold : -1;
+        status.error = "over_budget";
+    } else if (probe == ProbeResult::Asleep) {
+        // Serve the last reading rather than wake the radio for a new one
+        asleep = true;
+        GetMetrics().asleepReads.fetch_add(1, std::memory_order_relaxed);
+        status.asleep = true;
+        LastReading(status);
+        status.lowBatteryThreshold = thresholdQueried ? lowBatteryThreshold : -1;
+        if (status.level == -1) status.error = "asleep";
+    } else {
+        if (probe == ProbeResult::Inconclusive) status.level = GetBatteryLevel();
+        if (status.level != -1) {
+            if (dozing) RecordWakeup();
+            asleep = false;
+            status.charging = IsCharging();
+            status.lowBatteryThreshold = GetLowBatteryThreshold();
+            GetIdleTime();
+        } else if (deadline.Expired()) {
+            // Out of time, not an answer: keep showing the last reading
+            LastReading(status);
+            status.lowBatteryThreshold = thresholdQueried ? lowBatteryThreshold : -1;
+            status.error = "timeout";
+        } else {
+            asleep = deviceUnreachable;
+            status.error = unavailable ? "unavailable" : "query_failed";
+        }
+    }
+    status.latencyMs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    return status;
+}
+
+// The cached status rather than the last query's own reading, since
+// notifications update it between queries
+void RazerDevice::LastReading(DeviceStatus& status) {
+    std::lock_guard<std::mutex> lock(flightMutex);
+    status.level = cacheValid ? cachedStatus.level : lastBatteryLevel;
+    status.charging = cacheValid ? cachedStatus.charging : lastCharging;
+}
 
+bool RazerDevice::ProbablyAsleep() const {
+    if (asleep) return true;
+    if (idleTimeSeconds <= 0 || lastContactUs == 0) return false;
+    return EventLog::NowUs() - lastContactUs > static_cast<uint64_t>(idleTimeSeconds) * 1000000;
+}
+
+// One exchange with the battery query that answered last time, on the
+// interface and strategy that answered it, with a short deadline and no
+// fallbacks. A receiver-side "busy"/"no response" status or a timeout
+// means the device is not awake to answer.
+RazerDevice::ProbeResult RazerDevice::ProbeBattery(int& level) {
+    if (!handle || workingInterface == -1 || workingStrategy == EventStrategy::None || answeredTid == 0) {
+        return ProbeResult::Inconclusive;
+    }
+
+    TRACE_SCOPE("ProbeBattery");
+    razer_report request = get_razer_report(answeredQuery.commandClass, answeredQuery.commandId, answeredQuery.dataSize);
+    razer_report response = {0};
+    request.transaction_id.id = answeredTid;
+    request.crc = razer_calculate_crc(&request);
+
+    uint64_t startUs = EventLog::NowUs();
+    int transferred = Exchange(workingInterface, workingStrategy, request, response, ProbeTimeoutMs);
+    if (transferred == 90 && response.status == 0x02) {
+        int raw = answeredQuery.scaleFromByte ? razer_scale_battery(response.arguments[1])
+                                              : static_cast<int>(response.arguments[1]);
+        uint64_t endUs = EventLog::NowUs();
+        DeviceMetrics& deviceMetrics = GetMetrics();
+        deviceMetrics.batteryLatency.Record(endUs - startUs);
+        deviceMetrics.lastBatterySuccessUs.store(endUs, std::memory_order_relaxed);
+        Breaker(answeredQuery.commandClass, answeredQuery.commandId).RecordSuccess();
+        unavailable = false;
+        level = lastBatteryLevel = std::clamp(raw, 0, 100);
+        return ProbeResult::Answered;
+    }
+    if (transferred != 90 && deadline.Expired()) return ProbeResult::Inconclusive;
+    if (transferred == 90 ? (response.status == 0x01 || response.status == 0x04)
+                          : transferred == LIBUSB_ERROR_TIMEOUT) {
+        return ProbeResult::Asleep;
+    }
+    return ProbeResult::Inconclusive;
+}
+
+// An answer from a device that had been quiet for longer than its idle
+// time: the query most likely woke its radio (or the user just did).
+void RazerDevice::RecordWakeup() {
+    GetMetrics().RecordWakeup(UtcSeconds() / 86400);
+}
+
+void RazerDevice::CountTransfer(int result) {
+    GetMetrics().RecordTransfer(UtcSeconds() / 86400, result > 0 ? static_cast<uint64_t>(result) : 0);
+}
+
+RadioBudgetState RazerDevice::BudgetState(const DeviceMetrics& deviceMetrics) const {
+    int64_t now = UtcSeconds();
+    return RadioBudget{transferBudget.load()}.StateAt(deviceMetrics.TransfersOn(now / 86400), now % 86400);
+}
+
+RadioBudgetState RazerDevice::GetBudgetState() {
+    std::lock_guard<std::mutex> lock(flightMutex);
+    return cacheMetrics ? BudgetState(*cacheMetrics) : RadioBudgetState::Normal;
+}
+
+bool RazerDevice::StartListening(ChangeCallback callback) {
+    if (listening) return true;
+    StopListening(); // a listener that ended on an error
+    if (!handle || workingInterface == -1 || workingInterface == refusedInterface) return false;
+
+    onChange = std::move(callback);
+    int r = handle->StartListening(workingInterface, [this](const unsigned char* data, int length) {
+        OnReport(data, length);
+    });
+    if (r != 0) {
+        LOG_DEBUG("No notifications from " << GetKeyString() << " on interface " << workingInterface << " (" << r << ")");
+        refusedInterface = workingInterface;
+        onChange = nullptr;
+        return false;
+    }
+    listeningInterface = workingInterface;
+    listening = true;
+    LOG_INFO("Listening for notifications from " << GetKeyString() << " on interface " << workingInterface);
     return true;
 }
 
-void RazerDevice::Close() {
-    if (handle) {
-        if (workingInterface != -1) {
-            libusb_release_interface(handle, workingInterface);
-            workingInterface = -1;
+void RazerDevice::StopListening() {
+    if (listeningInterface == -1) return;
+    if (handle) handle->StopListening();
+    listeningInterface = -1;
+    listening = false;
+    onChange = nullptr;
+}
+
+void RazerDevice::OnReport(const unsigned char* data, int length) {
+    if (length < 0) {
+        listening = false; // device gone; StartListening cleans up
+        return;
+    }
+    DeviceEvent event;
+    bool known = DecodeDeviceEvent(data, length, event);
+    DeviceStatus status;
+    {
+        std::lock_guard<std::mutex> lock(flightMutex);
+        if (cacheMetrics) (known ? cacheMetrics->notifications : cacheMetrics->ignoredReports).fetch_add(1, std::memory_order_relaxed);
+        if (!known || !cacheValid) return;
+        cachedAtUs = EventLog::NowUs();
+        switch (event.kind) {
+        case DeviceEventKind::Battery:
+            cachedStatus.level = event.level;
+            cachedStatus.error.clear();
+            cachedStatus.asleep = false;
+            break;
+        case DeviceEventKind::Charging:
+            cachedStatus.charging = event.charging;
+            cachedStatus.asleep = false;
+            break;
+        case DeviceEventKind::Connected:
+            // Back in range: the level may have moved meanwhile, so the
+            // next query goes to the device instead of this cache
+            cachedStatus.asleep = false;
+            cachedAtUs = 0;
+            break;
+        case DeviceEventKind::Disconnected:
+            // Out of range or switched off: the last reading stands
+            cachedStatus.asleep = true;
+            break;
         }
-        libusb_close(handle);
-        handle = nullptr;
+        eventCount++;
+        status = cachedStatus;
     }
+    notified = true;
+    onChange(event.kind, status);
 }
 
 RazerDeviceType RazerDevice::GetType() const {
@@ -62,34 +330,26 @@ RazerDeviceType RazerDevice::GetType() const {
 }
 
 std::wstring RazerDevice::GetName() const {
-    return L"Razer Device"; // Placeholder
-}
-
-unsigned char RazerDevice::CalculateCRC(razer_report* report) {
-    unsigned char crc = 0;
-    unsigned char* bytes = (unsigned char*)report;
-    // XOR bytes 2 to 88
-    for (int i = 2; i < 88; i++) {
-        crc ^= bytes[i];
-    }
-    return crc;
+    const char* name = GetRazerDeviceName(pid);
+    if (!name) return L"Razer Device";
+    std::string s(name);
+    return std::wstring(s.begin(), s.end());
 }
 
 bool RazerDevice::SendRequest(razer_report& request, razer_report& response) {
+    TRACE_SCOPE("SendRequest");
+    deviceUnreachable = false;
     if (!handle) {
         if (!Open()) return false;
     }
 
     if (request.transaction_id.id == 0) request.transaction_id.id = 0xFF;
-    request.crc = CalculateCRC(&request);
+    request.crc = razer_calculate_crc(&request);
 
-    libusb_config_descriptor* config = nullptr;
-    uint8_t interfaceCount = 0;
-    if (libusb_get_active_config_descriptor(device, &config) == 0 && config) {
-        interfaceCount = config->bNumInterfaces;
+    int interfaceCount = device->GetInterfaceCount();
+    if (interfaceCount > 0) {
         // Логируем количество доступных интерфейсов, чтобы понимать, что мы пробуем
-        LOG_DEBUG("Интерфейсов в активной конфигурации: " << static_cast<int>(interfaceCount));
-        libusb_free_config_descriptor(config);
+        LOG_DEBUG("Интерфейсов в активной конфигурации: " << interfaceCount);
     } else {
         LOG_DEBUG("Не удалось прочитать активную конфигурацию, используем интерфейсы по умолчанию");
     }
@@ -99,8 +359,8 @@ bool RazerDevice::SendRequest(razer_report& request, razer_report& response) {
         interfaces.push_back(workingInterface);
     } else {
         if (interfaceCount > 0) {
-            for (uint8_t i = 0; i < interfaceCount; ++i) {
-                interfaces.push_back(static_cast<int>(i));
+            for (int i = 0; i < interfaceCount; ++i) {
+                interfaces.push_back(i);
             }
         } else {
             interfaces = {0, 1, 2, 3, 4};
@@ -110,7 +370,7 @@ bool RazerDevice::SendRequest(razer_report& request, razer_report& response) {
     for (int iface : interfaces) {
         bool claimed = (workingInterface == iface);
         if (!claimed) {
-            int r = libusb_claim_interface(handle, iface);
+            int r = handle->ClaimInterface(iface);
             if (r == 0) {
                 claimed = true;
             } else {
@@ -118,60 +378,46 @@ bool RazerDevice::SendRequest(razer_report& request, razer_report& response) {
             }
         }
 
-        bool success = false;
-
         // Strategy 1: Feature Report
-        int transferred = libusb_control_transfer(handle,
-            0x21, 0x09, 0x0300, iface,
-            (unsigned char*)&request, 90, 1000);
-
-        if (transferred == 90) {
-            Sleep(50);
-            transferred = libusb_control_transfer(handle,
-                0xA1, 0x01, 0x0300, iface,
-                (unsigned char*)&response, 90, 1000);
-
-            if (transferred == 90 && response.status == 0x02) {
-                success = true;
-            }
-        }
+        EventStrategy strategy = EventStrategy::FeatureReport;
+        int transferred = Exchange(iface, strategy, request, response, TransferTimeoutMs);
+        bool success = transferred == 90 && response.status == 0x02;
+        // Busy / no response: the receiver answered for a wireless device it
+        // cannot reach. The path works; the device is asleep or out of range.
+        deviceUnreachable = transferred == 90 && (response.status == 0x01 || response.status == 0x04);
 
         // Strategy 2: Output Report + Input Report (Fallback)
-        if (!success) {
-            transferred = libusb_control_transfer(handle,
-                0x21, 0x09, 0x0200, iface,
-                (unsigned char*)&request, 90, 1000);
-
-            if (transferred == 90) {
-                Sleep(50);
-                // Input Report (0x0100)
-                transferred = libusb_control_transfer(handle,
-                    0xA1, 0x01, 0x0100, iface,
-                    (unsigned char*)&response, 90, 1000);
-
-                if (transferred == 90 && response.status == 0x02) {
-                    success = true;
-                }
-            }
+        if (!success && !deviceUnreachable && !deadline.Expired()) {
+            strategy = EventStrategy::OutputInputReport;
+            transferred = Exchange(iface, strategy, request, response, TransferTimeoutMs);
+            success = transferred == 90 && response.status == 0x02;
+            deviceUnreachable = transferred == 90 && (response.status == 0x01 || response.status == 0x04);
         }
 
+        if (!success && !deviceUnreachable && deadline.Expired()) {
+            // Out of time: the interface is not to blame, keep it for next time
+            if (workingInterface != iface) handle->ReleaseInterface(iface);
+            return false;
+        }
+        if (deviceUnreachable) {
+            // Keep the interface: retrying others would only repeat the answer
+            workingInterface = iface;
+            workingStrategy = strategy;
+            return false;
+        }
         if (success) {
             if (workingInterface == -1) {
                 workingInterface = iface;
             }
+            workingStrategy = strategy;
             return true;
         } else {
             if (workingInterface == iface) {
-                libusb_release_interface(handle, iface);
+                StopListening();
+                handle->ReleaseInterface(iface);
                 workingInterface = -1;
-                // Try to recover by trying other interfaces in this same call?
-                // For simplicity, we fail this call. The loop won't continue if interfaces had only 1 element.
-                // If interfaces had {0, 1, 2}, it continues.
-                // But if workingInterface was set, interfaces has {workingInterface}.
-                // We should probably fall back to scanning if cache failed?
-                // Yes, ideally. But let's keep it simple.
             } else {
-                libusb_release_interface(handle, iface);
+                handle->ReleaseInterface(iface);
             }
         }
     }
@@ -179,14 +425,144 @@ bool RazerDevice::SendRequest(razer_report& request, razer_report& response) {
     return false;
 }
 
-int RazerDevice::GetBatteryLevel() {
-    struct BatteryQuery {
-        uint8_t commandClass;
-        uint8_t commandId;
-        uint8_t dataSize;
-        bool scaleFromByte;
-    };
+bool RazerDevice::SendOptional(razer_report& request, razer_report& response) {
+    TRACE_SCOPE("SendOptional");
+    deviceUnreachable = false;
+    if (!handle || workingInterface == -1 || workingStrategy == EventStrategy::None) return false;
+
+    request.transaction_id.id = answeredTid != 0 ? answeredTid : 0xFF;
+    request.crc = razer_calculate_crc(&request);
+
+    int transferred = Exchange(workingInterface, workingStrategy, request, response, TransferTimeoutMs);
+    if (transferred == 90) {
+        // The device answered: yes, busy or not supported. The path works.
+        deviceUnreachable = response.status == 0x01 || response.status == 0x04;
+        return response.status == 0x02;
+    }
+    if (!deadline.Expired()) {
+        // A transport error on the interface that just answered: drop it
+        // like SendRequest does, so the next query scans again
+        StopListening();
+        handle->ReleaseInterface(workingInterface);
+        workingInterface = -1;
+    }
+    return false;
+}
 
+int RazerDevice::Exchange(int iface, EventStrategy strategy, razer_report& request, razer_report& response,
+                          unsigned int timeoutMs) {
+    bool feature = strategy == EventStrategy::FeatureReport;
+    // Each transfer waits min(its timeout, what is left of the deadline)
+    unsigned int capMs = deadline.Cap(timeoutMs);
+    if (capMs == 0) return LIBUSB_ERROR_TIMEOUT; // out of time: nothing sent
+    bool cut = capMs < timeoutMs;
+
+    uint64_t startUs = EventLog::NowUs();
+    int transferred = handle->ControlTransfer(
+        0x21, 0x09, feature ? 0x0300 : 0x0200, iface,
+        (unsigned char*)&request, 90, capMs);
+    CountTransfer(transferred);
+
+    if (transferred == 90) {
+        {
+            TRACE_SCOPE("response delay");
+            std::this_thread::sleep_for(std::chrono::milliseconds(deadline.Cap(responseDelayMs)));
+        }
+        capMs = deadline.Cap(timeoutMs);
+        cut = cut || capMs < timeoutMs;
+        // Feature report, or Input Report (0x0100)
+        transferred = capMs == 0 ? LIBUSB_ERROR_TIMEOUT : handle->ControlTransfer(
+            0xA1, 0x01, feature ? 0x0300 : 0x0100, iface,
+            (unsigned char*)&response, 90, capMs);
+        if (capMs != 0) CountTransfer(transferred);
+    }
+    RecordEvent(request, response, iface, static_cast<uint8_t>(strategy), startUs, transferred);
+
+    if (transferred == 90 && response.status == 0x02) lastContactUs = EventLog::NowUs();
+    else if (transferred == 90 || !cut) uncutFailures++;
+    return transferred;
+}
+
+void RazerDevice::RecordEvent(const razer_report& request, const razer_report& response,
+                              int iface, uint8_t strategy, uint64_t startUs, int result) {
+    uint64_t endUs = EventLog::NowUs();
+    uint64_t latencyUs = endUs - startUs;
+
+    if (Trace::IsEnabled()) {
+        TraceArg args[] = {{"interface", iface}, {"strategy", strategy},
+                           {"tid", request.transaction_id.id},
+                           {"command", (request.command_class << 8) | request.command_id.id}};
+        Trace::Complete("SendRequest attempt", startUs, endUs, args, 4);
+    }
+
+    ProtocolMetrics& metrics = MetricsRegistry::Instance().ForProtocol(
+        iface, strategy, request.transaction_id.id, request.command_class, request.command_id.id);
+    metrics.latency.Record(latencyUs);
+    if (result == 90 && response.status == 0x02) {
+        metrics.successes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    EventLog& log = EventLog::Instance();
+    if (!log.IsEnabled()) return;
+
+    ProtocolEvent event = {};
+    event.timestampUs = startUs;
+    std::string key = GetKeyString();
+    memcpy(event.deviceKey, key.data(), std::min(key.size(), sizeof(event.deviceKey)));
+    event.pid = static_cast<uint16_t>(pid);
+    event.interfaceNumber = static_cast<int8_t>(iface);
+    event.strategy = strategy;
+    event.transactionId = request.transaction_id.id;
+    event.commandClass = request.command_class;
+    event.commandId = request.command_id.id;
+    event.status = response.status;
+    event.latencyUs = static_cast<uint32_t>(latencyUs);
+    event.result = static_cast<int16_t>(result);
+    log.Append(event);
+}
+
+std::string RazerDevice::GetKeyString() const {
+    if (cachedSerial.empty()) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "PID_%x", pid);
+        return buf;
+    }
+    return std::string(cachedSerial.begin(), cachedSerial.end());
+}
+
+CircuitBreaker& RazerDevice::Breaker(uint8_t commandClass, uint8_t commandId) {
+    uint16_t command = static_cast<uint16_t>(commandClass << 8 | commandId);
+    auto it = breakers.find(command);
+    if (it == breakers.end()) {
+        // Seeded per device and command so their jitter differs
+        uint32_t seed = static_cast<uint32_t>(std::hash<std::string>()(GetKeyString())) ^ command;
+        it = breakers.emplace(command, CircuitBreaker(seed)).first;
+    }
+    return it->second;
+}
+
+bool RazerDevice::AllowCommand(CircuitBreaker& breaker, uint64_t nowUs) {
+    if (breaker.Allow(nowUs)) return true;
+    GetMetrics().skippedQueries.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void RazerDevice::CommandFailed(CircuitBreaker& breaker, uint8_t commandClass, uint8_t commandId) {
+    if (!breaker.RecordFailure(EventLog::NowUs())) return;
+    GetMetrics().breakerTrips.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("Command 0x" << std::hex << static_cast<int>(commandClass) << "/0x" << static_cast<int>(commandId)
+             << std::dec << " keeps failing for " << GetKeyString() << "; backing off");
+}
+
+DeviceMetrics& RazerDevice::GetMetrics() {
+    if (metrics) return *metrics;
+    DeviceMetrics& m = MetricsRegistry::Instance().ForDevice(GetKeyString());
+    // Only pin the entry once the serial is known; PID keys are provisional
+    if (!cachedSerial.empty()) metrics = &m;
+    return m;
+}
+
+int RazerDevice::GetBatteryLevel() {
     // 0x07/0x80 — классический запрос (0-255), 0x0F/0x02 — снифф с BlackShark V2 Pro 2023 (PID 0x0555), сразу отдаёт проценты.
     const BatteryQuery queries[] = {
         {0x07, 0x80, 0x02, true},
@@ -195,66 +571,157 @@ int RazerDevice::GetBatteryLevel() {
 
     uint8_t ids[] = {0xFF, 0x1F, 0x3F};
 
+    TRACE_SCOPE("GetBatteryLevel");
+    DeviceMetrics& deviceMetrics = GetMetrics();
+    uint64_t startUs = EventLog::NowUs();
+    bool tried = false;
+
     for (const auto& query : queries) {
+        CircuitBreaker& breaker = Breaker(query.commandClass, query.commandId);
+        if (!AllowCommand(breaker, startUs)) continue;
+        tried = true;
+        uint64_t failuresBefore = uncutFailures;
         for (uint8_t id : ids) {
-            razer_report request = {0};
+            razer_report request = get_razer_report(query.commandClass, query.commandId, query.dataSize);
             razer_report response = {0};
-
-            request.command_class = query.commandClass;
-            request.command_id.id = query.commandId;
-            request.data_size = query.dataSize;
             request.transaction_id.id = id;
 
             if (SendRequest(request, response)) {
                 int level = query.scaleFromByte
-                    ? static_cast<int>(std::lround((response.arguments[1] / 255.0) * 100.0))
+                    ? razer_scale_battery(response.arguments[1])
                     : static_cast<int>(response.arguments[1]);
 
+                uint64_t endUs = EventLog::NowUs();
+                deviceMetrics.batteryLatency.Record(endUs - startUs);
+                deviceMetrics.lastBatterySuccessUs.store(endUs, std::memory_order_relaxed);
+                if (&query != &queries[0]) {
+                    deviceMetrics.commandFallbacks.fetch_add(1, std::memory_order_relaxed);
+                } else if (id != ids[0]) {
+                    deviceMetrics.tidFallbacks.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                breaker.RecordSuccess();
+                unavailable = false;
+                answeredQuery = query;
+                answeredTid = id;
                 lastBatteryLevel = std::clamp(level, 0, 100);
                 return lastBatteryLevel;
             }
+            if (deviceUnreachable || deadline.Expired()) break;
+        }
+        // The receiver answering for an absent device says nothing about
+        // the command, and no fallback will reach it either
+        if (deviceUnreachable) {
+            breaker.RecordNoOutcome();
+            break;
         }
+        // Cut short by the deadline: only a full-length failure counts
+        bool cut = deadline.Expired();
+        if (!cut || uncutFailures > failuresBefore) CommandFailed(breaker, query.commandClass, query.commandId);
+        else breaker.RecordNoOutcome();
+        if (cut) break;
     }
-    lastBatteryLevel = -1;
+    bool cut = deadline.Expired();
+    if (tried && !cut) {
+        deviceMetrics.batteryLatency.Record(EventLog::NowUs() - startUs);
+        deviceMetrics.batteryFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+    unavailable = std::all_of(std::begin(queries), std::end(queries), [this](const BatteryQuery& query) {
+        return Breaker(query.commandClass, query.commandId).GetState() == BreakerState::Open;
+    });
+    if (!cut) lastBatteryLevel = -1;
     return -1;
 }
 
 bool RazerDevice::IsCharging() {
     uint8_t ids[] = {0xFF, 0x1F, 0x3F};
 
+    TRACE_SCOPE("IsCharging");
+    DeviceMetrics& deviceMetrics = GetMetrics();
+    uint64_t startUs = EventLog::NowUs();
+    CircuitBreaker& breaker = Breaker(0x07, 0x84);
+    if (!AllowCommand(breaker, startUs)) return false;
+
     for (uint8_t id : ids) {
-        razer_report request = {0};
+        razer_report request = get_razer_report(0x07, 0x84, 0x02); // Get Charging Status
         razer_report response = {0};
-
-        request.command_class = 0x07;
-        request.command_id.id = 0x84; // Get Charging Status
-        request.data_size = 0x02;
         request.transaction_id.id = id;
 
         if (SendRequest(request, response)) {
-            return response.arguments[1] == 1;
+            deviceMetrics.chargingLatency.Record(EventLog::NowUs() - startUs);
+            breaker.RecordSuccess();
+            lastCharging = response.arguments[1] == 1;
+            return lastCharging;
         }
+        if (deviceUnreachable || deadline.Expired()) break;
+    }
+    if (deadline.Expired()) {
+        breaker.RecordNoOutcome();
+        return lastCharging; // no answer either way
     }
+    deviceMetrics.chargingLatency.Record(EventLog::NowUs() - startUs);
+    deviceMetrics.chargingFailures.fetch_add(1, std::memory_order_relaxed);
+    if (!deviceUnreachable) CommandFailed(breaker, 0x07, 0x84);
+    else breaker.RecordNoOutcome();
     return false;
 }
 
+int RazerDevice::GetLowBatteryThreshold() {
+    if (thresholdQueried) return lowBatteryThreshold;
+    // Not until the battery has shown which path answers
+    if (workingInterface == -1 || workingStrategy == EventStrategy::None) return lowBatteryThreshold;
+    thresholdQueried = true;
+
+    TRACE_SCOPE("GetLowBatteryThreshold");
+    razer_report request = get_razer_report(0x07, 0x81, 0x01); // Get Low Battery Threshold
+    razer_report response = {0};
+    if (SendOptional(request, response)) {
+        // Same 0-255 scale as the battery level
+        lowBatteryThreshold = razer_scale_battery(response.arguments[0]);
+        LOG_DEBUG("Low battery threshold for PID " << std::hex << pid << std::dec << ": " << lowBatteryThreshold << "%");
+        return lowBatteryThreshold;
+    }
+    // No answer either way: ask again next time
+    if (deadline.Expired() || deviceUnreachable) thresholdQueried = false;
+    return lowBatteryThreshold;
+}
+
+int RazerDevice::GetIdleTime() {
+    if (idleQueried) return idleTimeSeconds;
+    if (workingInterface == -1 || workingStrategy == EventStrategy::None) return idleTimeSeconds;
+    idleQueried = true;
+
+    TRACE_SCOPE("GetIdleTime");
+    razer_report request = get_razer_report(0x07, 0x83, 0x02); // Get Idle Time
+    razer_report response = {0};
+    if (SendOptional(request, response)) {
+        // Seconds, big-endian
+        idleTimeSeconds = (response.arguments[0] << 8) | response.arguments[1];
+        LOG_DEBUG("Idle time for PID " << std::hex << pid << std::dec << ": " << idleTimeSeconds << "s");
+        return idleTimeSeconds;
+    }
+    if (deadline.Expired() || deviceUnreachable) idleQueried = false;
+    return idleTimeSeconds;
+}
+
 std::wstring RazerDevice::GetSerial() {
     if (!cachedSerial.empty()) return cachedSerial;
 
     if (!handle && !Open()) return L"";
 
+    TRACE_SCOPE("GetSerial");
+
     // Method 1: String Descriptor
-    // Get Device Descriptor to find iSerialNumber index
-    struct libusb_device_descriptor desc;
-    if (libusb_get_device_descriptor(device, &desc) == 0) {
-        if (desc.iSerialNumber > 0) {
-            unsigned char data[256];
-            int r = libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, data, sizeof(data));
-            if (r > 0) {
-                std::string s((char*)data, r);
-                cachedSerial = std::wstring(s.begin(), s.end());
-                return cachedSerial;
-            }
+    // iSerialNumber index comes from the device descriptor
+    uint8_t serialIndex = device->GetSerialNumberIndex();
+    unsigned int capMs = deadline.Cap(TransferTimeoutMs);
+    if (serialIndex > 0 && capMs > 0) {
+        unsigned char data[256];
+        int r = handle->GetStringDescriptorAscii(serialIndex, data, sizeof(data), capMs);
+        if (r > 0) {
+            std::string s((char*)data, r);
+            cachedSerial = std::wstring(s.begin(), s.end());
+            return cachedSerial;
         }
     }
 
@@ -262,11 +729,8 @@ std::wstring RazerDevice::GetSerial() {
     uint8_t ids[] = {0xFF, 0x1F, 0x3F};
 
     for (uint8_t id : ids) {
-        razer_report request = {0};
+        razer_report request = get_razer_report(0x00, 0x82, 0x16); // Get Serial, 22 bytes
         razer_report response = {0};
-        request.command_class = 0x00;
-        request.command_id.id = 0x82; // Get Serial
-        request.data_size = 0x16; // 22 bytes
         request.transaction_id.id = id;
 
         if (SendRequest(request, response)) {
@@ -277,12 +741,14 @@ std::wstring RazerDevice::GetSerial() {
             cachedSerial = std::wstring(s.begin(), s.end());
             return cachedSerial;
         }
+        if (deadline.Expired()) break;
     }
 
+    // Out of time: use the PID key for now and read the serial next time
+    if (deadline.Expired()) return MakeDeviceKey(L"", pid);
+
     // fallback
-    std::wstringstream wss;
-    wss << L"PID_" << std::hex << pid;
-    cachedSerial = wss.str();
+    cachedSerial = MakeDeviceKey(L"", pid);
 
     return cachedSerial;
 }
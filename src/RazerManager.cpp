@@ -1,148 +1,168 @@
 #include "RazerManager.h"
 #include "Logger.h"
-#include <libusb.h>
+#include "Trace.h"
+#include "DeviceKey.h"
 #include <map>
 #include <sstream>
 #include <iostream>
 
-RazerManager::RazerManager() : ctx(nullptr) {
-    int r = libusb_init(&ctx);
-    if (r < 0) {
-        LOG_ERROR("libusb_init failed: " << libusb_error_name(r));
-        ctx = nullptr;
-    } else {
-        // Optional: Set debug level
-        // libusb_set_option(ctx, LIBUSB_OPTION_LOG_LEVEL, LIBUSB_LOG_LEVEL_WARNING);
-    }
+RazerManager::RazerManager(std::shared_ptr<UsbBackend> backend, WorkPool* pool)
+    : backend(std::move(backend)), pool(pool) {
 }
 
 RazerManager::~RazerManager() {
+    // Devices hold backend objects; release them before the backend goes
     devices.clear();
-    if (ctx) {
-        libusb_exit(ctx);
-        ctx = nullptr;
-    }
+    backend.reset();
+}
+
+// Through the status cache, so the caller's own QueryStatus right after
+// enumerating does not repeat the query
+static int BatteryOf(RazerDevice& device, const Deadline& deadline) {
+    DeviceStatus status = device.QueryStatus(false, deadline);
+    return status.error.empty() ? status.level : -1;
 }
 
 const std::vector<std::shared_ptr<RazerDevice>>& RazerManager::GetDevices() const {
     return devices;
 }
 
-void RazerManager::EnumerateDevices() {
-    if (!ctx) return;
+void RazerManager::EnumerateDevices(bool queryBattery, const Deadline& deadline) {
+    if (!backend || !backend->IsAvailable()) return;
 
+    TRACE_SCOPE("EnumerateDevices");
     LOG_INFO("Enumerating devices with libusb...");
 
-    libusb_device** list;
-    ssize_t cnt = libusb_get_device_list(ctx, &list);
-    if (cnt < 0) {
-        LOG_ERROR("libusb_get_device_list failed: " << libusb_error_name((int)cnt));
-        return;
-    }
+    std::vector<std::shared_ptr<UsbDevice>> list = backend->ListDevices();
 
     // Map existing devices by Serial/Key to preserve instances
     std::map<std::wstring, std::shared_ptr<RazerDevice>> existingMap;
     for (auto& d : devices) {
-        std::wstring s = d->GetSerial();
-        if (!s.empty()) {
-            existingMap[s] = d;
-        } else {
-            // If serial is empty (failed to read), maybe map by PID + some index?
-            // Or just don't map.
-            // Fallback key used below:
-            std::wstringstream wss;
-            wss << L"PID_" << std::hex << d->GetPID();
-            existingMap[wss.str()] = d;
+        // Empty serial (failed to read) falls back to the same PID key used below
+        existingMap[MakeDeviceKey(d->GetSerial(), d->GetPID())] = d;
+    }
+
+    // Reading the serial can fall back to the 0x00/0x82 report and take a
+    // receiver timeout or two, so every device is opened and has its
+    // serial read at once; the merge below then walks the results in bus
+    // order, as a sequential pass would.
+    struct Probe {
+        std::shared_ptr<UsbDevice> usb;
+        std::shared_ptr<RazerDevice> device;
+        bool opened = false;
+        std::wstring serial;
+        int battery = -1;
+    };
+    std::vector<Probe> probes;
+    for (const auto& device : list) {
+        if (device->GetVendorId() != 0x1532) continue;
+        int productId = device->GetProductId();
+
+        // An instance we already hold open keeps its handle and claimed
+        // interface. A second handle could not claim it, would miss the
+        // report-based serial and re-key the device as PID_xxxx.
+        std::shared_ptr<RazerDevice> candidate;
+        for (auto& d : devices) {
+            if (d->GetPID() == productId && d->IsSameDevice(*device)) {
+                candidate = d;
+                break;
+            }
         }
+        if (!candidate) {
+            candidate = std::make_shared<RazerDevice>(device, productId, backend->GetResponseDelayMs());
+        }
+        probes.push_back(Probe{device, candidate});
+    }
+
+    auto probe = [&](size_t i) {
+        Probe& p = probes[i];
+        p.device->SetDeadline(deadline);
+        p.device->SetDailyTransferBudget(transferBudget);
+        p.opened = p.device->Open();
+        if (p.opened) p.serial = p.device->GetSerial();
+        if (p.opened && queryBattery) p.battery = BatteryOf(*p.device, deadline);
+    };
+    if (pool) {
+        pool->Run(probes.size(), probe);
+    } else {
+        for (size_t i = 0; i < probes.size(); i++) probe(i);
     }
 
     std::map<std::wstring, std::shared_ptr<RazerDevice>> newMap;
 
-    for (ssize_t i = 0; i < cnt; i++) {
-        libusb_device* device = list[i];
-        struct libusb_device_descriptor desc;
-        if (libusb_get_device_descriptor(device, &desc) == 0) {
-            if (desc.idVendor == 0x1532) {
-                // Found Razer Device
-                LOG_INFO("Found Razer Device [PID: 0x" << std::hex << desc.idProduct << std::dec << "]");
-
-                auto candidate = std::make_shared<RazerDevice>(device, desc.idProduct);
-                if (candidate->Open()) {
-                    std::wstring serial = candidate->GetSerial();
-                    std::wstring key = serial;
-                    if (key.empty()) {
-                        std::wstringstream wss;
-                        wss << L"PID_" << std::hex << desc.idProduct;
-                        key = wss.str();
-                    }
-
-                    // Convert wstring to string for logging
-                    std::string keyStr(key.begin(), key.end());
-
-                    // Determine which object to consider (Reuse existing or use new candidate)
-                    std::shared_ptr<RazerDevice> deviceToConsider = candidate;
-                    bool reused = false;
-                    bool physicalChange = false;
-
-                    if (existingMap.count(key)) {
-                        auto existing = existingMap[key];
-                        if (existing->IsSameDevice(device)) {
-                            deviceToConsider = existing;
-                            reused = true;
-                        } else {
-                            physicalChange = true;
-                        }
-                    }
-
-                    // Check for collision in the current enumeration pass (e.g. Wired + Wireless interfaces)
-                    if (newMap.count(key)) {
-                        auto currentInMap = newMap[key];
-
-                        // We must query the new candidate's battery to compare
-                        int battCandidate = deviceToConsider->GetBatteryLevel();
-                        int battCurrent = currentInMap->GetLastBatteryLevel();
-
-                        if (battCurrent == -1 && battCandidate != -1) {
-                            newMap[key] = deviceToConsider;
-                            LOG_INFO("  Replaced collision for " << keyStr << " (Better battery source found)");
-                            LOG_INFO("  Battery: " << battCandidate << "%");
-                        } else {
-                            LOG_INFO("  Ignored collision for " << keyStr << " (Existing source preferred)");
-                            if (battCandidate != -1) {
-                                LOG_INFO("  (Ignored device had Battery: " << battCandidate << "%)");
-                            } else {
-                                LOG_ERROR("  (Ignored device battery query failed)");
-                            }
-                        }
-                    } else {
-                        // No collision, add to map
-                        newMap[key] = deviceToConsider;
-
-                        if (reused) {
-                            LOG_INFO("  Kept existing instance for " << keyStr);
-                        } else if (physicalChange) {
-                            LOG_INFO("  Replaced instance for " << keyStr << " (Physical connection changed)");
-                        } else {
-                            LOG_INFO("  Added new instance for " << keyStr);
-                        }
-
-                        // Query battery
-                        int batt = deviceToConsider->GetBatteryLevel();
-                        if (batt != -1) {
-                             LOG_INFO("  Battery: " << batt << "%");
-                        } else {
-                             LOG_ERROR("  Battery query failed.");
-                        }
-                    }
+    for (const auto& p : probes) {
+        int productId = p.device->GetPID();
+        // Found Razer Device
+        LOG_INFO("Found Razer Device [PID: 0x" << std::hex << productId << std::dec << "]");
+        if (!p.opened) {
+            LOG_ERROR("  Failed to open device.");
+            continue;
+        }
+        std::wstring key = MakeDeviceKey(p.serial, productId);
+
+        // Convert wstring to string for logging
+        std::string keyStr(key.begin(), key.end());
+
+        // Determine which object to consider (Reuse existing or use new candidate)
+        std::shared_ptr<RazerDevice> deviceToConsider = p.device;
+        bool reused = false;
+        bool physicalChange = false;
+
+        if (existingMap.count(key)) {
+            auto existing = existingMap[key];
+            if (existing->IsSameDevice(*p.usb)) {
+                deviceToConsider = existing;
+                reused = true;
+            } else {
+                physicalChange = true;
+            }
+        }
+
+        // Check for collision in the current enumeration pass (e.g. Wired + Wireless interfaces)
+        if (newMap.count(key)) {
+            auto currentInMap = newMap[key];
+
+            // We must query the new candidate's battery to compare
+            int battCandidate = queryBattery && deviceToConsider == p.device
+                ? p.battery : BatteryOf(*deviceToConsider, deadline);
+            int battCurrent = currentInMap->GetLastBatteryLevel();
+
+            if (battCurrent == -1 && battCandidate != -1) {
+                newMap[key] = deviceToConsider;
+                LOG_INFO("  Replaced collision for " << keyStr << " (Better battery source found)");
+                LOG_INFO("  Battery: " << battCandidate << "%");
+            } else {
+                LOG_INFO("  Ignored collision for " << keyStr << " (Existing source preferred)");
+                if (battCandidate != -1) {
+                    LOG_INFO("  (Ignored device had Battery: " << battCandidate << "%)");
+                } else {
+                    LOG_ERROR("  (Ignored device battery query failed)");
+                }
+            }
+        } else {
+            // No collision, add to map
+            newMap[key] = deviceToConsider;
+
+            if (reused) {
+                LOG_INFO("  Kept existing instance for " << keyStr);
+            } else if (physicalChange) {
+                LOG_INFO("  Replaced instance for " << keyStr << " (Physical connection changed)");
+            } else {
+                LOG_INFO("  Added new instance for " << keyStr);
+            }
+
+            // Battery queried by the probe
+            if (queryBattery) {
+                int batt = deviceToConsider == p.device ? p.battery : BatteryOf(*deviceToConsider, deadline);
+                if (batt != -1) {
+                     LOG_INFO("  Battery: " << batt << "%");
                 } else {
-                    LOG_ERROR("  Failed to open device.");
+                     LOG_ERROR("  Battery query failed.");
                 }
             }
         }
     }
 
-    libusb_free_device_list(list, 1); // Unref devices in list
-
     devices.clear();
     for (auto& pair : newMap) {
         devices.push_back(pair.second);
@@ -0,0 +1,71 @@
+#include "SharedStatus.h"
+#include <cstring>
+#include <thread>
+
+std::string DefaultSharedStatusName() {
+#ifdef _WIN32
+    return "Global\\RazerBatteryStatus";
+#else
+    return "/razerbattery-status";
+#endif
+}
+
+bool SharedStatusReader::Open(const std::string& name) {
+    Close();
+    bool opened = file.OpenSharedReadOnly(name);
+#ifdef _WIN32
+    if (!opened && name == DefaultSharedStatusName()) opened = file.OpenSharedReadOnly(RAZER_SHARED_STATUS_LOCAL_NAME);
+#endif
+    if (!opened) return false;
+    if (file.Size() < sizeof(SharedStatusSegment)) {
+        file.Close();
+        return false;
+    }
+
+    auto* mapped = reinterpret_cast<const SharedStatusSegment*>(file.Data());
+    if (mapped->magic != RAZER_SHARED_STATUS_MAGIC || mapped->layout != RAZER_SHARED_STATUS_LAYOUT ||
+        mapped->recordSize != sizeof(SharedDeviceRecord) ||
+        mapped->maxDevices != SharedStatusSnapshot::MaxDevices) {
+        file.Close();
+        return false;
+    }
+    segment = mapped;
+    return true;
+}
+
+uint64_t SharedStatusReader::GetSequence() const {
+    return segment ? segment->sequence.load(std::memory_order_acquire) & ~1ull : 0;
+}
+
+bool SharedStatusReader::Read(SharedStatusSnapshot& out, int maxAttempts) const {
+    if (!segment) return false;
+
+    uint64_t words[SharedStatusSegment::PayloadWords];
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        uint64_t before = segment->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // Updates take well under a microsecond; back off only if stuck
+            if (attempt >= 8) std::this_thread::yield();
+            continue;
+        }
+
+        for (size_t i = 0; i < SharedStatusSegment::HeaderWords; i++) {
+            words[i] = segment->payload[i].load(std::memory_order_relaxed);
+        }
+        uint32_t count;
+        memcpy(&count, reinterpret_cast<const char*>(words) + offsetof(SharedStatusSnapshot, count), sizeof(count));
+        if (count > SharedStatusSnapshot::MaxDevices) count = SharedStatusSnapshot::MaxDevices;
+        size_t end = SharedStatusSegment::HeaderWords + count * SharedStatusSegment::RecordWords;
+        for (size_t i = SharedStatusSegment::HeaderWords; i < end; i++) {
+            words[i] = segment->payload[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence.load(std::memory_order_relaxed) == before) {
+            memcpy(&out, words, end * sizeof(uint64_t));
+            out.count = count;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,98 @@
+#include "SharedStatusWriter.h"
+#include "EventLog.h"
+#include "Logger.h"
+#include <cstring>
+
+SharedStatusWriter::~SharedStatusWriter() {
+    Close();
+}
+
+bool SharedStatusWriter::Create(const std::string& segmentName, LocalAccess access) {
+    Close();
+    name = segmentName;
+    if (!file.CreateShared(name, sizeof(SharedStatusSegment), access)) {
+        LOG_ERROR("Failed to create shared status segment " << name);
+        return false;
+    }
+
+    // The segment may be left over from a crashed writer; start a new
+    // sequence only after the header is valid again.
+    segment = reinterpret_cast<SharedStatusSegment*>(file.Data());
+    segment->sequence.store(0, std::memory_order_relaxed);
+    for (auto& word : segment->payload) word.store(0, std::memory_order_relaxed);
+    segment->layout = RAZER_SHARED_STATUS_LAYOUT;
+    segment->recordSize = sizeof(SharedDeviceRecord);
+    segment->maxDevices = SharedStatusSnapshot::MaxDevices;
+    segment->reserved = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = RAZER_SHARED_STATUS_MAGIC;
+
+    LOG_INFO("Shared status segment: " << name);
+    return true;
+}
+
+void SharedStatusWriter::Close() {
+    if (!segment) return;
+
+    SharedStatusSnapshot snapshot = {};
+    snapshot.publishedUs = EventLog::NowUs();
+    snapshot.flags = SharedStatusSnapshot::WriterStopped;
+    Write(snapshot);
+
+    segment = nullptr;
+    file.Close();
+    MappedFile::RemoveShared(name);
+}
+
+static void CopyField(char* dst, size_t capacity, const std::string& src) {
+    size_t n = src.size() < capacity - 1 ? src.size() : capacity - 1;
+    memset(dst, 0, capacity);
+    memcpy(dst, src.data(), n);
+}
+
+static SharedStatusError ErrorCode(const std::string& error) {
+    if (error.empty()) return SharedStatusError::None;
+    if (error == "timeout") return SharedStatusError::Timeout;
+    if (error == "unavailable") return SharedStatusError::Unavailable;
+    if (error == "asleep") return SharedStatusError::Asleep;
+    if (error == "over_budget") return SharedStatusError::OverBudget;
+    return SharedStatusError::QueryFailed;
+}
+
+void SharedStatusWriter::Publish(const std::vector<DeviceStatus>& statuses, uint64_t version) {
+    if (!segment) return;
+
+    SharedStatusSnapshot snapshot = {};
+    snapshot.version = version;
+    snapshot.publishedUs = EventLog::NowUs();
+    for (const auto& status : statuses) {
+        if (snapshot.count == SharedStatusSnapshot::MaxDevices) break;
+        SharedDeviceRecord& record = snapshot.devices[snapshot.count++];
+        CopyField(record.serial, sizeof(record.serial), status.serial);
+        CopyField(record.name, sizeof(record.name), status.name);
+        record.pid = static_cast<uint16_t>(status.pid);
+        record.type = static_cast<uint8_t>(status.type);
+        record.charging = status.charging ? 1 : 0;
+        record.level = static_cast<int8_t>(status.level);
+        record.error = static_cast<uint8_t>(ErrorCode(status.error));
+        record.latencyMs = status.latencyMs;
+        record.secondsToEmpty = status.secondsToEmpty;
+        record.secondsToFull = status.secondsToFull;
+    }
+    Write(snapshot);
+}
+
+void SharedStatusWriter::Write(const SharedStatusSnapshot& snapshot) {
+    uint64_t words[SharedStatusSegment::PayloadWords];
+    memcpy(words, &snapshot, sizeof(snapshot));
+    size_t end = SharedStatusSegment::HeaderWords + snapshot.count * SharedStatusSegment::RecordWords;
+
+    // Seqlock write: odd sequence, payload, even sequence
+    uint64_t sequence = segment->sequence.load(std::memory_order_relaxed);
+    segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < end; i++) {
+        segment->payload[i].store(words[i], std::memory_order_relaxed);
+    }
+    segment->sequence.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,138 @@
+#include "Trace.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::enabled{false};
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    uint64_t startUs;
+    uint64_t durationUs;
+    TraceArg args[Trace::MaxArgs];
+    uint8_t argCount;
+};
+
+// One per thread; kept alive by the registry so spans survive thread exit.
+struct ThreadBuffer {
+    std::mutex mutex; // only contended while exporting
+    std::vector<TraceEvent> events;
+    size_t next = 0;
+    bool wrapped = false;
+    uint32_t threadIndex = 0;
+};
+
+std::mutex g_registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+
+ThreadBuffer& LocalBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto b = std::make_shared<ThreadBuffer>();
+        b->events.resize(Trace::EventsPerThread);
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        b->threadIndex = static_cast<uint32_t>(g_buffers.size() + 1);
+        g_buffers.push_back(b);
+        return b;
+    }();
+    return *buffer;
+}
+
+void WriteEscaped(FILE* f, const char* s) {
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        fputc(*s, f);
+    }
+}
+
+} // namespace
+
+void Trace::SetEnabled(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+    LOG_INFO("Tracing " << (on ? "enabled" : "disabled"));
+}
+
+uint64_t Trace::NowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Trace::Complete(const char* name, uint64_t startUs, uint64_t endUs, const TraceArg* args, size_t argCount) {
+    if (!IsEnabled()) return;
+
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceEvent& e = buffer.events[buffer.next];
+    e.name = name;
+    e.startUs = startUs;
+    e.durationUs = endUs >= startUs ? endUs - startUs : 0;
+    e.argCount = static_cast<uint8_t>(argCount < MaxArgs ? argCount : MaxArgs);
+    for (size_t i = 0; i < e.argCount; i++) e.args[i] = args[i];
+
+    if (++buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+void Trace::Clear() {
+    std::lock_guard<std::mutex> registryLock(g_registryMutex);
+    for (auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+}
+
+bool Trace::ExportChromeJson(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        LOG_ERROR("Trace export failed to open " << path);
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    bool first = true;
+    size_t total = 0;
+
+    std::lock_guard<std::mutex> registryLock(g_registryMutex);
+    for (auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                first ? "" : ",\n", buffer->threadIndex, buffer->threadIndex);
+        first = false;
+
+        // Oldest first: [next, end) then [0, next) once the ring has wrapped
+        size_t count = buffer->wrapped ? buffer->events.size() : buffer->next;
+        size_t begin = buffer->wrapped ? buffer->next : 0;
+        for (size_t n = 0; n < count; n++) {
+            const TraceEvent& e = buffer->events[(begin + n) % buffer->events.size()];
+            fputs(",\n{\"name\":\"", f);
+            WriteEscaped(f, e.name);
+            fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu",
+                    buffer->threadIndex, static_cast<unsigned long long>(e.startUs),
+                    static_cast<unsigned long long>(e.durationUs));
+            if (e.argCount > 0) {
+                fputs(",\"args\":{", f);
+                for (uint8_t a = 0; a < e.argCount; a++) {
+                    fprintf(f, "%s\"", a ? "," : "");
+                    WriteEscaped(f, e.args[a].name);
+                    fprintf(f, "\":%lld", static_cast<long long>(e.args[a].value));
+                }
+                fputc('}', f);
+            }
+            fputc('}', f);
+            total++;
+        }
+    }
+
+    fputs("\n]}\n", f);
+    bool ok = fclose(f) == 0;
+    LOG_INFO("Exported " << total << " trace spans to " << path);
+    return ok;
+}
@@ -0,0 +1,97 @@
+#include "TrayClient.h"
+#include "Logger.h"
+#include <chrono>
+
+TrayClient::TrayClient(Callback callback, std::string endpoint)
+    : callback(std::move(callback)), endpoint(std::move(endpoint)) {
+}
+
+TrayClient::~TrayClient() {
+    Stop();
+}
+
+void TrayClient::Start() {
+    if (thread.joinable()) return;
+    stopping = false;
+    thread = std::thread(&TrayClient::Run, this);
+}
+
+void TrayClient::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thread.joinable()) return;
+        stopping = true;
+        if (active) active->Interrupt();
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+bool TrayClient::RequestRefresh() {
+    // Separate short-lived connection: the subscription stays read-only
+    auto channel = IpcChannel::Connect(endpoint);
+    std::string reply;
+    if (!channel || !channel->WriteLine("refresh") || !channel->ReadLine(reply)) return false;
+    return reply.find("\"accepted\":true") != std::string::npos;
+}
+
+void TrayClient::Run() {
+    const auto MinBackoff = std::chrono::milliseconds(250);
+    const auto MaxBackoff = std::chrono::seconds(10);
+    auto backoff = MinBackoff;
+    bool reportedDown = false;
+
+    for (;;) {
+        std::unique_ptr<IpcChannel> channel = IpcChannel::Connect(endpoint);
+        if (channel && channel->WriteLine("subscribe")) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) return;
+                active = channel.get();
+            }
+            LOG_INFO("Connected to poller at " << endpoint);
+            backoff = MinBackoff;
+            reportedDown = false;
+
+            std::string line, type;
+            uint64_t version = 0, lastVersion = 0;
+            bool first = true;
+            std::vector<DeviceStatus> devices;
+            while (channel->ReadLine(line)) {
+                if (!ParseStatusMessage(line, type, version, devices)) {
+                    LOG_ERROR("Malformed message from poller");
+                    continue;
+                }
+                if (type == "alert") {
+                    if (alertCallback && !devices.empty()) alertCallback(devices[0]);
+                    continue;
+                }
+                if (type != "snapshot" && type != "changed") continue;
+                // "changed" may repeat the version the snapshot already had
+                if (!first && version <= lastVersion) continue;
+                first = false;
+                lastVersion = version;
+                auto snapshot = std::make_shared<DeviceSnapshot>();
+                snapshot->version = version;
+                snapshot->devices = std::move(devices);
+                latest.Store(snapshot);
+                callback(snapshot->devices, true);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            active = nullptr;
+            if (stopping) return;
+        }
+
+        if (!reportedDown) {
+            LOG_INFO("Poller not reachable at " << endpoint << ", retrying");
+            latest.Store(std::make_shared<const DeviceSnapshot>());
+            callback({}, false);
+            reportedDown = true;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (cv.wait_for(lock, backoff, [this] { return stopping; })) return;
+        backoff = std::min<std::chrono::milliseconds>(backoff * 2, MaxBackoff);
+    }
+}
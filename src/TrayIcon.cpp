@@ -2,9 +2,24 @@
 #include <tchar.h>
 #include <strsafe.h>
 #include "Logger.h"
+#include "Trace.h"
 
 #define WM_TRAYICON (WM_USER + 1)
 
+static WCHAR TypeLetter(RazerDeviceType type) {
+    if (type == RazerDeviceType::Mouse) return L'M';
+    if (type == RazerDeviceType::Headset) return L'H';
+    if (type == RazerDeviceType::Keyboard) return L'K';
+    return L'?';
+}
+
+static std::wstring TypeName(RazerDeviceType type) {
+    if (type == RazerDeviceType::Mouse) return L"Mouse";
+    if (type == RazerDeviceType::Headset) return L"Headset";
+    if (type == RazerDeviceType::Keyboard) return L"Keyboard";
+    return L"Device";
+}
+
 TrayIcon::TrayIcon(HWND hwnd, UINT id) : hwnd(hwnd), id(id) {
     memset(&nid, 0, sizeof(nid));
     nid.cbSize = sizeof(nid);
@@ -37,19 +52,43 @@ void TrayIcon::UpdatePlaceholder() {
     DestroyIcon(hIcon);
 }
 
-void TrayIcon::Update(int batteryLevel, bool charging, RazerDeviceType type) {
-    HICON hIcon = CreateBatteryIcon(batteryLevel, charging, type);
+void TrayIcon::UpdateUnavailable(RazerDeviceType type) {
+    HICON hIcon = CreateUnavailableIcon(type);
     nid.hIcon = hIcon;
+    std::wstring tip = TypeName(type) + L": not responding";
+    StringCchCopy(nid.szTip, ARRAYSIZE(nid.szTip), tip.c_str());
 
-    std::wstring typeStr = L"Device";
-    if (type == RazerDeviceType::Mouse) typeStr = L"Mouse";
-    if (type == RazerDeviceType::Headset) typeStr = L"Headset";
-    if (type == RazerDeviceType::Keyboard) typeStr = L"Keyboard";
+    if (!Shell_NotifyIcon(NIM_MODIFY, &nid)) {
+        if (!Shell_NotifyIcon(NIM_ADD, &nid)) {
+             LOG_ERROR("Shell_NotifyIcon failed for ID " << id << ": " << GetLastError());
+        }
+    }
 
+    DestroyIcon(hIcon);
+}
+
+void TrayIcon::Update(int batteryLevel, bool charging, RazerDeviceType type, const std::string& estimate) {
+    HICON hIcon;
+    {
+        TRACE_SCOPE("RenderIcon");
+        hIcon = CreateBatteryIcon(batteryLevel, charging, type);
+    }
+    nid.hIcon = hIcon;
+
+    std::wstring typeStr = TypeName(type);
+
+    // "Mouse: 42% (~3 h 10 min left)", "Mouse: 60% (Charging, ~45 min to full)"
+    std::wstring detail = charging ? L"Charging" : L"";
+    if (!estimate.empty()) {
+        if (!detail.empty()) detail += L", ";
+        detail += std::wstring(estimate.begin(), estimate.end()); // ASCII
+    }
     WCHAR buf[128];
-    StringCchPrintf(buf, 128, L"%s: %d%% %s", typeStr.c_str(), batteryLevel, charging ? L"(Charging)" : L"");
+    if (detail.empty()) StringCchPrintf(buf, 128, L"%s: %d%%", typeStr.c_str(), batteryLevel);
+    else StringCchPrintf(buf, 128, L"%s: %d%% (%s)", typeStr.c_str(), batteryLevel, detail.c_str());
     StringCchCopy(nid.szTip, ARRAYSIZE(nid.szTip), buf);
 
+    TRACE_SCOPE("Shell_NotifyIcon");
     if (!Shell_NotifyIcon(NIM_MODIFY, &nid)) {
         if (!Shell_NotifyIcon(NIM_ADD, &nid)) {
              LOG_ERROR("Shell_NotifyIcon failed for ID " << id << ": " << GetLastError());
@@ -59,6 +98,17 @@ void TrayIcon::Update(int batteryLevel, bool charging, RazerDeviceType type) {
     DestroyIcon(hIcon);
 }
 
+void TrayIcon::ShowNotification(const std::wstring& title, const std::wstring& text) {
+    NOTIFYICONDATA info = nid;
+    info.uFlags = NIF_INFO;
+    info.dwInfoFlags = NIIF_WARNING;
+    StringCchCopy(info.szInfoTitle, ARRAYSIZE(info.szInfoTitle), title.c_str());
+    StringCchCopy(info.szInfo, ARRAYSIZE(info.szInfo), text.c_str());
+    if (!Shell_NotifyIcon(NIM_MODIFY, &info)) {
+        LOG_ERROR("Shell_NotifyIcon(NIF_INFO) failed for ID " << id << ": " << GetLastError());
+    }
+}
+
 HICON TrayIcon::CreatePlaceholderIcon() {
     int w = GetSystemMetrics(SM_CXSMICON);
     int h = GetSystemMetrics(SM_CYSMICON);
@@ -118,10 +168,7 @@ HICON TrayIcon::CreateBatteryIcon(int level, bool charging, RazerDeviceType type
     SetBkMode(hdcMem, TRANSPARENT);
 
     // Type Letter
-    WCHAR typeChar = L'?';
-    if (type == RazerDeviceType::Mouse) typeChar = L'M';
-    if (type == RazerDeviceType::Headset) typeChar = L'H';
-    if (type == RazerDeviceType::Keyboard) typeChar = L'K';
+    WCHAR typeChar = TypeLetter(type);
 
     HFONT hFontType = CreateFont(-8, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH, L"Arial");
     HFONT hOldFont = (HFONT)SelectObject(hdcMem, hFontType);
@@ -164,3 +211,53 @@ HICON TrayIcon::CreateBatteryIcon(int level, bool charging, RazerDeviceType type
 
     return hIcon;
 }
+
+HICON TrayIcon::CreateUnavailableIcon(RazerDeviceType type) {
+    int w = GetSystemMetrics(SM_CXSMICON);
+    int h = GetSystemMetrics(SM_CYSMICON);
+
+    HDC hdcScreen = GetDC(NULL);
+    HDC hdcMem = CreateCompatibleDC(hdcScreen);
+    HBITMAP hBitmap = CreateCompatibleBitmap(hdcScreen, w, h);
+    HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdcMem, hBitmap);
+
+    // Same gray as the placeholder
+    RECT rect = {0, 0, w, h};
+    HBRUSH brush = CreateSolidBrush(RGB(50, 50, 50));
+    FillRect(hdcMem, &rect, brush);
+    DeleteObject(brush);
+
+    SetBkMode(hdcMem, TRANSPARENT);
+    SetTextColor(hdcMem, RGB(200, 200, 200));
+
+    // Type Letter
+    HFONT hFontType = CreateFont(-8, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH, L"Arial");
+    HFONT hOldFont = (HFONT)SelectObject(hdcMem, hFontType);
+    RECT rectTop = {0, 0, w, h/2};
+    WCHAR sType[2] = {TypeLetter(type), 0};
+    DrawText(hdcMem, sType, -1, &rectTop, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+
+    // No level to show
+    HFONT hFontLevel = CreateFont(-9, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH, L"Arial");
+    SelectObject(hdcMem, hFontLevel);
+    RECT rectBot = {0, h/2, w, h};
+    DrawText(hdcMem, L"--", -1, &rectBot, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+
+    SelectObject(hdcMem, hOldFont);
+    DeleteObject(hFontType);
+    DeleteObject(hFontLevel);
+
+    // Create Icon
+    ICONINFO ii = {0};
+    ii.fIcon = TRUE;
+    ii.hbmMask = hBitmap;
+    ii.hbmColor = hBitmap;
+    HICON hIcon = CreateIconIndirect(&ii);
+
+    SelectObject(hdcMem, hOldBitmap);
+    DeleteObject(hBitmap);
+    DeleteDC(hdcMem);
+    ReleaseDC(NULL, hdcScreen);
+
+    return hIcon;
+}
@@ -0,0 +1,102 @@
+#include "WorkPool.h"
+
+WorkPool::WorkPool(size_t concurrency) {
+    if (concurrency == 0) concurrency = 1;
+    for (size_t i = 0; i < concurrency; i++) queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 1; i < concurrency; i++) workers.emplace_back(&WorkPool::WorkerLoop, this, i);
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+uint64_t WorkPool::GetSteals() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return steals;
+}
+
+void WorkPool::Run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) return;
+    if (count == 1 || workers.empty()) {
+        for (size_t i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+    for (size_t i = 0; i < count; i++) {
+        Queue& queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.items.push_back(i);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        remaining = count;
+        generation++;
+    }
+    wake.notify_all();
+
+    Work(0, task);
+
+    // A worker that woke late may still be between Take and giving up;
+    // `task` must outlive it
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return remaining == 0 && active == 0; });
+    current = nullptr;
+}
+
+void WorkPool::WorkerLoop(size_t self) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        // Null when this wake-up's batch has already finished
+        const std::function<void(size_t)>* task = current;
+        if (!task) continue;
+        active++;
+        lock.unlock();
+        Work(self, *task);
+        lock.lock();
+        if (--active == 0 && remaining == 0) done.notify_all();
+    }
+}
+
+void WorkPool::Work(size_t self, const std::function<void(size_t)>& task) {
+    size_t index;
+    while (Take(self, index)) {
+        task(index);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--remaining == 0 && active == 0) done.notify_all();
+    }
+}
+
+bool WorkPool::Take(size_t self, size_t& index) {
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            index = own.items.back();
+            own.items.pop_back();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < queues.size(); k++) {
+        Queue& victim = *queues[(self + k) % queues.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex);
+        if (victim.items.empty()) continue;
+        index = victim.items.front();
+        victim.items.pop_front();
+        lock.unlock();
+        std::lock_guard<std::mutex> statsLock(mutex);
+        steals++;
+        return true;
+    }
+    return false;
+}
@@ -5,24 +5,39 @@
 #include <setupapi.h>
 #include <hidsdi.h>
 #include "SingleInstance.h"
+#include "BatteryEstimator.h"
 #include "Logger.h"
-#include "RazerManager.h"
+#include "Trace.h"
+#include "TrayClient.h"
 #include "TrayIcon.h"
+#include <mutex>
 
 #define WM_TRAYICON (WM_USER + 1)
-#define ID_TIMER_UPDATE 1
-#define UPDATE_INTERVAL_MS 300000 // 5 minutes
+#define WM_STATUS_CHANGED (WM_APP + 1)
+#define WM_BATTERY_ALERT (WM_APP + 2)
 
 // Globals
-RazerManager g_Manager;
+// The tray only renders; RazerBatteryPoller owns the devices and publishes
+// their status to every session.
+// Device tables are read from the client's published snapshot, without a
+// lock or a copy per update.
+std::unique_ptr<TrayClient> g_Client;
+std::mutex g_AlertMutex;
+std::vector<DeviceStatus> g_Alerts; // raised by the poller, shown on the UI thread
 std::vector<std::unique_ptr<TrayIcon>> g_Icons;
 std::unique_ptr<TrayIcon> g_PlaceholderIcon;
 HWND g_hWnd = NULL;
 
+#define ID_MENU_EXIT 1001
+#define ID_MENU_TRACE_START 1002
+#define ID_MENU_TRACE_EXPORT 1003
+
 void UpdateUI(HWND hwnd) {
+    TRACE_SCOPE("UpdateUI");
     LOG_INFO("UpdateUI called. Window Handle: " << hwnd);
-    auto devices = g_Manager.GetDevices();
-    LOG_INFO("Device count: " << devices.size());
+    DeviceSnapshotPtr snapshot = g_Client ? g_Client->GetSnapshot() : std::make_shared<const DeviceSnapshot>();
+    const std::vector<DeviceStatus>& devices = snapshot->devices;
+    LOG_INFO("Device count: " << devices.size() << " (version " << snapshot->version << ")");
 
     if (devices.empty()) {
         g_Icons.clear();
@@ -47,25 +62,64 @@ void UpdateUI(HWND hwnd) {
         }
 
         for (size_t i = 0; i < devices.size(); i++) {
-            auto& dev = devices[i];
-            int level = dev->GetBatteryLevel();
-            bool charging = dev->IsCharging();
+            const DeviceStatus& status = devices[i];
+            if (status.error == "unavailable") {
+                g_Icons[i]->UpdateUnavailable(status.type);
+                continue;
+            }
+            int level = status.level;
 
             if (level == -1) level = 0;
 
-            // LOG_DEBUG("Updating device " << i << ": " << level << "%");
-            g_Icons[i]->Update(level, charging, dev->GetType());
+            g_Icons[i]->Update(level, status.charging, status.type, FormatEstimate(status));
         }
     }
 }
 
+// One toast per alert, on the icon of the device it is about. The poller
+// already applies hysteresis and rate limiting.
+void ShowAlerts() {
+    std::vector<DeviceStatus> alerts;
+    {
+        std::lock_guard<std::mutex> lock(g_AlertMutex);
+        alerts.swap(g_Alerts);
+    }
+    if (!g_Client) return;
+    DeviceSnapshotPtr snapshot = g_Client->GetSnapshot();
+    const std::vector<DeviceStatus>& devices = snapshot->devices;
+    for (const auto& alert : alerts) {
+        size_t index = 0;
+        while (index < devices.size() && devices[index].serial != alert.serial) index++;
+        TrayIcon* icon = index < g_Icons.size() ? g_Icons[index].get() : nullptr;
+        if (!icon) continue;
+
+        std::wstring name(alert.name.begin(), alert.name.end());
+        std::wstring text = L"Battery at " + std::to_wstring(alert.level) + L"%";
+        std::string estimate = FormatEstimate(alert);
+        if (!estimate.empty()) text += L" (" + std::wstring(estimate.begin(), estimate.end()) + L")";
+        text += L". Connect the charger soon.";
+        icon->ShowNotification(name.empty() ? L"Razer battery low" : name, text);
+    }
+}
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_CREATE:
         LOG_INFO("WM_CREATE received. HWND: " << hwnd);
-        g_Manager.EnumerateDevices();
-        UpdateUI(hwnd); // Pass valid HWND
-        SetTimer(hwnd, ID_TIMER_UPDATE, UPDATE_INTERVAL_MS, NULL);
+        UpdateUI(hwnd); // Placeholder until the poller answers
+        // Updates arrive on the client's thread; render them on this one
+        g_Client = std::make_unique<TrayClient>([hwnd](const std::vector<DeviceStatus>&, bool connected) {
+            if (!connected) LOG_ERROR("RazerBatteryPoller is not running.");
+            PostMessage(hwnd, WM_STATUS_CHANGED, 0, 0);
+        });
+        g_Client->SetAlertCallback([hwnd](const DeviceStatus& device) {
+            {
+                std::lock_guard<std::mutex> lock(g_AlertMutex);
+                g_Alerts.push_back(device);
+            }
+            PostMessage(hwnd, WM_BATTERY_ALERT, 0, 0);
+        });
+        g_Client->Start();
 
         // Register for device notifications
         {
@@ -85,17 +139,19 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         }
         break;
 
-    case WM_TIMER:
-        if (wParam == ID_TIMER_UPDATE) {
-            UpdateUI(hwnd);
-        }
+    case WM_STATUS_CHANGED:
+        UpdateUI(hwnd);
+        break;
+
+    case WM_BATTERY_ALERT:
+        ShowAlerts();
         break;
 
     case WM_DEVICECHANGE:
         LOG_INFO("WM_DEVICECHANGE received.");
-        Sleep(100); // Small delay
-        g_Manager.EnumerateDevices();
-        UpdateUI(hwnd);
+        // The poller sees the same notification when it runs as a service;
+        // this covers a poller started by hand. Requests are merged there.
+        if (g_Client) g_Client->RequestRefresh();
         break;
 
     case WM_TRAYICON:
@@ -104,11 +160,23 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             POINT pt;
             GetCursorPos(&pt);
             HMENU hMenu = CreatePopupMenu();
-            AppendMenu(hMenu, MF_STRING, 1001, L"Exit");
+            if (Trace::IsEnabled()) {
+                AppendMenu(hMenu, MF_STRING, ID_MENU_TRACE_EXPORT, L"Stop Tracing && Export");
+            } else {
+                AppendMenu(hMenu, MF_STRING, ID_MENU_TRACE_START, L"Start Tracing");
+            }
+            AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
+            AppendMenu(hMenu, MF_STRING, ID_MENU_EXIT, L"Exit");
             SetForegroundWindow(hwnd);
             int cmd = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_NONOTIFY, pt.x, pt.y, 0, hwnd, NULL);
-            if (cmd == 1001) {
+            if (cmd == ID_MENU_EXIT) {
                 DestroyWindow(hwnd);
+            } else if (cmd == ID_MENU_TRACE_START) {
+                Trace::Clear();
+                Trace::SetEnabled(true);
+            } else if (cmd == ID_MENU_TRACE_EXPORT) {
+                Trace::SetEnabled(false);
+                Trace::ExportChromeJson(Logger::Instance().GetDirectory() + "/RazerBatteryTrace.json");
             }
             DestroyMenu(hMenu);
         }
@@ -116,6 +184,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
     case WM_DESTROY:
         LOG_INFO("WM_DESTROY. Exiting.");
+        g_Client.reset();
         PostQuitMessage(0);
         break;
 
@@ -126,14 +195,18 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 }
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd) {
-    // Single Instance Check
-    SingleInstance instance("Global\\RazerBatteryTray_Instance_Mutex");
+    // Single Instance Check (one tray per session; the poller is shared)
+    SingleInstance instance("Local\\RazerBatteryTray_Instance_Mutex");
     if (instance.IsAnotherInstanceRunning()) {
         MessageBox(NULL, L"Razer Battery Tray is already running.", L"Error", MB_OK | MB_ICONERROR);
         return 0;
     }
 
     LOG_INFO("Application starting...");
+    // RAZER_TRACE=1 traces from startup; export via the tray menu
+    if (const char* trace = getenv("RAZER_TRACE")) {
+        if (trace[0] == '1') Trace::SetEnabled(true);
+    }
 
     // Window Class
     WNDCLASSEX wc = {0};
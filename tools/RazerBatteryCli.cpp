@@ -0,0 +1,133 @@
+// RazerBatteryCli [--deadline-ms N]
+//
+// Enumerates attached Razer devices once, queries them all in parallel and
+// prints one JSON object on stdout:
+//   {"complete":true,"elapsed_ms":212,"devices":[{"serial":...,"level":87,...}]}
+// Whatever is known when the deadline expires is printed; devices still
+// being queried are reported with "error":"timeout".
+//
+// Exit codes: 0 complete, 1 USB unavailable, 2 deadline hit (partial output).
+#include "RazerManager.h"
+#include "LibusbBackend.h"
+#include "DeviceStatus.h"
+#include "DeviceKey.h"
+#include "Logger.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Shared with the worker threads, which may outlive main() on timeout.
+struct QueryState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool enumerated = false;
+    size_t pending = 0;
+    std::vector<DeviceStatus> results;
+};
+
+std::string Narrow(const std::wstring& s) {
+    return std::string(s.begin(), s.end());
+}
+
+void QueryAll(std::shared_ptr<RazerManager> manager, std::shared_ptr<QueryState> state) {
+    // Battery is read below, in parallel, rather than device by device
+    manager->EnumerateDevices(false);
+    const auto& devices = manager->GetDevices();
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        for (const auto& d : devices) {
+            DeviceStatus status;
+            status.serial = Narrow(MakeDeviceKey(d->GetSerial(), d->GetPID()));
+            status.pid = d->GetPID();
+            status.type = d->GetType();
+            status.name = Narrow(d->GetName());
+            status.error = "timeout";
+            state->results.push_back(status);
+        }
+        state->pending = devices.size();
+        state->enumerated = true;
+    }
+    state->cv.notify_all();
+
+    std::vector<std::thread> queries;
+    for (size_t i = 0; i < devices.size(); i++) {
+        queries.emplace_back([device = devices[i], state, i]() {
+            DeviceStatus status = device->QueryStatus();
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->results[i] = std::move(status);
+            if (--state->pending == 0) state->cv.notify_all();
+        });
+    }
+    for (auto& t : queries) t.join();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto start = Clock::now();
+    long deadlineMs = 900;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--deadline-ms") == 0 && i + 1 < argc) {
+            deadlineMs = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: RazerBatteryCli [--deadline-ms N]\n");
+            return 1;
+        }
+    }
+    if (deadlineMs <= 0) deadlineMs = 900;
+    const auto deadline = start + std::chrono::milliseconds(deadlineMs);
+
+    // Scripts should not leave RazerBatteryTray.log in their working
+    // directory; RAZER_LOG_LEVEL still turns logging on explicitly.
+    if (!getenv("RAZER_LOG_LEVEL")) Logger::SetLevel(LogLevel::Off);
+
+    auto backend = std::make_shared<LibusbBackend>();
+    if (!backend->IsAvailable()) {
+        fprintf(stderr, "libusb initialization failed\n");
+        return 1;
+    }
+
+    auto manager = std::make_shared<RazerManager>(backend);
+    auto state = std::make_shared<QueryState>();
+    std::thread worker(QueryAll, manager, state);
+
+    bool complete;
+    std::vector<DeviceStatus> results;
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        complete = state->cv.wait_until(lock, deadline, [&] { return state->enumerated && state->pending == 0; });
+        results = state->results;
+    }
+
+    std::string out = "{\"complete\":";
+    out += complete ? "true" : "false";
+    out += ",\"elapsed_ms\":";
+    out += std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+    out += ",\"devices\":";
+    AppendJson(out, results);
+    out += "}\n";
+    fputs(out.c_str(), stdout);
+    fflush(stdout);
+
+    if (!complete) {
+        // Blocked transfers cannot be cancelled from here and would keep
+        // the process alive until their own timeouts; leave without
+        // unwinding the manager they are still using.
+        std::_Exit(2);
+    }
+    worker.join();
+    return 0;
+}
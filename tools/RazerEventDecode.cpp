@@ -0,0 +1,103 @@
+// Converts a RazerBatteryEvents.bin event log into text or CSV.
+//
+//   RazerEventDecode [--csv] <file> [<file>...]
+//
+// Rotated generations can be passed oldest first to get one timeline.
+#include "EventLog.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+static const char* StrategyName(uint8_t strategy) {
+    switch (static_cast<EventStrategy>(strategy)) {
+    case EventStrategy::FeatureReport: return "feature";
+    case EventStrategy::OutputInputReport: return "output";
+    default: return "none";
+    }
+}
+
+static std::string FormatWallClock(int64_t us) {
+    std::time_t seconds = static_cast<std::time_t>(us / 1000000);
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &seconds);
+#else
+    localtime_r(&seconds, &timeinfo);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    char out[48];
+    snprintf(out, sizeof(out), "%s.%06lld", buf, static_cast<long long>(us % 1000000));
+    return out;
+}
+
+static bool DecodeFile(const char* path, bool csv) {
+    MappedFile file;
+    if (!file.OpenReadOnly(path)) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    if (file.Size() < sizeof(EventLogHeader)) {
+        fprintf(stderr, "%s: too small\n", path);
+        return false;
+    }
+
+    const EventLogHeader* header = reinterpret_cast<const EventLogHeader*>(file.Data());
+    if (memcmp(header->magic, RAZER_EVENTLOG_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != RAZER_EVENTLOG_VERSION || header->recordSize != sizeof(ProtocolEvent)) {
+        fprintf(stderr, "%s: not a v%d event log\n", path, RAZER_EVENTLOG_VERSION);
+        return false;
+    }
+
+    uint64_t count = header->count < header->capacity ? header->count : header->capacity;
+    uint64_t available = (file.Size() - sizeof(EventLogHeader)) / sizeof(ProtocolEvent);
+    if (count > available) count = available;
+
+    const ProtocolEvent* records = reinterpret_cast<const ProtocolEvent*>(file.Data() + sizeof(EventLogHeader));
+    for (uint64_t i = 0; i < count; i++) {
+        const ProtocolEvent& e = records[i];
+        char key[sizeof(e.deviceKey) + 1];
+        memcpy(key, e.deviceKey, sizeof(e.deviceKey));
+        key[sizeof(e.deviceKey)] = '\0';
+
+        int64_t wallUs = header->wallClockBaseUs +
+                         static_cast<int64_t>(e.timestampUs - header->monotonicBaseUs);
+        std::string when = FormatWallClock(wallUs);
+
+        if (csv) {
+            printf("%s,%s,0x%04x,%d,%s,0x%02x,0x%02x,0x%02x,0x%02x,%u,%d\n",
+                   when.c_str(), key, e.pid, e.interfaceNumber, StrategyName(e.strategy),
+                   e.transactionId, e.commandClass, e.commandId, e.status, e.latencyUs, e.result);
+        } else {
+            printf("[%s] %-24s pid=0x%04x if=%d %-7s tid=0x%02x cmd=%02x:%02x status=0x%02x %8u us result=%d\n",
+                   when.c_str(), key, e.pid, e.interfaceNumber, StrategyName(e.strategy),
+                   e.transactionId, e.commandClass, e.commandId, e.status, e.latencyUs, e.result);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool csv = false;
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "--csv") == 0) {
+        csv = true;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [--csv] <events.bin> [<events.bin>...]\n", argv[0]);
+        return 2;
+    }
+
+    if (csv) {
+        printf("time,device,pid,interface,strategy,tid,class,id,status,latency_us,result\n");
+    }
+
+    int failures = 0;
+    for (int i = first; i < argc; i++) {
+        if (!DecodeFile(argv[i], csv)) failures++;
+    }
+    return failures ? 1 : 0;
+}
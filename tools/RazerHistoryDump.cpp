@@ -0,0 +1,62 @@
+// Prints a RazerBatteryHistory-<key>.bin battery history as CSV.
+//
+//   RazerHistoryDump [--from EPOCH] [--to EPOCH] <file>
+//
+// One line per record: time (seconds since epoch), local time, kind
+// (sample, charge_start, charge_stop), level and charging state.
+#include "BatteryHistory.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static const char* KindName(HistoryRecord::Kind kind) {
+    switch (kind) {
+    case HistoryRecord::Kind::ChargeStarted: return "charge_start";
+    case HistoryRecord::Kind::ChargeStopped: return "charge_stop";
+    default: return "sample";
+    }
+}
+
+int main(int argc, char** argv) {
+    int64_t from = INT64_MIN, to = INT64_MAX;
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from = strtoll(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to = strtoll(argv[++i], nullptr, 10);
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: RazerHistoryDump [--from EPOCH] [--to EPOCH] <file>\n");
+        return 1;
+    }
+
+    BatteryHistory history;
+    if (!history.OpenReadOnly(path)) {
+        fprintf(stderr, "%s: not a battery history file\n", path);
+        return 1;
+    }
+
+    printf("time,local_time,kind,level,charging\n");
+    for (const HistoryRecord& r : history.Query(from, to)) {
+        std::time_t seconds = static_cast<std::time_t>(r.time);
+        struct tm timeinfo;
+#ifdef _WIN32
+        localtime_s(&timeinfo, &seconds);
+#else
+        localtime_r(&seconds, &timeinfo);
+#endif
+        char local[32];
+        std::strftime(local, sizeof(local), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        printf("%lld,%s,%s,%d,%d\n", static_cast<long long>(r.time), local, KindName(r.kind), r.level, r.charging ? 1 : 0);
+    }
+    return 0;
+}
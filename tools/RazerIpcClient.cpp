@@ -0,0 +1,40 @@
+// RazerIpcClient [--endpoint PATH] [get|subscribe]
+//
+// Minimal consumer of the IPC endpoint served by RazerBatteryPoller: prints the
+// cached device snapshot ("get", default) or streams change events
+// ("subscribe") as JSON lines until the server goes away.
+#include "IpcChannel.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string endpoint = IpcListener::DefaultEndpoint();
+    std::string command = "get";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--endpoint") == 0 && i + 1 < argc) {
+            endpoint = argv[++i];
+        } else if (strcmp(argv[i], "get") == 0 || strcmp(argv[i], "subscribe") == 0) {
+            command = argv[i];
+        } else {
+            fprintf(stderr, "usage: RazerIpcClient [--endpoint PATH] [get|subscribe]\n");
+            return 1;
+        }
+    }
+
+    auto channel = IpcChannel::Connect(endpoint);
+    if (!channel) {
+        fprintf(stderr, "nothing is listening on %s\n", endpoint.c_str());
+        return 1;
+    }
+    if (!channel->WriteLine(command)) return 1;
+
+    std::string line;
+    while (channel->ReadLine(line)) {
+        printf("%s\n", line.c_str());
+        fflush(stdout);
+        if (command == "get") return 0;
+    }
+    return command == "get" ? 1 : 0;
+}
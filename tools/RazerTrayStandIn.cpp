@@ -0,0 +1,103 @@
+// RazerTrayStandIn [--endpoint PATH] [--refresh] [--count N]
+//
+// Does what RazerBatteryTray does, minus the Windows shell: subscribes to the
+// poller and prints one line per update, with what each device's icon shows
+// (letter, text and color, as TrayIcon draws them):
+//   connected 2 device(s)
+//     mouse 0x00b7 "Razer DeathAdder V3 Pro" 87% charging (~40 min to full) icon="M 87 cyan"
+// and one line per low-battery alert (where the tray shows a toast):
+//   alert low battery: mouse "Razer DeathAdder V3 Pro" 14%
+// --refresh asks the poller for a refresh once connected; --count stops
+// after N updates. Useful on Linux and for checking session isolation.
+#include "TrayClient.h"
+#include "BatteryEstimator.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace {
+
+// Letter, text and color of the tray icon for `status`
+std::string IconText(const DeviceStatus& status) {
+    std::string text = status.type == RazerDeviceType::Mouse      ? "M"
+                       : status.type == RazerDeviceType::Headset  ? "H"
+                       : status.type == RazerDeviceType::Keyboard ? "K"
+                                                                  : "?";
+    if (status.error == "unavailable") return text + " -- gray";
+    int level = status.level < 0 ? 0 : status.level;
+    text += " " + std::to_string(level);
+    if (status.charging) return text + " cyan";
+    if (level < 20) return text + " red";
+    if (level < 50) return text + " yellow";
+    return text + " green";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string endpoint = IpcListener::DefaultEndpoint();
+    bool refresh = false;
+    long count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--endpoint") == 0 && i + 1 < argc) {
+            endpoint = argv[++i];
+        } else if (strcmp(argv[i], "--refresh") == 0) {
+            refresh = true;
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: RazerTrayStandIn [--endpoint PATH] [--refresh] [--count N]\n");
+            return 1;
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    long updates = 0;
+    bool connected = false;
+
+    TrayClient client([&](const std::vector<DeviceStatus>& devices, bool up) {
+        if (!up) {
+            printf("disconnected\n");
+        } else {
+            printf("connected %zu device(s)\n", devices.size());
+            for (const auto& d : devices) {
+                printf("  %s 0x%04x \"%s\" ", DeviceTypeName(d.type), d.pid, d.name.c_str());
+                if (d.error == "unavailable") printf("unavailable ");
+                else if (d.level < 0) printf("?%% ");
+                else printf("%d%% ", d.level);
+                printf("%s ", d.charging ? "charging" : "discharging");
+                std::string estimate = FormatEstimate(d);
+                if (!estimate.empty()) printf("(%s) ", estimate.c_str());
+                printf("icon=\"%s\"\n", IconText(d).c_str());
+            }
+        }
+        fflush(stdout);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        connected = up;
+        if (up) updates++;
+        cv.notify_all();
+    }, endpoint);
+    client.SetAlertCallback([](const DeviceStatus& d) {
+        printf("alert low battery: %s \"%s\" %d%%\n", DeviceTypeName(d.type), d.name.c_str(), d.level);
+        fflush(stdout);
+    });
+    client.Start();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (refresh) {
+        cv.wait(lock, [&] { return connected; });
+        lock.unlock();
+        if (!client.RequestRefresh()) fprintf(stderr, "refresh declined\n");
+        lock.lock();
+    }
+    cv.wait(lock, [&] { return count > 0 && updates >= count; });
+    lock.unlock();
+    client.Stop();
+    return 0;
+}